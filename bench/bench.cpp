@@ -0,0 +1,642 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <bitcoin/server.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::protocol;
+using namespace bc::system;
+using namespace bc::system::chain;
+using namespace bc::system::wallet;
+using role = zmq::socket::role;
+
+typedef std::chrono::steady_clock steady;
+
+static constexpr uint8_t basic_filter = 0;
+static constexpr uint32_t headers_count = 100;
+static constexpr uint32_t filter_headers_count = 100;
+static constexpr uint32_t filters_count = 100;
+static constexpr uint32_t history_page = 100;
+static constexpr size_t keys_count = 10;
+static constexpr size_t code_size = sizeof(uint32_t);
+static constexpr size_t header_size = 80;
+
+bench::bench(const options& settings, std::ostream& output,
+    std::ostream& error)
+  : options_(settings), output_(output), error_(error), top_(0)
+{
+}
+
+// The benchmarked commands and the arguments of each.
+// Broadcast and validation are excluded as they require valid transactions.
+const std::map<std::string, bench::arguments>& bench::commands()
+{
+    static const std::map<std::string, arguments> commands
+    {
+        { "blockchain.fetch_block", arguments::height },
+        { "blockchain.fetch_block_chunks", arguments::height },
+        { "blockchain.fetch_block_header", arguments::height },
+        { "blockchain.fetch_block_headers", arguments::headers },
+        { "blockchain.fetch_block_height", arguments::block_hash },
+        { "blockchain.fetch_block_transaction_hashes", arguments::height },
+        { "blockchain.fetch_last_height", arguments::none },
+        { "blockchain.fetch_transaction", arguments::tx_hash },
+        { "blockchain.fetch_transaction2", arguments::tx_hash },
+        { "blockchain.fetch_transactions", arguments::txs_hashes },
+        { "blockchain.fetch_transaction_index", arguments::tx_hash },
+        { "blockchain.fetch_spend", arguments::point },
+        { "blockchain.fetch_spends", arguments::points },
+        { "blockchain.fetch_history4", arguments::key },
+        { "blockchain.fetch_history5", arguments::key_page },
+        { "blockchain.fetch_history_batch", arguments::keys },
+        { "blockchain.fetch_compact_filter", arguments::filter },
+        { "blockchain.fetch_compact_filter_checkpoint",
+            arguments::filter_checkpoint },
+        { "blockchain.fetch_compact_filters", arguments::filters },
+        { "blockchain.fetch_compact_filter_headers",
+            arguments::filter_headers },
+        { "transaction_pool.fetch_transaction", arguments::tx_hash },
+        { "transaction_pool.fetch_transaction2", arguments::tx_hash },
+        { "transaction_pool.fetch_history", arguments::hash_key },
+        { "subscribe.key", arguments::key },
+        { "subscribe.key2", arguments::key },
+        { "subscribe.key_transactions", arguments::key },
+        { "unsubscribe.key", arguments::key },
+        { "server.version", arguments::none },
+        { "server.stats", arguments::none }
+    };
+
+    return commands;
+}
+
+bool bench::run()
+{
+    if (!parse_mix() || !load_addresses() || !sample())
+        return false;
+
+    std::vector<tallies> results(options_.clients);
+    std::vector<std::thread> clients;
+    const auto start = steady::now();
+
+    for (size_t index = 0; index < options_.clients; ++index)
+        clients.emplace_back(&bench::client, this, index,
+            std::ref(results[index]));
+
+    for (auto& client: clients)
+        client.join();
+
+    const std::chrono::duration<double> elapsed = steady::now() - start;
+
+    tallies totals;
+
+    for (const auto& result: results)
+    {
+        for (const auto& entry: result)
+        {
+            auto& total = totals[entry.first];
+            total.sent += entry.second.sent;
+            total.failed += entry.second.failed;
+            total.lost += entry.second.lost;
+            total.microseconds.insert(total.microseconds.end(),
+                entry.second.microseconds.begin(),
+                entry.second.microseconds.end());
+        }
+    }
+
+    report(totals, elapsed.count());
+    return true;
+}
+
+// Setup.
+//-----------------------------------------------------------------------------
+
+// Subscriptions are only benchmarked when named, as they are retained.
+bool bench::parse_mix()
+{
+    if (options_.replay)
+    {
+        names_.push_back("blockchain.fetch_history4");
+        weights_.push_back(1);
+        return true;
+    }
+
+    if (options_.mix == "all")
+    {
+        for (const auto& command: commands())
+        {
+            if (command.first.find("subscribe.") != std::string::npos)
+                continue;
+
+            names_.push_back(command.first);
+            weights_.push_back(1);
+        }
+
+        return true;
+    }
+
+    for (const auto& token: split(options_.mix, ","))
+    {
+        const auto pair = split(token, "=");
+        const auto& name = pair.front();
+
+        if (commands().find(name) == commands().end() || pair.size() > 2)
+        {
+            error_ << "Unsupported command: " << token << std::endl;
+            return false;
+        }
+
+        double weight = 1;
+
+        if (pair.size() == 2 && !deserialize(weight, pair.back(), true))
+        {
+            error_ << "Invalid weight: " << token << std::endl;
+            return false;
+        }
+
+        names_.push_back(name);
+        weights_.push_back(weight);
+    }
+
+    if (names_.empty())
+    {
+        error_ << "The command mix is empty." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Addresses are read as the quoted tokens of the file, so that the python
+// address lists of the test directory are read as is.
+bool bench::load_addresses()
+{
+    if (options_.addresses.empty())
+    {
+        if (!options_.replay)
+            return true;
+
+        error_ << "Replay requires an address file." << std::endl;
+        return false;
+    }
+
+    std::ifstream file(options_.addresses);
+
+    if (!file.good())
+    {
+        error_ << "Failed to open " << options_.addresses << std::endl;
+        return false;
+    }
+
+    const std::string text((std::istreambuf_iterator<char>(file)),
+        std::istreambuf_iterator<char>());
+
+    for (auto begin = text.find('"'); begin != std::string::npos;)
+    {
+        const auto end = text.find('"', begin + 1);
+
+        if (end == std::string::npos)
+            break;
+
+        const payment_address address(text.substr(begin + 1,
+            end - begin - 1));
+
+        if (address)
+            keys_.push_back(address.output_script().to_payments_key());
+
+        begin = text.find('"', end + 1);
+    }
+
+    if (keys_.empty())
+    {
+        error_ << "No addresses in " << options_.addresses << std::endl;
+        return false;
+    }
+
+    output_ << "Loaded " << keys_.size() << " addresses." << std::endl;
+    return true;
+}
+
+// Block and transaction hashes are sampled from blocks at random heights.
+bool bench::sample()
+{
+    data_chunk response;
+
+    if (!call({ "blockchain.fetch_last_height", {} }, response) ||
+        response.size() != code_size + sizeof(uint32_t))
+    {
+        error_ << "Failed to fetch the top height from "
+            << options_.endpoint << std::endl;
+        return false;
+    }
+
+    auto deserial = make_safe_deserializer(response.begin(), response.end());
+    deserial.skip(code_size);
+    top_ = deserial.read_4_bytes_little_endian();
+
+    std::mt19937_64 random(top_);
+    std::uniform_int_distribution<uint32_t> heights(0, top_);
+
+    for (size_t index = 0; index < options_.samples; ++index)
+    {
+        const auto height = to_chunk(to_little_endian(heights(random)));
+
+        if (call({ "blockchain.fetch_block_header", height }, response) &&
+            response.size() == code_size + header_size)
+            blocks_.push_back(bitcoin_hash(data_chunk(
+                response.begin() + code_size, response.end())));
+
+        if (!call({ "blockchain.fetch_block_transaction_hashes", height },
+            response) || response.size() < code_size + hash_size)
+            continue;
+
+        for (auto it = response.begin() + code_size;
+            std::distance(it, response.end()) >= hash_size; it += hash_size)
+        {
+            hash_digest hash;
+            std::copy_n(it, hash_size, hash.begin());
+            transactions_.push_back(hash);
+        }
+    }
+
+    // Random keys stand in for addresses, with (typically) empty history.
+    if (keys_.empty())
+        for (auto& block: blocks_)
+            keys_.push_back(sha256_hash(block));
+
+    if (blocks_.empty() || transactions_.empty() || keys_.empty())
+    {
+        error_ << "Failed to sample blocks from " << options_.endpoint
+            << std::endl;
+        return false;
+    }
+
+    output_ << "Sampled " << blocks_.size() << " blocks and "
+        << transactions_.size() << " transactions below height " << top_
+        << "." << std::endl;
+    return true;
+}
+
+// Send a query and wait for its response (used for sampling).
+bool bench::call(const query& request, data_chunk& response)
+{
+    static constexpr uint32_t id = 0;
+    zmq::socket socket(context_, role::dealer);
+
+    if (socket.connect(options_.endpoint))
+        return false;
+
+    // [ delimiter ][ command ][ id:4 ][ data ]
+    zmq::message message;
+    message.enqueue();
+    message.enqueue(request.command);
+    message.enqueue_little_endian(id);
+    message.enqueue(request.data);
+
+    if (socket.send(message))
+        return false;
+
+    zmq::poller poller;
+    poller.add(socket);
+
+    const auto timeout = static_cast<int32_t>(options_.timeout_seconds * 1000);
+
+    if (!poller.wait(timeout).contains(socket.id()))
+        return false;
+
+    zmq::message reply;
+
+    if (socket.receive(reply) || reply.size() != 4)
+        return false;
+
+    reply.dequeue_data();
+    reply.dequeue_text();
+    response = reply.dequeue_data();
+
+    // Fail on error response, so top height is not read as zero.
+    return response.size() >= code_size &&
+        from_little_endian_unsafe<uint32_t>(response.begin()) == 0;
+}
+
+// Queries.
+//-----------------------------------------------------------------------------
+
+bench::query bench::make_query(size_t command, size_t sequence,
+    std::mt19937_64& random)
+{
+    const auto& name = names_[command];
+    const auto pick = [&](const std::vector<hash_digest>& hashes)
+    {
+        return hashes[std::uniform_int_distribution<size_t>(0,
+            hashes.size() - 1)(random)];
+    };
+
+    const auto height = std::uniform_int_distribution<uint32_t>(0,
+        top_)(random);
+
+    // Keys are reversed on the wire (as is the display order of hashes).
+    const auto key = [&]()
+    {
+        auto value = options_.replay ? keys_[sequence % keys_.size()] :
+            pick(keys_);
+        std::reverse(value.begin(), value.end());
+        return value;
+    };
+
+    switch (commands().at(name))
+    {
+        case arguments::none:
+            return { name, {} };
+
+        case arguments::height:
+            return { name, to_chunk(to_little_endian(height)) };
+
+        case arguments::headers:
+            return { name, build_chunk(
+            {
+                to_little_endian(top_ < headers_count ? uint32_t(0) :
+                    std::min(height, top_ - headers_count)),
+                to_little_endian(headers_count)
+            }) };
+
+        case arguments::block_hash:
+            return { name, to_chunk(pick(blocks_)) };
+
+        case arguments::tx_hash:
+            return { name, to_chunk(pick(transactions_)) };
+
+        case arguments::txs_hashes:
+        {
+            data_chunk data;
+            for (size_t index = 0; index < keys_count; ++index)
+                extend_data(data, pick(transactions_));
+
+            return { name, data };
+        }
+
+        case arguments::point:
+            return { name, output_point(pick(transactions_), 0).to_data() };
+
+        case arguments::points:
+        {
+            data_chunk data;
+            for (size_t index = 0; index < keys_count; ++index)
+                extend_data(data, output_point(pick(transactions_), 0)
+                    .to_data());
+
+            return { name, data };
+        }
+
+        case arguments::key:
+            return { name, build_chunk(
+            {
+                key(),
+                to_little_endian(uint32_t(0))
+            }) };
+
+        case arguments::hash_key:
+            return { name, to_chunk(key()) };
+
+        case arguments::key_page:
+            return { name, build_chunk(
+            {
+                key(),
+                to_little_endian(uint32_t(0)),
+                to_little_endian(history_page),
+                to_little_endian(uint32_t(0))
+            }) };
+
+        case arguments::keys:
+        {
+            auto data = to_chunk(to_little_endian(uint32_t(0)));
+            for (size_t index = 0; index < keys_count; ++index)
+                extend_data(data, key());
+
+            return { name, data };
+        }
+
+        case arguments::filter:
+            return { name, build_chunk(
+            {
+                to_chunk(basic_filter),
+                to_little_endian(height)
+            }) };
+
+        case arguments::filters:
+            return { name, build_chunk(
+            {
+                to_chunk(basic_filter),
+                to_little_endian(height),
+                to_little_endian(std::min(top_, height + filters_count - 1))
+            }) };
+
+        case arguments::filter_headers:
+            return { name, build_chunk(
+            {
+                to_chunk(basic_filter),
+                to_little_endian(height),
+                to_little_endian(std::min(top_, height +
+                    filter_headers_count))
+            }) };
+
+        case arguments::filter_checkpoint:
+        default:
+            return { name, build_chunk(
+            {
+                to_chunk(basic_filter),
+                pick(blocks_)
+            }) };
+    }
+}
+
+// Each client keeps a window of queries outstanding on its own connection.
+void bench::client(size_t index, tallies& out)
+{
+    struct pending
+    {
+        size_t command;
+        steady::time_point sent;
+    };
+
+    std::mt19937_64 random(index);
+    std::discrete_distribution<size_t> pick(weights_.begin(), weights_.end());
+    std::unordered_map<uint32_t, pending> outstanding;
+    zmq::socket socket(context_, role::dealer);
+
+    if (socket.connect(options_.endpoint))
+    {
+        out[names_.front()].lost += options_.requests;
+        return;
+    }
+
+    zmq::poller poller;
+    poller.add(socket);
+    const auto timeout = static_cast<int32_t>(options_.timeout_seconds * 1000);
+    uint32_t sequence = 0;
+
+    while (sequence < options_.requests || !outstanding.empty())
+    {
+        while (sequence < options_.requests &&
+            outstanding.size() < options_.window)
+        {
+            const auto command = pick(random);
+            const auto request = make_query(command, sequence, random);
+
+            // [ delimiter ][ command ][ id:4 ][ data ]
+            zmq::message message;
+            message.enqueue();
+            message.enqueue(request.command);
+            message.enqueue_little_endian(sequence);
+            message.enqueue(request.data);
+
+            auto& tally = out[request.command];
+            ++tally.sent;
+
+            if (socket.send(message))
+                ++tally.lost;
+            else
+                outstanding[sequence] = { command, steady::now() };
+
+            ++sequence;
+        }
+
+        if (outstanding.empty())
+            continue;
+
+        if (!poller.wait(timeout).contains(socket.id()))
+        {
+            for (const auto& entry: outstanding)
+                ++out[names_[entry.second.command]].lost;
+
+            error_ << "Client " << index << " timed out with "
+                << outstanding.size() << " queries outstanding." << std::endl;
+            return;
+        }
+
+        zmq::message reply;
+        uint32_t id;
+
+        if (socket.receive(reply) || reply.size() != 4)
+            continue;
+
+        reply.dequeue_data();
+        reply.dequeue_text();
+
+        if (!reply.dequeue(id))
+            continue;
+
+        // Notifications, late and streamed responses are not counted.
+        const auto it = outstanding.find(id);
+
+        if (it == outstanding.end())
+            continue;
+
+        const auto data = reply.dequeue_data();
+        auto& tally = out[names_[it->second.command]];
+        const auto latency = steady::now() - it->second.sent;
+        tally.microseconds.push_back(std::chrono::duration_cast<
+            std::chrono::microseconds>(latency).count());
+
+        if (data.size() < code_size ||
+            from_little_endian_unsafe<uint32_t>(data.begin()) != 0)
+            ++tally.failed;
+
+        outstanding.erase(it);
+    }
+}
+
+// Report.
+//-----------------------------------------------------------------------------
+
+uint64_t bench::percentile(const latencies& sorted, double fraction)
+{
+    if (sorted.empty())
+        return 0;
+
+    const auto rank = static_cast<size_t>(std::ceil(fraction * sorted.size()));
+    return sorted[std::max(rank, size_t(1)) - 1];
+}
+
+// Failed queries (with an error code) are timed, lost queries are not.
+void bench::report(const tallies& totals, double seconds)
+{
+    static const auto row = [](std::ostream& out, const std::string& name,
+        const tally& values, double seconds)
+    {
+        auto sorted = values.microseconds;
+        std::sort(sorted.begin(), sorted.end());
+
+        out << std::left << std::setw(45) << name << std::right
+            << std::setw(9) << values.sent
+            << std::setw(8) << values.failed
+            << std::setw(7) << values.lost
+            << std::setw(11) << std::fixed << std::setprecision(1)
+            << sorted.size() / seconds
+            << std::setw(10) << percentile(sorted, 0.5)
+            << std::setw(10) << percentile(sorted, 0.99)
+            << std::setw(10) << percentile(sorted, 0.999) << std::endl;
+    };
+
+    output_ << std::left << std::setw(45) << "command" << std::right
+        << std::setw(9) << "sent"
+        << std::setw(8) << "failed"
+        << std::setw(7) << "lost"
+        << std::setw(11) << "per sec"
+        << std::setw(10) << "p50 us"
+        << std::setw(10) << "p99 us"
+        << std::setw(10) << "p999 us" << std::endl;
+
+    tally all;
+
+    for (const auto& entry: totals)
+    {
+        row(output_, entry.first, entry.second, seconds);
+        all.sent += entry.second.sent;
+        all.failed += entry.second.failed;
+        all.lost += entry.second.lost;
+        all.microseconds.insert(all.microseconds.end(),
+            entry.second.microseconds.begin(),
+            entry.second.microseconds.end());
+    }
+
+    row(output_, "total", all, seconds);
+    output_ << "Completed in " << std::setprecision(3) << seconds
+        << " seconds with " << options_.clients << " clients." << std::endl;
+}
+
+} // namespace server
+} // namespace libbitcoin
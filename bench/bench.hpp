@@ -0,0 +1,149 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_BENCH_HPP
+#define LIBBITCOIN_SERVER_BENCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include <bitcoin/server.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// Drive a query service with a weighted mix of query commands, from a set
+/// of concurrent clients, and report throughput and latency percentiles.
+class bench
+{
+public:
+    struct options
+    {
+        /// The query service endpoint (tcp or ipc).
+        system::config::endpoint endpoint;
+
+        /// The weighted command mix, as "command=weight,...", or "all".
+        std::string mix;
+
+        /// A file of addresses (quoted, such as test/popular_addrs.py).
+        std::string addresses;
+
+        /// Query the addresses in order and repeatedly (history only).
+        bool replay;
+
+        /// The number of concurrent clients, each with its own connection.
+        size_t clients;
+
+        /// The number of queries sent by each client.
+        size_t requests;
+
+        /// The number of outstanding queries of each client.
+        size_t window;
+
+        /// The number of blocks sampled for query arguments.
+        size_t samples;
+
+        /// The time without response, after which a client gives up.
+        uint32_t timeout_seconds;
+    };
+
+    bench(const options& settings, std::ostream& output,
+        std::ostream& error);
+
+    /// This class is not copyable.
+    bench(const bench&) = delete;
+    void operator=(const bench&) = delete;
+
+    /// Run the benchmark and write its report, false on failure.
+    bool run();
+
+    /// The latency at the fraction of the sorted latencies (zero if none).
+    static uint64_t percentile(const std::vector<uint64_t>& sorted,
+        double fraction);
+
+private:
+    enum class arguments
+    {
+        none,
+        height,
+        headers,
+        block_hash,
+        tx_hash,
+        txs_hashes,
+        point,
+        points,
+        key,
+        hash_key,
+        key_page,
+        keys,
+        filter,
+        filters,
+        filter_headers,
+        filter_checkpoint
+    };
+
+    typedef std::vector<uint64_t> latencies;
+
+    struct tally
+    {
+        size_t sent = 0;
+        size_t failed = 0;
+        size_t lost = 0;
+        latencies microseconds;
+    };
+
+    typedef std::map<std::string, tally> tallies;
+
+    struct query
+    {
+        std::string command;
+        system::data_chunk data;
+    };
+
+    static const std::map<std::string, arguments>& commands();
+
+    bool parse_mix();
+    bool load_addresses();
+    bool sample();
+    bool call(const query& request, system::data_chunk& response);
+    query make_query(size_t command, size_t sequence, std::mt19937_64& random);
+    void client(size_t index, tallies& out);
+    void report(const tallies& totals, double seconds);
+
+    const options& options_;
+    std::ostream& output_;
+    std::ostream& error_;
+    bc::protocol::zmq::context context_;
+
+    // Arguments sampled from the chain, the address set and the top height.
+    std::vector<std::string> names_;
+    std::vector<double> weights_;
+    std::vector<system::hash_digest> keys_;
+    std::vector<system::hash_digest> blocks_;
+    std::vector<system::hash_digest> transactions_;
+    uint32_t top_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
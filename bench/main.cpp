@@ -0,0 +1,220 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <iostream>
+#include <string>
+#include <boost/program_options.hpp>
+#include <bitcoin/server.hpp>
+#include "bench.hpp"
+#include "notify_bench.hpp"
+#include "replay_bench.hpp"
+
+BC_USE_LIBBITCOIN_MAIN
+
+/**
+ * Invoke this program with the raw arguments provided on the command line.
+ * All console input and output streams for the application originate here.
+ * @param argc  The number of elements in the argv array.
+ * @param argv  The array of arguments, including the process.
+ * @return      The numeric result to return via console exit.
+ */
+int bc::system::main(int argc, char* argv[])
+{
+    using namespace bc;
+    using namespace bc::server;
+    using namespace bc::system;
+    using namespace boost::program_options;
+
+    set_utf8_stdio();
+    bench::options settings;
+    notify_bench::options loads;
+    replay_bench::options replays;
+    std::string endpoint;
+    std::string mode;
+    options_description description("Options");
+    description.add_options()
+    (
+        "help,h",
+        "Display command line options."
+    )
+    (
+        "mode",
+        value<std::string>(&mode)->default_value("query"),
+        "The benchmark, 'query' (of a running server), 'notify' (of the notification indexes and publish fan-out) or 'replay' (of a query capture against a running server)."
+    );
+
+    options_description queries("Query Options");
+    queries.add_options()
+    (
+        "endpoint,e",
+        value<std::string>(&endpoint)->default_value("tcp://127.0.0.1:9091"),
+        "The query service endpoint."
+    )
+    (
+        "mix,m",
+        value<std::string>(&settings.mix)->default_value("all"),
+        "The weighted commands, as 'command=weight,...', or 'all' (excluding subscriptions)."
+    )
+    (
+        "addresses,a",
+        value<std::string>(&settings.addresses),
+        "A file of quoted addresses for history queries, such as test/popular_addrs.py."
+    )
+    (
+        "replay,r",
+        bool_switch(&settings.replay),
+        "Query the history of each address in order, repeatedly."
+    )
+    (
+        "clients,c",
+        value<size_t>(&settings.clients)->default_value(4),
+        "The number of concurrent client connections."
+    )
+    (
+        "requests,n",
+        value<size_t>(&settings.requests)->default_value(10000),
+        "The number of queries of each client."
+    )
+    (
+        "window,w",
+        value<size_t>(&settings.window)->default_value(16),
+        "The number of outstanding queries of each client."
+    )
+    (
+        "samples,s",
+        value<size_t>(&settings.samples)->default_value(100),
+        "The number of blocks sampled for query arguments."
+    )
+    (
+        "timeout,t",
+        value<uint32_t>(&settings.timeout_seconds)->default_value(10),
+        "The seconds without response after which a client gives up."
+    );
+
+    options_description notifications("Notify Options");
+    notifications.add_options()
+    (
+        "subscriptions",
+        value<size_t>(&loads.subscriptions)->default_value(100000),
+        "The number of key and of stealth subscriptions."
+    )
+    (
+        "blocks",
+        value<size_t>(&loads.blocks)->default_value(100),
+        "The number of synthetic blocks matched."
+    )
+    (
+        "transactions",
+        value<size_t>(&loads.transactions)->default_value(2000),
+        "The number of transactions of each block."
+    )
+    (
+        "hit-rate",
+        value<double>(&loads.hit_rate)->default_value(0.01),
+        "The fraction of outputs that match a subscription."
+    )
+    (
+        "threads",
+        value<size_t>(&loads.threads)->default_value(4),
+        "The number of concurrent matching threads."
+    )
+    (
+        "purge-batch",
+        value<size_t>(&loads.purge_batch)->default_value(1000),
+        "The number of subscriptions purged per lock, zero for unbounded."
+    )
+    (
+        "subscribers",
+        value<size_t>(&loads.subscribers)->default_value(16),
+        "The number of publication subscribers, zero to skip."
+    )
+    (
+        "messages",
+        value<size_t>(&loads.messages)->default_value(10000),
+        "The number of publications."
+    )
+    (
+        "message-size",
+        value<size_t>(&loads.message_size)->default_value(1000),
+        "The size of each publication."
+    );
+
+    options_description replay("Replay Options");
+    replay.add_options()
+    (
+        "capture",
+        value<std::string>(&replays.capture),
+        "The query capture file (see server.query_capture_file)."
+    )
+    (
+        "speed",
+        value<double>(&replays.speed)->default_value(1.0),
+        "The pace multiple of the capture, zero to send without pause (within the window)."
+    )
+    (
+        "baseline",
+        value<std::string>(&replays.baseline),
+        "A replay summary file to compare p99 latencies against."
+    )
+    (
+        "save",
+        value<std::string>(&replays.save),
+        "A file to which the replay summary is saved, for use as a baseline."
+    );
+
+    description.add(queries).add(notifications).add(replay);
+    variables_map variables;
+
+    try
+    {
+        store(parse_command_line(argc, argv, description), variables);
+        notify(variables);
+        settings.endpoint = config::endpoint(endpoint);
+        replays.endpoint = settings.endpoint;
+        replays.window = settings.window;
+        replays.timeout_seconds = settings.timeout_seconds;
+    }
+    catch (const std::exception& exception)
+    {
+        cerr << exception.what() << std::endl;
+        return console_result::invalid;
+    }
+
+    if (variables.count("help") != 0 || settings.clients == 0 ||
+        settings.window == 0 || (mode != "query" && mode != "notify" &&
+        mode != "replay") || (mode == "replay" && replays.capture.empty()))
+    {
+        cout << description << std::endl;
+        return console_result::okay;
+    }
+
+    if (mode == "notify")
+    {
+        notify_bench host(loads, cout, cerr);
+        return host.run() ? console_result::okay : console_result::failure;
+    }
+
+    if (mode == "replay")
+    {
+        replay_bench host(replays, cout, cerr);
+        return host.run() ? console_result::okay : console_result::failure;
+    }
+
+    bench host(settings, cout, cerr);
+    return host.run() ? console_result::okay : console_result::failure;
+}
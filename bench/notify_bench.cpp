@@ -0,0 +1,326 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "notify_bench.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+#include <bitcoin/server.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::protocol;
+using namespace bc::system;
+using role = zmq::socket::role;
+
+typedef std::chrono::steady_clock steady;
+typedef std::chrono::duration<double> seconds;
+
+static const config::endpoint publish_endpoint("inproc://bench_publish");
+static constexpr size_t minimum_filter_bits = 8;
+static constexpr int32_t idle_milliseconds = 2000;
+static constexpr uint32_t settle_milliseconds = 200;
+
+static hash_digest random_hash(std::mt19937_64& random)
+{
+    hash_digest out;
+
+    for (size_t offset = 0; offset < hash_size; offset += sizeof(uint64_t))
+    {
+        const auto value = random();
+        std::memcpy(out.data() + offset, &value, sizeof(uint64_t));
+    }
+
+    return out;
+}
+
+static uint64_t microseconds(steady::duration duration)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        duration).count();
+}
+
+notify_bench::notify_bench(const options& settings, std::ostream& output,
+    std::ostream& error)
+  : options_(settings),
+    output_(output),
+    error_(error),
+    key_subscriptions_(settings.subscriptions),
+    stealth_subscriptions_(settings.subscriptions)
+{
+}
+
+bool notify_bench::run()
+{
+    std::mt19937_64 random(options_.subscriptions);
+    output_ << std::fixed << std::setprecision(1);
+
+    if (options_.subscriptions != 0)
+    {
+        fill(random);
+        match(random);
+        purge();
+    }
+
+    return options_.subscribers == 0 || publish();
+}
+
+// Each subscription has its own route, as each client has its own address.
+void notify_bench::fill(std::mt19937_64& random)
+{
+    const auto now = std::time(nullptr);
+    const auto count = options_.subscriptions;
+    keys_.reserve(count);
+    route client;
+
+    auto start = steady::now();
+
+    for (size_t index = 0; index < count; ++index)
+    {
+        keys_.push_back(random_hash(random));
+        client.set_address(to_chunk(to_little_endian<uint64_t>(index)));
+        key_subscriptions_.subscribe(keys_.back(), client,
+            static_cast<uint32_t>(index), now, false, false);
+    }
+
+    const seconds keyed = steady::now() - start;
+    output_ << "Subscribed " << key_subscriptions_.size() << " keys at "
+        << count / keyed.count() << " per second." << std::endl;
+
+    start = steady::now();
+
+    for (size_t index = 0; index < count; ++index)
+    {
+        const auto bits = minimum_filter_bits + index %
+            (sizeof(uint32_t) * byte_bits - minimum_filter_bits + 1);
+        const binary filter(bits, to_little_endian(
+            static_cast<uint32_t>(random())));
+        client.set_address(to_chunk(to_little_endian<uint64_t>(index)));
+        stealth_subscriptions_.subscribe(filter, client,
+            static_cast<uint32_t>(index), now);
+    }
+
+    const seconds stealthed = steady::now() - start;
+    output_ << "Subscribed " << stealth_subscriptions_.size()
+        << " stealth filters at " << count / stealthed.count()
+        << " per second." << std::endl;
+}
+
+// Blocks are divided across threads, each matching one output key and one
+// stealth prefix per transaction. Each match holds a shared (shard) lock, so
+// the longest match is the longest pause imposed on subscribers.
+void notify_bench::match(std::mt19937_64& random)
+{
+    struct totals
+    {
+        size_t outputs = 0;
+        size_t keyed = 0;
+        size_t stealthed = 0;
+        uint64_t longest = 0;
+    };
+
+    const auto threads = std::max(options_.threads, size_t(1));
+    std::vector<totals> results(threads);
+    std::vector<std::thread> matchers;
+    const auto seed = random();
+    const auto start = steady::now();
+
+    for (size_t thread = 0; thread < threads; ++thread)
+    {
+        matchers.emplace_back([&, thread]()
+        {
+            std::mt19937_64 source(seed + thread);
+            std::bernoulli_distribution hit(options_.hit_rate);
+            std::uniform_int_distribution<size_t> pick(0, keys_.size() - 1);
+            auto& result = results[thread];
+            subscription::list out;
+
+            for (auto block = thread; block < options_.blocks;
+                block += threads)
+            {
+                for (size_t tx = 0; tx < options_.transactions; ++tx)
+                {
+                    const auto key = hit(source) ? keys_[pick(source)] :
+                        random_hash(source);
+                    const auto prefix = static_cast<uint32_t>(source());
+
+                    out.clear();
+                    auto begin = steady::now();
+                    key_subscriptions_.match(out, key);
+                    result.longest = std::max(result.longest,
+                        microseconds(steady::now() - begin));
+                    result.keyed += out.size();
+
+                    out.clear();
+                    begin = steady::now();
+                    stealth_subscriptions_.match(out, prefix);
+                    result.longest = std::max(result.longest,
+                        microseconds(steady::now() - begin));
+                    result.stealthed += out.size();
+                    ++result.outputs;
+                }
+            }
+        });
+    }
+
+    for (auto& matcher: matchers)
+        matcher.join();
+
+    const seconds elapsed = steady::now() - start;
+    totals all;
+
+    for (const auto& result: results)
+    {
+        all.outputs += result.outputs;
+        all.keyed += result.keyed;
+        all.stealthed += result.stealthed;
+        all.longest = std::max(all.longest, result.longest);
+    }
+
+    const auto period = elapsed.count();
+    output_ << "Matched " << all.outputs << " outputs of " << options_.blocks
+        << " blocks on " << threads << " threads at "
+        << all.outputs / period << " per second." << std::endl;
+    output_ << "Notified " << all.keyed << " key and " << all.stealthed
+        << " stealth subscriptions at " << (all.keyed + all.stealthed) /
+        period << " per second." << std::endl;
+    output_ << "Longest match lock was " << all.longest << " us."
+        << std::endl;
+}
+
+// All subscriptions are expired, in batches, reporting the longest lock.
+void notify_bench::purge()
+{
+    const auto cutoff = std::time(nullptr) + 3600;
+    subscription::list out;
+
+    auto start = steady::now();
+    const auto keyed = key_subscriptions_.purge(out, cutoff,
+        options_.purge_batch);
+    const seconds key_period = steady::now() - start;
+    output_ << "Purged " << out.size() << " keys in " << key_period.count()
+        << " seconds, longest lock " << keyed.count() << " us." << std::endl;
+
+    out.clear();
+    start = steady::now();
+    const auto stealthed = stealth_subscriptions_.purge(out, cutoff,
+        options_.purge_batch);
+    const seconds stealth_period = steady::now() - start;
+    output_ << "Purged " << out.size() << " stealth filters in "
+        << stealth_period.count() << " seconds, longest lock "
+        << stealthed.count() << " us." << std::endl;
+}
+
+// Publications are fanned out to each subscriber as by the block and
+// transaction services. Drops at high water are reported, not retried.
+bool notify_bench::publish()
+{
+    zmq::context context;
+    zmq::socket publisher(context, role::publisher);
+
+    if (publisher.bind(publish_endpoint))
+    {
+        error_ << "Failed to bind " << publish_endpoint << std::endl;
+        return false;
+    }
+
+    std::atomic<size_t> received(0);
+    std::atomic<size_t> ready(0);
+    std::vector<std::thread> subscribers;
+
+    for (size_t index = 0; index < options_.subscribers; ++index)
+    {
+        subscribers.emplace_back([&]()
+        {
+            zmq::socket subscriber(context, role::subscriber);
+
+            if (subscriber.connect(publish_endpoint))
+            {
+                ++ready;
+                return;
+            }
+
+            zmq::poller poller;
+            poller.add(subscriber);
+            ++ready;
+
+            for (size_t count = 0; count < options_.messages; ++count)
+            {
+                zmq::message message;
+
+                if (!poller.wait(idle_milliseconds).contains(subscriber.id())
+                    || subscriber.receive(message))
+                    break;
+
+                ++received;
+            }
+
+            subscriber.stop();
+        });
+    }
+
+    // Allow subscriptions to propagate before publishing (slow joiner).
+    while (ready < options_.subscribers)
+        std::this_thread::yield();
+
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(settle_milliseconds));
+
+    const data_chunk payload(options_.message_size, 0x42);
+    const auto start = steady::now();
+
+    for (size_t count = 0; count < options_.messages; ++count)
+    {
+        zmq::message message;
+        message.enqueue(payload);
+        publisher.send(message);
+    }
+
+    const seconds sent = steady::now() - start;
+
+    for (auto& subscriber: subscribers)
+        subscriber.join();
+
+    // The receive period includes the idle wait of any subscriber that lost
+    // publications, so loss should be considered with the delivery rate.
+    const seconds elapsed = steady::now() - start;
+    const auto expected = options_.messages * options_.subscribers;
+    output_ << "Published " << options_.messages << " messages of "
+        << options_.message_size << " bytes at "
+        << options_.messages / sent.count() << " per second." << std::endl;
+    output_ << "Delivered " << received.load() << " of " << expected
+        << " to " << options_.subscribers << " subscribers at "
+        << received.load() / elapsed.count() << " per second." << std::endl;
+
+    publisher.stop();
+    return true;
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,97 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_NOTIFY_BENCH_HPP
+#define LIBBITCOIN_SERVER_NOTIFY_BENCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <bitcoin/server.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// Load the notification indexes with synthetic subscriptions and match
+/// synthetic blocks against them, and measure publish fan-out to a set of
+/// subscribers, reporting throughput and lock hold times.
+class notify_bench
+{
+public:
+    struct options
+    {
+        /// The number of key and of stealth subscriptions.
+        size_t subscriptions;
+
+        /// The number of synthetic blocks matched.
+        size_t blocks;
+
+        /// The number of transactions (and outputs) of each block.
+        size_t transactions;
+
+        /// The fraction of outputs that match a subscription.
+        double hit_rate;
+
+        /// The number of concurrent matching threads.
+        size_t threads;
+
+        /// The number of keys purged per lock.
+        size_t purge_batch;
+
+        /// The number of publication subscribers (zero to skip).
+        size_t subscribers;
+
+        /// The number of publications.
+        size_t messages;
+
+        /// The size of each publication.
+        size_t message_size;
+    };
+
+    notify_bench(const options& settings, std::ostream& output,
+        std::ostream& error);
+
+    /// This class is not copyable.
+    notify_bench(const notify_bench&) = delete;
+    void operator=(const notify_bench&) = delete;
+
+    /// Run the benchmark and write its report, false on failure.
+    bool run();
+
+private:
+    typedef std::vector<system::hash_digest> keys;
+
+    void fill(std::mt19937_64& random);
+    void match(std::mt19937_64& random);
+    void purge();
+    bool publish();
+
+    const options& options_;
+    std::ostream& output_;
+    std::ostream& error_;
+    keys keys_;
+    key_index key_subscriptions_;
+    stealth_index stealth_subscriptions_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
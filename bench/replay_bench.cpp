@@ -0,0 +1,337 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "replay_bench.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <bitcoin/server.hpp>
+#include "bench.hpp"
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::protocol;
+using namespace bc::system;
+using role = zmq::socket::role;
+
+typedef std::chrono::steady_clock steady;
+
+static constexpr size_t code_size = sizeof(uint32_t);
+
+replay_bench::replay_bench(const options& settings, std::ostream& output,
+    std::ostream& error)
+  : options_(settings), output_(output), error_(error)
+{
+}
+
+bool replay_bench::run()
+{
+    if (!load())
+        return false;
+
+    tallies totals;
+    const auto start = steady::now();
+    const auto completed = replay(totals);
+    const std::chrono::duration<double> elapsed = steady::now() - start;
+
+    report(totals, elapsed.count());
+    return completed;
+}
+
+// Records are interleaved across the workers of the capturing server, so
+// they are ordered by time of receipt. Subscriptions are not replayed, as
+// they are retained by the server.
+bool replay_bench::load()
+{
+    query_recorder::entries records;
+
+    if (!query_recorder::load(records, options_.capture))
+    {
+        error_ << "Invalid capture file: " << options_.capture << std::endl;
+        return false;
+    }
+
+    for (auto& record: records)
+        if (record.command.compare(0, 10, "subscribe.") != 0 &&
+            record.command.compare(0, 12, "unsubscribe.") != 0)
+            queries_.push_back(std::move(record));
+
+    std::stable_sort(queries_.begin(), queries_.end(),
+        [](const query_recorder::entry& left,
+            const query_recorder::entry& right)
+        {
+            return left.offset < right.offset;
+        });
+
+    if (queries_.empty())
+    {
+        error_ << "No queries in capture file: " << options_.capture
+            << std::endl;
+        return false;
+    }
+
+    output_ << "Replaying (" << queries_.size() << ") queries over "
+        << std::fixed << std::setprecision(1)
+        << queries_.back().offset / 1e6 << " captured seconds." << std::endl;
+    return true;
+}
+
+// Queries are sent open loop at the captured pace (scaled by speed), so that
+// a slow server accumulates queries in flight as it would in production.
+bool replay_bench::replay(tallies& out)
+{
+    struct pending
+    {
+        const std::string* command;
+        steady::time_point sent;
+    };
+
+    zmq::socket socket(context_, role::dealer);
+
+    if (socket.connect(options_.endpoint))
+    {
+        error_ << "Failed to connect to " << options_.endpoint << std::endl;
+        return false;
+    }
+
+    zmq::poller poller;
+    poller.add(socket);
+
+    const auto timeout = steady::duration(std::chrono::seconds(
+        options_.timeout_seconds));
+    const auto paced = options_.speed > 0;
+    const auto start = steady::now();
+    auto progress = start;
+    std::unordered_map<uint32_t, pending> outstanding;
+    size_t next = 0;
+
+    const auto due = [&](const query_recorder::entry& query)
+    {
+        return start + std::chrono::duration_cast<steady::duration>(
+            std::chrono::duration<double, std::micro>(query.offset /
+                options_.speed));
+    };
+
+    while (next < queries_.size() || !outstanding.empty())
+    {
+        auto now = steady::now();
+
+        while (next < queries_.size() && (paced ?
+            due(queries_[next]) <= now : outstanding.size() < options_.window))
+        {
+            const auto& query = queries_[next];
+            const auto id = static_cast<uint32_t>(next);
+
+            // [ delimiter ][ command ][ id:4 ][ data ]
+            zmq::message message;
+            message.enqueue();
+            message.enqueue(query.command);
+            message.enqueue_little_endian(id);
+            message.enqueue(query.data);
+
+            auto& tally = out[query.command];
+            ++tally.sent;
+
+            if (socket.send(message))
+                ++tally.lost;
+            else
+                outstanding[id] = { &query.command, steady::now() };
+
+            ++next;
+        }
+
+        // Wait for a response until the next query is due.
+        now = steady::now();
+        auto wait = timeout;
+
+        if (paced && next < queries_.size())
+            wait = std::min(wait, std::max(steady::duration::zero(),
+                due(queries_[next]) - now));
+
+        const auto milliseconds = std::chrono::duration_cast<
+            std::chrono::milliseconds>(wait).count();
+
+        if (!poller.wait(static_cast<int32_t>(milliseconds)).contains(
+            socket.id()))
+        {
+            if (outstanding.empty() || steady::now() - progress < timeout)
+                continue;
+
+            for (const auto& entry: outstanding)
+                ++out[*entry.second.command].lost;
+
+            error_ << "Replay timed out with " << outstanding.size()
+                << " queries outstanding." << std::endl;
+            return false;
+        }
+
+        zmq::message reply;
+        uint32_t id;
+
+        if (socket.receive(reply) || reply.size() != 4)
+            continue;
+
+        reply.dequeue_data();
+        reply.dequeue_text();
+
+        if (!reply.dequeue(id))
+            continue;
+
+        // Notifications, late and streamed responses are not counted.
+        const auto it = outstanding.find(id);
+
+        if (it == outstanding.end())
+            continue;
+
+        progress = steady::now();
+        const auto data = reply.dequeue_data();
+        auto& tally = out[*it->second.command];
+        tally.microseconds.push_back(std::chrono::duration_cast<
+            std::chrono::microseconds>(progress - it->second.sent).count());
+
+        if (data.size() < code_size ||
+            from_little_endian_unsafe<uint32_t>(data.begin()) != 0)
+            ++tally.failed;
+
+        outstanding.erase(it);
+    }
+
+    return true;
+}
+
+// Report.
+//-----------------------------------------------------------------------------
+
+// [ command p50 p99 p999 ]...
+bool replay_bench::load_baseline(summaries& out) const
+{
+    if (options_.baseline.empty())
+        return true;
+
+    std::ifstream file(options_.baseline);
+
+    if (!file.good())
+    {
+        error_ << "Invalid baseline file: " << options_.baseline << std::endl;
+        return false;
+    }
+
+    std::string command;
+    summary values;
+
+    while (file >> command >> values.p50 >> values.p99 >> values.p999)
+        out[command] = values;
+
+    return true;
+}
+
+// The p99 change is relative to the baseline, where the baseline has the
+// command, so that candidate builds and configurations are compared.
+void replay_bench::report(const tallies& totals, double seconds)
+{
+    summaries baseline;
+    const auto compare = !options_.baseline.empty() &&
+        load_baseline(baseline);
+
+    std::ofstream save;
+
+    if (!options_.save.empty())
+        save.open(options_.save);
+
+    const auto row = [&](const std::string& name, const tally& values)
+    {
+        auto sorted = values.microseconds;
+        std::sort(sorted.begin(), sorted.end());
+        const summary current
+        {
+            bench::percentile(sorted, 0.5),
+            bench::percentile(sorted, 0.99),
+            bench::percentile(sorted, 0.999)
+        };
+
+        output_ << std::left << std::setw(45) << name << std::right
+            << std::setw(9) << values.sent
+            << std::setw(8) << values.failed
+            << std::setw(7) << values.lost
+            << std::setw(11) << std::fixed << std::setprecision(1)
+            << sorted.size() / seconds
+            << std::setw(10) << current.p50
+            << std::setw(10) << current.p99
+            << std::setw(10) << current.p999;
+
+        const auto base = baseline.find(name);
+
+        if (compare && base != baseline.end() && base->second.p99 != 0)
+            output_ << std::setw(9) << std::showpos << std::setprecision(1)
+                << 100.0 * (double(current.p99) / base->second.p99 - 1.0)
+                << "%" << std::noshowpos;
+
+        output_ << std::endl;
+
+        if (save.is_open())
+            save << name << " " << current.p50 << " " << current.p99 << " "
+                << current.p999 << std::endl;
+    };
+
+    output_ << std::left << std::setw(45) << "command" << std::right
+        << std::setw(9) << "sent"
+        << std::setw(8) << "failed"
+        << std::setw(7) << "lost"
+        << std::setw(11) << "per sec"
+        << std::setw(10) << "p50 us"
+        << std::setw(10) << "p99 us"
+        << std::setw(10) << "p999 us";
+
+    if (compare)
+        output_ << std::setw(10) << "p99 vs";
+
+    output_ << std::endl;
+
+    tally all;
+
+    for (const auto& entry: totals)
+    {
+        row(entry.first, entry.second);
+        all.sent += entry.second.sent;
+        all.failed += entry.second.failed;
+        all.lost += entry.second.lost;
+        all.microseconds.insert(all.microseconds.end(),
+            entry.second.microseconds.begin(),
+            entry.second.microseconds.end());
+    }
+
+    row("total", all);
+    output_ << "Completed in " << std::setprecision(3) << seconds
+        << " seconds at speed " << options_.speed << "." << std::endl;
+
+    if (!options_.save.empty() && !save.good())
+        error_ << "Failed to save summary to " << options_.save << std::endl;
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,108 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_REPLAY_BENCH_HPP
+#define LIBBITCOIN_SERVER_REPLAY_BENCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <bitcoin/server.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// Replay a query capture (see server.query_capture_file) against a query
+/// service, at the captured pace or scaled, and report the latency
+/// distribution of each command, optionally against a saved baseline.
+class replay_bench
+{
+public:
+    struct options
+    {
+        /// The query service endpoint (tcp or ipc).
+        system::config::endpoint endpoint;
+
+        /// The query capture file.
+        std::string capture;
+
+        /// The pace multiple of the capture (zero sends without pause).
+        double speed;
+
+        /// The number of outstanding queries when sent without pause.
+        size_t window;
+
+        /// The time without response, after which the replay gives up.
+        uint32_t timeout_seconds;
+
+        /// A file of a prior replay summary to compare against.
+        std::string baseline;
+
+        /// A file to which the summary of this replay is saved.
+        std::string save;
+    };
+
+    replay_bench(const options& settings, std::ostream& output,
+        std::ostream& error);
+
+    /// This class is not copyable.
+    replay_bench(const replay_bench&) = delete;
+    void operator=(const replay_bench&) = delete;
+
+    /// Run the replay and write its report, false on failure.
+    bool run();
+
+private:
+    struct tally
+    {
+        size_t sent = 0;
+        size_t failed = 0;
+        size_t lost = 0;
+        std::vector<uint64_t> microseconds;
+    };
+
+    // The summary latencies of a command, as saved for a baseline.
+    struct summary
+    {
+        uint64_t p50;
+        uint64_t p99;
+        uint64_t p999;
+    };
+
+    typedef std::map<std::string, tally> tallies;
+    typedef std::map<std::string, summary> summaries;
+
+    bool load();
+    bool replay(tallies& out);
+    bool load_baseline(summaries& out) const;
+    void report(const tallies& totals, double seconds);
+
+    const options& options_;
+    std::ostream& output_;
+    std::ostream& error_;
+    bc::protocol::zmq::context context_;
+    query_recorder::entries queries_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
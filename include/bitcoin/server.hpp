@@ -32,8 +32,34 @@
 #include <bitcoin/server/messages/subscription.hpp>
 #include <bitcoin/server/services/block_service.hpp>
 #include <bitcoin/server/services/heartbeat_service.hpp>
+#include <bitcoin/server/services/metrics_service.hpp>
 #include <bitcoin/server/services/query_service.hpp>
 #include <bitcoin/server/services/transaction_service.hpp>
+#include <bitcoin/server/utility/batch_response.hpp>
+#include <bitcoin/server/utility/cached_socket.hpp>
+#include <bitcoin/server/utility/chain_tip.hpp>
+#include <bitcoin/server/utility/compressor.hpp>
+#include <bitcoin/server/utility/filter_cache.hpp>
+#include <bitcoin/server/utility/filter_range.hpp>
+#include <bitcoin/server/utility/header_cache.hpp>
+#include <bitcoin/server/utility/header_range.hpp>
+#include <bitcoin/server/utility/history_cache.hpp>
+#include <bitcoin/server/utility/key_index.hpp>
+#include <bitcoin/server/utility/payment_keys.hpp>
+#include <bitcoin/server/utility/publication.hpp>
+#include <bitcoin/server/utility/publisher.hpp>
+#include <bitcoin/server/utility/query_capacity.hpp>
+#include <bitcoin/server/utility/query_metrics.hpp>
+#include <bitcoin/server/utility/query_recorder.hpp>
+#include <bitcoin/server/utility/query_tracer.hpp>
+#include <bitcoin/server/utility/rate_limiter.hpp>
+#include <bitcoin/server/utility/request_coalescer.hpp>
+#include <bitcoin/server/utility/response_cache.hpp>
+#include <bitcoin/server/utility/serial_queue.hpp>
+#include <bitcoin/server/utility/stealth_index.hpp>
+#include <bitcoin/server/utility/submission_queue.hpp>
+#include <bitcoin/server/utility/thread_affinity.hpp>
+#include <bitcoin/server/utility/unconfirmed_index.hpp>
 #include <bitcoin/server/web/block_socket.hpp>
 #include <bitcoin/server/web/default_page_data.hpp>
 #include <bitcoin/server/web/heartbeat_socket.hpp>
@@ -41,6 +67,7 @@
 #include <bitcoin/server/web/transaction_socket.hpp>
 #include <bitcoin/server/workers/authenticator.hpp>
 #include <bitcoin/server/workers/notification_worker.hpp>
+#include <bitcoin/server/workers/query_pool.hpp>
 #include <bitcoin/server/workers/query_worker.hpp>
 
 #endif
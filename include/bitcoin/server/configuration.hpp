@@ -46,6 +46,10 @@ class BCS_API configuration
 public:
     configuration(system::config::settings context);
 
+    /// Disable the peer sessions started with the node, so that a query only
+    /// server neither connects to, accepts nor seeds from peers.
+    void disable_sessions();
+
     /// Settings.
     bc::server::settings server;
     bc::protocol::settings protocol;
@@ -40,6 +40,7 @@
 // Log name.
 #define LOG_SERVER "server"
 #define LOG_SERVER_HTTP "http"
+#define LOG_SERVER_SLOW "slow_query"
 
 // Avoid namespace conflict between boost::placeholders and std::placeholders.
 #define BOOST_BIND_NO_PLACEHOLDERS
@@ -25,6 +25,12 @@
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/messages/message.hpp>
 #include <bitcoin/server/server_node.hpp>
+#include <bitcoin/server/utility/batch_response.hpp>
+#include <bitcoin/server/utility/filter_cache.hpp>
+#include <bitcoin/server/utility/filter_range.hpp>
+#include <bitcoin/server/utility/header_range.hpp>
+#include <bitcoin/server/utility/history_cache.hpp>
+#include <bitcoin/server/utility/response_cache.hpp>
 
 namespace libbitcoin {
 namespace server {
@@ -39,6 +45,16 @@ public:
     static void fetch_history4(server_node& node,
         const message& request, send_handler handler);
 
+    /// Fetch a page of the blockchain history of a payment address, as a
+    /// series of bounded responses, with a cursor for the next page. The
+    /// cursor is the height of the next record and its ordinal at height.
+    static void fetch_history5(server_node& node,
+        const message& request, send_handler handler);
+
+    /// Fetch the blockchain history of each of a set of payment addresses.
+    static void fetch_history_batch(server_node& node,
+        const message& request, send_handler handler);
+
     /// Fetch a transaction from the blockchain by its hash.
     static void fetch_transaction(server_node& node,
         const message& request, send_handler handler);
@@ -47,6 +63,10 @@ public:
     static void fetch_transaction2(server_node& node,
         const message& request, send_handler handler);
 
+    /// Fetch transactions with witness from the blockchain by their hashes.
+    static void fetch_transactions(server_node& node,
+        const message& request, send_handler handler);
+
     /// Fetch the current height of the blockchain.
     static void fetch_last_height(server_node& node,
         const message& request, send_handler handler);
@@ -55,10 +75,20 @@ public:
     static void fetch_block(server_node& node,
         const message& request, send_handler handler);
 
+    /// Fetch a block by hash or height, as a series of chunk responses. This
+    /// limits the size of each response, not memory, as the block is
+    /// serialized whole and all of its chunks are queued together.
+    static void fetch_block_chunks(server_node& node,
+        const message& request, send_handler handler);
+
     /// Fetch a block header by hash or height (conditional serialization).
     static void fetch_block_header(server_node& node,
         const message& request, send_handler handler);
 
+    /// Fetch a packed range of block headers by height, truncated at the top.
+    static void fetch_block_headers(server_node& node,
+        const message& request, send_handler handler);
+
     /// Fetch tx hashes of block by hash or height (conditional serialization).
     static void fetch_block_transaction_hashes(server_node& node,
         const message& request, send_handler handler);
@@ -67,6 +97,11 @@ public:
     static void fetch_compact_filter(server_node& node,
         const message& request, send_handler handler);
 
+    /// Fetch a range of compact filters by start and stop height, as a series
+    /// of bounded responses, truncated at the top.
+    static void fetch_compact_filters(server_node& node,
+        const message& request, send_handler handler);
+
     /// Fetch compact filter checkpoint ending in block by hash.
     static void fetch_compact_filter_checkpoint(server_node& node,
         const message& request, send_handler handler);
@@ -83,6 +118,10 @@ public:
     static void fetch_spend(server_node& node,
         const message& request, send_handler handler);
 
+    /// Fetch the inpoints which spend each of a set of outputs.
+    static void fetch_spends(server_node& node,
+        const message& request, send_handler handler);
+
     /// Fetch the height of a block by its hash.
     static void fetch_block_height(server_node& node,
         const message& request, send_handler handler);
@@ -100,10 +139,45 @@ private:
         const system::chain::payment_record::list& payments,
         const message& request, send_handler handler);
 
-    static void transaction_fetched(const system::code& ec,
+    static void history_cached(const system::code& ec,
+        const system::chain::payment_record::list& payments,
+        const system::hash_digest& key, size_t from_height,
+        const message& request, send_handler handler, history_cache& cache,
+        size_t sequence);
+
+    static void history_batched(const system::code& ec,
+        const system::chain::payment_record::list& payments,
+        batch_response::ptr batch, size_t index);
+
+    static void transaction_batched(const system::code& ec,
         system::transaction_const_ptr tx, size_t, size_t,
+        batch_response::ptr batch, size_t index);
+
+    static void spend_batched(const system::code& ec,
+        const system::chain::input_point& inpoint,
+        batch_response::ptr batch, size_t index);
+
+    static void header_ranged(const system::code& ec,
+        system::header_const_ptr header, header_range::ptr range,
+        size_t index);
+
+    static void fetch_history_page(server_node& node,
+        const system::hash_digest& key, size_t from_height, size_t fetch,
+        uint32_t cursor_height, uint32_t cursor_ordinal, uint32_t limit,
         const message& request, send_handler handler);
 
+    static void history_paged(const system::code& ec,
+        const system::chain::payment_record::list& payments,
+        server_node& node, const system::hash_digest& key,
+        size_t from_height, size_t fetched, uint32_t cursor_height,
+        uint32_t cursor_ordinal, uint32_t limit, const message& request,
+        send_handler handler);
+
+    static void transaction_fetched(const system::code& ec,
+        system::transaction_const_ptr tx, size_t, size_t,
+        const message& request, send_handler handler, response_cache& cache,
+        bool witness, size_t generation);
+
     static void last_height_fetched(const system::code& ec, size_t last_height,
         const message& request, send_handler handler);
 
@@ -121,7 +195,12 @@ private:
 
     static void block_fetched(const system::code& ec,
         system::block_const_ptr header, const message& request,
-        send_handler handler);
+        send_handler handler, response_cache& cache, bool witness,
+        size_t generation);
+
+    static void block_chunked(const system::code& ec,
+        system::block_const_ptr block, size_t chunk_size,
+        const message& request, send_handler handler);
 
     static void fetch_compact_filter_by_hash(server_node& node,
         const message& request, send_handler handler);
@@ -130,8 +209,13 @@ private:
         const message& request, send_handler handler);
 
     static void compact_filter_fetched(const system::code& ec,
-        system::compact_filter_ptr response, size_t, const message& request,
-        send_handler handler);
+        system::compact_filter_ptr response, size_t height,
+        const message& request, send_handler handler, filter_cache& cache,
+        size_t generation);
+
+    static void filter_ranged(const system::code& ec,
+        system::compact_filter_ptr filter, size_t, filter_range::ptr range,
+        size_t index);
 
     static void fetch_compact_filter_headers_by_hash(server_node& node,
         const message& request, send_handler handler);
@@ -149,7 +233,7 @@ private:
 
     static void block_header_fetched(const system::code& ec,
         system::header_const_ptr header, const message& request,
-        send_handler handler);
+        send_handler handler, response_cache& cache, size_t generation);
 
     static void fetch_block_transaction_hashes_by_hash(server_node& node,
         const message& request, send_handler handler);
@@ -35,6 +35,10 @@ public:
     /// Fetch the server's version.
     static void version(server_node& node, const message& request,
         send_handler handler);
+
+    /// Fetch the server's query metrics report (plaintext).
+    static void stats(server_node& node, const message& request,
+        send_handler handler);
 };
 
 } // namespace server
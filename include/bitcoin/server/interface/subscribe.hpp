@@ -34,6 +34,16 @@ public:
     /// Subscribe to payment address notifications by key.
     static void key(server_node& node, const message& request,
         send_handler handler);
+
+    /// Subscribe to payment address notifications by key, batched into one
+    /// notification.key2 message per reorganization or pool transaction.
+    static void key2(server_node& node, const message& request,
+        send_handler handler);
+
+    /// Subscribe to payment address notifications by key, each sent as a
+    /// notification.key_transaction message carrying the transaction.
+    static void key_transactions(server_node& node, const message& request,
+        send_handler handler);
 };
 
 } // namespace server
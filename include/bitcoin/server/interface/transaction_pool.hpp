@@ -40,6 +40,11 @@ public:
     static void fetch_transaction2(server_node& node, const message& request,
         send_handler handler);
 
+    /// Fetch the hashes of unconfirmed transactions of a payment key, from
+    /// the in-memory unconfirmed index.
+    static void fetch_history(server_node& node, const message& request,
+        send_handler handler);
+
     /// Save to tx pool and announce to all connected peers.
     static void broadcast(server_node& node, const message& request,
         send_handler handler);
@@ -19,7 +19,9 @@
 #ifndef LIBBITCOIN_SERVER_MESSAGE
 #define LIBBITCOIN_SERVER_MESSAGE
 
+#include <chrono>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/define.hpp>
@@ -32,14 +34,32 @@ namespace server {
 class BCS_API message
 {
 public:
+    typedef std::chrono::steady_clock::time_point time_point;
+
+    /// The stage times of a sampled query, shared by its responses.
+    struct trace
+    {
+        time_point executed;
+    };
+
+    typedef std::shared_ptr<trace> trace_ptr;
+
     static system::data_chunk to_bytes(const system::code& ec);
 
+    /// Serialize the success code and the object into a single allocation.
+    template <typename Object>
+    static system::data_chunk to_bytes(const Object& object, uint32_t version);
+
     // Constructors.
     //-------------------------------------------------------------------------
 
     /// Construct a default message (to be read).
     message(bool secure);
 
+    /// Construct a default message (to be read) from a query service
+    /// instance, retained in its route.
+    message(bool secure, uint16_t instance);
+
     // Create an error message in respose to the request.
     message(const message& request, const system::code& ec);
 
@@ -72,6 +92,33 @@ public:
     /// The incoming message route security context.
     bool secure() const;
 
+    /// The time of receipt of the query (shared by its responses).
+    std::chrono::steady_clock::time_point received() const;
+
+    /// True if the response payload has been compressed.
+    bool compressed() const;
+
+    /// Mark the response payload as compressed, so it is compressed once.
+    void set_compressed();
+
+    // Tracing.
+    //-------------------------------------------------------------------------
+
+    /// Sample the query for tracing, its responses share its trace.
+    void sample();
+
+    /// True if the query (or that of the response) is sampled for tracing.
+    bool traced() const;
+
+    /// Record the start of execution of a sampled query (on any thread).
+    void executing() const;
+
+    /// The time of execution of a sampled query (otherwise its receipt).
+    time_point executed() const;
+
+    /// The time of creation of a sampled response (otherwise query receipt).
+    time_point created() const;
+
     // Send/Receive.
     //-------------------------------------------------------------------------
 
@@ -81,15 +128,47 @@ public:
     /// Send the message via the socket.
     system::code send(bc::protocol::zmq::socket& socket) const;
 
+    /// Send the message via the socket, moving the payload into its frame.
+    /// The payload is empty after this call.
+    system::code transfer(bc::protocol::zmq::socket& socket);
+
+    /// Receive a notification via the socket, with its route instance.
+    system::code receive_notification(bc::protocol::zmq::socket& socket);
+
+    /// Send the notification via the socket, with its route instance, moving
+    /// the payload into its frame. The payload is empty after this call.
+    system::code notify(bc::protocol::zmq::socket& socket);
+
 protected:
+    system::code decode(bc::protocol::zmq::message& message);
+    void enqueue_header(bc::protocol::zmq::message& message) const;
+
     std::string command_;
     uint32_t id_;
     system::data_chunk data_;
     server::route route_;
+    std::chrono::steady_clock::time_point received_;
+    time_point created_;
+    trace_ptr trace_;
+    bool compressed_;
     const bool secure_;
 };
 
-typedef std::function<void(const message&)> send_handler;
+/// Responses are moved to the handler so that the payload is not copied.
+typedef std::function<void(message&&)> send_handler;
+
+// [ code:4 ]
+// [ object... ]
+template <typename Object>
+system::data_chunk message::to_bytes(const Object& object, uint32_t version)
+{
+    static constexpr auto code_size = sizeof(uint32_t);
+    system::data_chunk out(code_size + object.serialized_size(version));
+    auto serial = system::make_unsafe_serializer(out.begin());
+    serial.write_error_code(system::error::success);
+    object.to_data(version, serial);
+    return out;
+}
 
 } // namespace server
 } // namespace libbitcoin
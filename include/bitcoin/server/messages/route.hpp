@@ -20,6 +20,7 @@
 #define LIBBITCOIN_SERVER_ROUTE
 
 #include <cstddef>
+#include <cstdint>
 #include <string>
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/define.hpp>
@@ -50,13 +51,23 @@ public:
     void set_delimited(bool value);
 
     /// The simple route supports only one address.
-    bc::protocol::zmq::message::address address() const;
+    /// This is a reference so that each reply copies the address only into
+    /// its outgoing frame.
+    const bc::protocol::zmq::message::address& address() const;
 
     /// Set the address.
     void set_address(const bc::protocol::zmq::message::address& value);
 
+    /// The query service instance of the client connection, the address is
+    /// unique only within its instance.
+    uint16_t instance() const;
+
+    /// Set the query service instance.
+    void set_instance(uint16_t value);
+
 protected:
     bool delimited_;
+    uint16_t instance_;
     bc::protocol::zmq::message::address address_;
 };
 
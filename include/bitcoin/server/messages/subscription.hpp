@@ -22,6 +22,8 @@
 #include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <memory>
+#include <vector>
 #include <bitcoin/system.hpp>
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/messages/route.hpp>
@@ -30,20 +32,43 @@ namespace libbitcoin {
 namespace server {
 
 /// This class is threadsafe and pretends to be const.
-/// Caller must maange the race between increment and sequence.
+/// Each send takes its sequence from increment, not from a later sequence.
+/// Subscriptions are shared by their indexes and notifiers, so that a match
+/// does not copy the route.
 class BCS_API subscription
   : public route
 {
 public:
+    typedef std::shared_ptr<const subscription> ptr;
+    typedef std::vector<ptr> list;
+
+    /// The subscription of the route in the list, or the list end.
+    static list::iterator find(list& subscriptions, const route& route);
+
     /// Copy constructor, required for bimap.
     subscription(const subscription& other);
 
     /// Construct subscription state from an existing route.
     subscription(const route& return_route, uint32_t id, time_t now);
 
+    /// Construct subscription state, optionally for batched notification.
+    subscription(const route& return_route, uint32_t id, time_t now,
+        bool batched);
+
+    /// Construct subscription state, optionally for batched notification or
+    /// for notification of the transaction rather than its hash.
+    subscription(const route& return_route, uint32_t id, time_t now,
+        bool batched, bool transactions);
+
     /// Arbitrary caller data, returned to caller on each notification.
     uint32_t id() const;
 
+    /// Notifications are accumulated into one message per reorganization.
+    bool batched() const;
+
+    /// Notifications carry the transaction rather than its hash.
+    bool transactions() const;
+
     /// Last subscription time, used for expirations.
     time_t updated() const;
 
@@ -51,9 +76,9 @@ public:
     /// This is mutable so that change does not force a hash table update.
     void set_updated(time_t now) const;
 
-    /// Increment sequence, indicating a send attempt.
+    /// Increment sequence, indicating a send attempt, returning the new value.
     /// This is mutable so that change does not force a hash table update.
-    void increment() const;
+    uint16_t increment() const;
 
     /// The ordinal of the current subscription instance.
     uint16_t sequence() const;
@@ -75,6 +100,8 @@ public:
 
 protected:
     uint32_t id_;
+    bool batched_;
+    bool transactions_;
     mutable std::atomic<time_t> updated_;
     mutable std::atomic<uint16_t> sequence_;
 };
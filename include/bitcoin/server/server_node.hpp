@@ -19,7 +19,10 @@
 #ifndef LIBBITCOIN_SERVER_SERVER_NODE_HPP
 #define LIBBITCOIN_SERVER_SERVER_NODE_HPP
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <bitcoin/node.hpp>
 #include <bitcoin/protocol.hpp>
@@ -29,8 +32,22 @@
 #include <bitcoin/server/messages/subscription.hpp>
 #include <bitcoin/server/services/block_service.hpp>
 #include <bitcoin/server/services/heartbeat_service.hpp>
+#include <bitcoin/server/services/metrics_service.hpp>
 #include <bitcoin/server/services/query_service.hpp>
 #include <bitcoin/server/services/transaction_service.hpp>
+#include <bitcoin/server/utility/chain_tip.hpp>
+#include <bitcoin/server/utility/filter_cache.hpp>
+#include <bitcoin/server/utility/header_cache.hpp>
+#include <bitcoin/server/utility/history_cache.hpp>
+#include <bitcoin/server/utility/payment_keys.hpp>
+#include <bitcoin/server/utility/publisher.hpp>
+#include <bitcoin/server/utility/query_metrics.hpp>
+#include <bitcoin/server/utility/query_recorder.hpp>
+#include <bitcoin/server/utility/query_tracer.hpp>
+#include <bitcoin/server/utility/request_coalescer.hpp>
+#include <bitcoin/server/utility/response_cache.hpp>
+#include <bitcoin/server/utility/submission_queue.hpp>
+#include <bitcoin/server/utility/unconfirmed_index.hpp>
 #include <bitcoin/server/web/block_socket.hpp>
 #include <bitcoin/server/web/heartbeat_socket.hpp>
 #include <bitcoin/server/web/query_socket.hpp>
@@ -90,35 +107,130 @@ public:
     // ------------------------------------------------------------------------
 
     virtual system::code subscribe_key(const message& request,
-        system::hash_digest&& key, bool unsubscribe);
+        system::hash_digest&& key, bool unsubscribe, bool batched,
+        bool transactions);
 
     virtual system::code subscribe_stealth(const message& request,
         system::binary&& prefix_filter, bool unsubscribe);
 
+    /// The number of payment key subscriptions of the secure or public worker.
+    virtual size_t key_subscriptions(bool secure) const;
+
+    /// The number of stealth subscriptions of the secure or public worker.
+    virtual size_t stealth_subscriptions(bool secure) const;
+
+    // Publication.
+    // ------------------------------------------------------------------------
+
+    /// The publication stage shared by block and transaction services.
+    virtual publisher& publications();
+
+    // Query.
+    // ------------------------------------------------------------------------
+
+    /// The confirmed top block, kept current by reorganization.
+    virtual chain_tip& tip();
+
+    /// The query response cache, cleared on reorganization.
+    virtual response_cache& responses();
+
+    /// The confirmed header array, kept current by reorganization.
+    virtual header_cache& headers();
+
+    /// The confirmed compact filter header array, truncated by reorganization.
+    virtual filter_cache& filters();
+
+    /// The unconfirmed transactions by payment key, pruned on confirmation.
+    virtual unconfirmed_index& unconfirmed();
+
+    /// The hot payment key histories, dropped by key on block or pool.
+    virtual history_cache& histories();
+
+    /// The identical queries in flight, sharing one lookup.
+    virtual request_coalescer& coalescer();
+
+    /// The transaction broadcasts pending organization, by hash.
+    virtual submission_queue& broadcasts();
+
+    /// The transaction validations pending simulated organization, by hash.
+    virtual submission_queue& validations();
+
+    /// The query pipeline counters, shared by all query services.
+    virtual query_metrics& metrics();
+
+    /// The query sampler and slow query log, shared by all query services.
+    virtual query_tracer& tracer();
+
+    /// The query capture log, shared by all query workers.
+    virtual query_recorder& recorder();
+
 private:
+    typedef std::function<void()> warm_handler;
+    typedef std::function<void(size_t, warm_handler)> warm_reader;
+
     void handle_running(const system::code& ec, result_handler handler);
+    bool handle_reorganization(const system::code& ec, size_t fork_height,
+        system::block_const_ptr_list_const_ptr incoming,
+        system::block_const_ptr_list_const_ptr outgoing);
+    bool handle_transaction(const system::code& ec,
+        system::transaction_const_ptr tx);
+    void refresh_tip();
+    void handle_top_height(const system::code& ec, size_t height);
+    void handle_top_header(const system::code& ec,
+        system::header_const_ptr header, size_t height);
+    void drop_histories(const system::block_const_ptr_list& blocks);
+    void organize_transaction(system::transaction_const_ptr tx,
+        bool simulate, result_handler handler);
+
+    void warm(size_t count, warm_reader read);
+    void warm_up();
+    size_t warm_blocks();
+    size_t warm_keys();
+    void save_hot_keys() const;
+    boost::filesystem::path hot_keys_file() const;
 
     bool start_services();
     bool start_authenticator();
     bool start_query_services();
+    bool start_query_websockets();
     bool start_heartbeat_services();
     bool start_block_services();
     bool start_transaction_services();
-    bool start_query_workers(bool secure);
+    bool start_metrics_service();
+    bool start_query_instances(bool secure);
+    bool validate_query_instances(bool secure) const;
+    bool start_query_workers(query_service& service, bool secure,
+        uint16_t instance);
     bool start_notification_workers(bool secure);
 
     const configuration& configuration_;
 
     // These are thread safe.
     authenticator authenticator_;
+    publisher publisher_;
+    chain_tip tip_;
+    response_cache responses_;
+    header_cache headers_;
+    filter_cache filters_;
+    unconfirmed_index unconfirmed_;
+    history_cache histories_;
+    request_coalescer coalescer_;
+    submission_queue broadcasts_;
+    submission_queue validations_;
+    query_metrics metrics_;
+    query_tracer tracer_;
+    query_recorder recorder_;
     query_service secure_query_service_;
     query_service public_query_service_;
+    metrics_service metrics_service_;
 
     // Zeromq services
     heartbeat_service secure_heartbeat_service_;
     heartbeat_service public_heartbeat_service_;
     block_service secure_block_service_;
     block_service public_block_service_;
+    block_service secure_compact_block_service_;
+    block_service public_compact_block_service_;
     transaction_service secure_transaction_service_;
     transaction_service public_transaction_service_;
     notification_worker secure_notification_worker_;
@@ -131,8 +243,15 @@ private:
     heartbeat_socket public_heartbeat_websockets_;
     block_socket secure_block_websockets_;
     block_socket public_block_websockets_;
+    block_socket secure_compact_block_websockets_;
+    block_socket public_compact_block_websockets_;
     transaction_socket secure_transaction_websockets_;
     transaction_socket public_transaction_websockets_;
+    transaction_socket secure_compact_transaction_websockets_;
+    transaction_socket public_compact_transaction_websockets_;
+
+    // This is thread safe, set once the query services are serviceable.
+    std::atomic<bool> ready_;
 };
 
 } // namespace server
@@ -26,6 +26,8 @@
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/settings.hpp>
+#include <bitcoin/server/utility/cached_socket.hpp>
+#include <bitcoin/server/utility/publication.hpp>
 
 namespace libbitcoin {
 namespace server {
@@ -33,16 +35,17 @@ namespace server {
 class server_node;
 
 // This class is thread safe.
-// Subscribe to block acceptances into the long chain.
+// Subscribe to block acceptances into the long chain, optionally published
+// in compact form as the header and transaction hashes of each block.
 class BCS_API block_service
   : public bc::protocol::zmq::worker
 {
 public:
     typedef std::shared_ptr<block_service> ptr;
 
-    /// Construct a block service.
+    /// Construct a block service, optionally publishing compact blocks.
     block_service(bc::protocol::zmq::authenticator& authenticator,
-        server_node& node, bool secure);
+        server_node& node, bool secure, bool compact);
 
     /// Start the service.
     bool start() override;
@@ -57,26 +60,28 @@ protected:
     virtual void work() override;
 
 private:
-    bool handle_reorganization(const system::code& ec, size_t fork_height,
-        system::block_const_ptr_list_const_ptr incoming,
-        system::block_const_ptr_list_const_ptr outgoing);
+    void handle_blocks(const publication::list& blocks);
 
-    void publish_blocks(uint32_t fork_height,
-        system::block_const_ptr_list_const_ptr blocks);
-    void publish_block(socket& publisher, size_t height,
-        system::block_const_ptr block);
+    system::code publish_blocks(socket& pusher,
+        const publication::list& blocks);
+    system::code publish_block(socket& pusher, publication::ptr block);
+    system::code publish_chunks(socket& pusher, publication::ptr block);
 
     // These are thread safe.
     const bool secure_;
+    const bool compact_;
     const std::string security_;
     const bc::server::settings& settings_;
-    const bc::protocol::settings& external_;
+    const bc::protocol::settings external_;
     const bc::protocol::settings internal_;
     const system::config::endpoint service_;
     const system::config::endpoint worker_;
     bc::protocol::zmq::authenticator& authenticator_;
     server_node& node_;
 
+    // The pusher connects back to the worker endpoint on first publication.
+    cached_socket pusher_;
+
     // This is protected by reorganization non-concurrency.
     uint16_t sequence_;
 };
@@ -57,6 +57,7 @@ protected:
 
 private:
     int32_t pulse_milliseconds() const;
+    system::data_chunk status() const;
 
     // These are thread safe.
     const bool secure_;
@@ -0,0 +1,69 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_METRICS_SERVICE_HPP
+#define LIBBITCOIN_SERVER_METRICS_SERVICE_HPP
+
+#include <memory>
+#include <bitcoin/protocol.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/settings.hpp>
+#include <bitcoin/server/utility/query_metrics.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+class server_node;
+
+// This class is thread safe.
+// Serve the plaintext query metrics report to http scrapers. The endpoint is
+// a raw tcp stream, so it is not subject to the authenticator and should be
+// bound to a private interface.
+class BCS_API metrics_service
+  : public bc::protocol::zmq::worker
+{
+public:
+    typedef std::shared_ptr<metrics_service> ptr;
+
+    /// Construct a metrics endpoint.
+    metrics_service(bc::protocol::zmq::authenticator& authenticator,
+        server_node& node);
+
+protected:
+    typedef bc::protocol::zmq::socket socket;
+
+    virtual bool bind(socket& streamer);
+    virtual bool unbind(socket& streamer);
+    virtual void respond(socket& streamer);
+
+    // Implement the service.
+    virtual void work();
+
+private:
+    // These are thread safe.
+    const bc::server::settings& settings_;
+    const bc::protocol::settings& external_;
+    const system::config::endpoint& service_;
+    bc::protocol::zmq::authenticator& authenticator_;
+    query_metrics& metrics_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -19,11 +19,23 @@
 #ifndef LIBBITCOIN_SERVER_QUERY_SERVICE_HPP
 #define LIBBITCOIN_SERVER_QUERY_SERVICE_HPP
 
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
+#include <vector>
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/message.hpp>
 #include <bitcoin/server/settings.hpp>
+#include <bitcoin/server/utility/query_capacity.hpp>
+#include <bitcoin/server/utility/query_metrics.hpp>
+#include <bitcoin/server/utility/query_tracer.hpp>
+#include <bitcoin/server/utility/rate_limiter.hpp>
+#include <bitcoin/server/workers/query_pool.hpp>
 
 namespace libbitcoin {
 namespace server {
@@ -32,38 +44,98 @@ class server_node;
 
 // This class is thread safe.
 // Submit queries and address subscriptions and receive address notifications.
+// Constant cost commands are relayed to an express lane of workers.
+// Additional instances each bind the next port with their own workers.
+// Notifications are returned through the first instance, which passes those
+// of clients of other instances to the instance of the client connection.
 class BCS_API query_service
   : public bc::protocol::zmq::worker
 {
 public:
     typedef std::shared_ptr<query_service> ptr;
 
-    /// A reference to each inprocess worker endpoint.
-    static const system::config::endpoint& worker_endpoint(bool secure);
+    /// The inprocess worker endpoint of the instance.
+    static system::config::endpoint worker_endpoint(bool secure,
+        uint16_t instance);
 
-    /// Construct a query service.
+    /// The inprocess endpoint of the elastic worker slot of the instance.
+    static system::config::endpoint elastic_endpoint(bool secure,
+        uint16_t instance, size_t slot);
+
+    /// The inprocess express lane worker endpoint of the instance.
+    static system::config::endpoint express_endpoint(bool secure,
+        uint16_t instance);
+
+    /// A reference to the inprocess public query endpoint (websockets).
+    static const system::config::endpoint& local_endpoint();
+
+    /// The inproc endpoint of the notifications of the instance.
+    static system::config::endpoint notify_endpoint(bool secure,
+        uint16_t instance);
+
+    /// Construct a query service instance.
     query_service(bc::protocol::zmq::authenticator& authenticator,
-        server_node& node, bool secure);
+        server_node& node, bool secure, uint16_t instance);
+
+    /// The capacity of the standard or express lane of the instance.
+    query_capacity& capacity(bool express);
 
 protected:
     typedef bc::protocol::zmq::socket socket;
 
-    virtual bool bind(socket& router, socket& dealer);
-    virtual bool unbind(socket& router, socket& dealer);
+    typedef std::deque<message> backlog;
+    typedef bc::protocol::zmq::message::address address;
+
+    virtual bool bind(socket& router, socket& dealer, socket& express);
+    virtual bool unbind(socket& router, socket& dealer, socket& express);
+    virtual bool bind(socket& local, socket& notify);
+    virtual bool unbind(socket& local, socket& notify);
+    virtual void admit(socket& router, bool local);
+    virtual void dispatch(backlog& queue, socket& dealer);
+    virtual void dispatch(backlog& queue, socket& dealer,
+        query_capacity& capacity, size_t limit);
+    virtual void respond(socket& dealer, socket& router, socket& local);
+    virtual void deliver(socket& notify, socket& router, socket& local);
 
     // Implement the service.
     virtual void work();
 
 private:
+    static bool is_express(const std::string& command);
+
+    void release(const address& client);
+    bool bind_elastic(bc::protocol::zmq::poller& poller);
+    bool unbind_elastic();
+    size_t limit(size_t workers) const;
+    void scale(query_pool::clock::time_point now);
+
     // These are thread safe.
     const bool secure_;
+    const uint16_t instance_;
     const std::string security_;
     const bc::server::settings& settings_;
-    const bc::protocol::settings& external_;
+    const bc::protocol::settings external_;
     const bc::protocol::settings internal_;
-    const system::config::endpoint& service_;
-    const system::config::endpoint& worker_;
+    const system::config::endpoint service_;
+    const system::config::endpoint worker_;
+    const system::config::endpoint express_;
     bc::protocol::zmq::authenticator& authenticator_;
+    query_metrics& metrics_;
+    query_tracer& tracer_;
+    query_capacity capacity_;
+    query_capacity express_capacity_;
+
+    // These are protected by limit to single worker thread.
+    rate_limiter limiter_;
+    backlog express_backlog_;
+    backlog backlog_;
+    std::map<address, size_t> waiting_;
+    std::set<address> locals_;
+    std::vector<std::shared_ptr<socket>> peers_;
+    std::vector<std::shared_ptr<socket>> elastic_;
+
+    // This is thread safe.
+    query_pool pool_;
 };
 
 } // namespace server
@@ -25,6 +25,8 @@
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/settings.hpp>
+#include <bitcoin/server/utility/cached_socket.hpp>
+#include <bitcoin/server/utility/publication.hpp>
 
 namespace libbitcoin {
 namespace server {
@@ -56,21 +58,23 @@ protected:
     virtual void work() override;
 
 private:
-    bool handle_transaction(const system::code& ec,
-        system::transaction_const_ptr tx);
-    void publish_transaction(system::transaction_const_ptr tx);
+    void handle_transaction(publication::ptr tx);
+    system::code publish_transaction(socket& pusher, publication::ptr tx);
 
     // These are thread safe.
     const bool secure_;
     const std::string security_;
     const bc::server::settings& settings_;
-    const bc::protocol::settings& external_;
+    const bc::protocol::settings external_;
     const bc::protocol::settings internal_;
     const system::config::endpoint service_;
     const system::config::endpoint worker_;
     bc::protocol::zmq::authenticator& authenticator_;
     server_node& node_;
 
+    // The pusher connects back to the worker endpoint on first publication.
+    cached_socket pusher_;
+
     // This is protected by tx notification non-concurrency.
     uint16_t sequence_;
 };
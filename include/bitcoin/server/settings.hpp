@@ -40,37 +40,95 @@ public:
     system::asio::duration heartbeat_interval() const;
     system::asio::duration subscription_expiration() const;
     const system::config::endpoint& zeromq_query_endpoint(bool secure) const;
+    system::config::endpoint zeromq_query_endpoint(bool secure,
+        uint16_t instance) const;
     const system::config::endpoint& zeromq_heartbeat_endpoint(bool secure) const;
     const system::config::endpoint& zeromq_block_endpoint(bool secure) const;
+    const system::config::endpoint& zeromq_compact_block_endpoint(
+        bool secure) const;
     const system::config::endpoint& zeromq_transaction_endpoint(bool secure) const;
+    system::config::endpoint zeromq_ipc_endpoint(const std::string& name) const;
+
+    /// The common socket settings, with any nonzero high water overrides.
+    static bc::protocol::settings zeromq_tuned(
+        const bc::protocol::settings& common, uint32_t send_high_water,
+        uint32_t receive_high_water);
 
     const system::config::endpoint& websockets_query_endpoint(bool secure) const;
     const system::config::endpoint& websockets_heartbeat_endpoint(bool secure) const;
     const system::config::endpoint& websockets_block_endpoint(bool secure) const;
     const system::config::endpoint& websockets_transaction_endpoint(bool secure) const;
+    const system::config::endpoint& websockets_compact_block_endpoint(bool secure) const;
+    const system::config::endpoint& websockets_compact_transaction_endpoint(bool secure) const;
 
     /// [server]
     bool priority;
+    uint32_t query_send_high_water;
+    uint32_t query_receive_high_water;
+    uint32_t block_send_high_water;
+    uint32_t block_receive_high_water;
+    uint32_t transaction_send_high_water;
+    uint32_t transaction_receive_high_water;
     bool secure_only;
+    bool query_only;
+    uint16_t query_instances;
     uint16_t query_workers;
+    uint16_t query_workers_limit;
+    uint16_t express_query_workers;
+    uint16_t query_concurrency;
+    uint32_t query_rate_limit;
+    uint32_t query_backlog_limit;
+    uint32_t query_client_backlog_limit;
+    uint32_t response_cache_megabytes;
+    bool header_cache_enabled;
+    bool filter_cache_enabled;
+    uint32_t unconfirmed_index_limit;
+    uint32_t history_cache_megabytes;
+    uint32_t warm_up_blocks;
+    boost::filesystem::path warm_up_directory;
+    uint32_t query_chunk_kilobytes;
+    bool coalescing_enabled;
+    uint32_t slow_query_milliseconds;
+    uint32_t query_trace_sampling;
+    boost::filesystem::path query_capture_file;
+    uint32_t submission_limit;
     uint32_t subscription_limit;
+    uint32_t key_subscription_limit;
     uint32_t subscription_expiration_minutes;
+    boost::filesystem::path subscription_directory;
+    uint32_t purge_pause_budget_microseconds;
+    uint16_t notification_threads;
+    std::string query_service_cores;
+    std::string query_worker_cores;
+    std::string query_handler_cores;
+    std::string notification_cores;
+    std::string publisher_cores;
     uint32_t heartbeat_service_seconds;
+    bool heartbeat_status_enabled;
     bool block_service_enabled;
+    bool compact_block_service_enabled;
+    uint32_t block_chunk_kilobytes;
+    bool block_compression_enabled;
     bool transaction_service_enabled;
     system::config::authority::list client_addresses;
     system::config::authority::list blacklists;
+    system::config::endpoint metrics_endpoint;
+    boost::filesystem::path ipc_directory;
 
     /// [websockets]
     system::config::endpoint websockets_secure_query_endpoint;
     system::config::endpoint websockets_secure_heartbeat_endpoint;
     system::config::endpoint websockets_secure_block_endpoint;
     system::config::endpoint websockets_secure_transaction_endpoint;
+    system::config::endpoint websockets_secure_compact_block_endpoint;
+    system::config::endpoint websockets_secure_compact_transaction_endpoint;
 
     system::config::endpoint websockets_public_query_endpoint;
     system::config::endpoint websockets_public_heartbeat_endpoint;
     system::config::endpoint websockets_public_block_endpoint;
     system::config::endpoint websockets_public_transaction_endpoint;
+    system::config::endpoint websockets_public_compact_block_endpoint;
+    system::config::endpoint websockets_public_compact_transaction_endpoint;
 
     bool websockets_enabled;
 
@@ -79,11 +137,15 @@ public:
     system::config::endpoint zeromq_secure_heartbeat_endpoint;
     system::config::endpoint zeromq_secure_block_endpoint;
     system::config::endpoint zeromq_secure_transaction_endpoint;
+    system::config::endpoint zeromq_secure_compact_block_endpoint;
+    system::config::endpoint zeromq_secure_query_instances_endpoint;
 
     system::config::endpoint zeromq_public_query_endpoint;
     system::config::endpoint zeromq_public_heartbeat_endpoint;
     system::config::endpoint zeromq_public_block_endpoint;
     system::config::endpoint zeromq_public_transaction_endpoint;
+    system::config::endpoint zeromq_public_compact_block_endpoint;
+    system::config::endpoint zeromq_public_query_instances_endpoint;
 
     system::config::sodium zeromq_server_private_key;
     system::config::sodium::list zeromq_client_public_keys;
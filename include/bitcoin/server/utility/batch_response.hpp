@@ -0,0 +1,66 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_BATCH_RESPONSE_HPP
+#define LIBBITCOIN_SERVER_BATCH_RESPONSE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/message.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// Gathers the results of a batch of lookups, which may complete in any
+/// order and on any thread, into one length-prefixed response message.
+class BCS_API batch_response
+  : system::noncopyable
+{
+public:
+    typedef std::shared_ptr<batch_response> ptr;
+
+    /// Construct a response for count (non-zero) results to the request.
+    batch_response(size_t count, const message& request,
+        send_handler handler);
+
+    /// Set the result at index, sending the response once all are set.
+    /// Each index must be set exactly once.
+    void set(size_t index, const system::code& ec, system::data_chunk&& data);
+
+private:
+    void send();
+
+    // These are thread safe.
+    const message request_;
+    const send_handler handler_;
+    std::atomic<size_t> remaining_;
+
+    // Each element is written by one lookup and read after all complete.
+    std::vector<system::code> codes_;
+    std::vector<system::data_chunk> results_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_CACHED_SOCKET_HPP
+#define LIBBITCOIN_SERVER_CACHED_SOCKET_HPP
+
+#include <functional>
+#include <memory>
+#include <bitcoin/protocol.hpp>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// A lazily-connected outgoing socket that is retained across calls.
+/// Use of the socket is serialized, so each cache should be bound to a single
+/// producer (such as one subscription callback) to avoid contention. The
+/// mutex provides the memory barrier required to move the socket between
+/// the threads on which the producer is invoked.
+class BCS_API cached_socket
+  : system::noncopyable
+{
+public:
+    typedef bc::protocol::zmq::socket socket;
+    typedef std::function<system::code(socket&)> handler;
+
+    /// Construct a cache for a socket of the given role, connecting to the
+    /// specified endpoint upon first use.
+    cached_socket(bc::protocol::zmq::context& context, socket::role role,
+        const system::config::endpoint& endpoint,
+        const bc::protocol::settings& settings);
+
+    /// Invoke the handler with the connected socket, connecting if required.
+    /// The socket is discarded on failure and reconnected on the next call.
+    system::code send(handler handler);
+
+    /// Close the socket and reject subsequent calls.
+    /// This must be called before the context is stopped, since the context
+    /// cannot terminate while any of its sockets remains open.
+    bool stop();
+
+private:
+    // These are thread safe.
+    const socket::role role_;
+    const system::config::endpoint endpoint_;
+    const bc::protocol::settings& settings_;
+    bc::protocol::zmq::context& context_;
+
+    // These are protected by mutex.
+    bool stopped_;
+    std::shared_ptr<socket> socket_;
+    mutable system::shared_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
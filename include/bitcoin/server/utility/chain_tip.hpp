@@ -0,0 +1,77 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_CHAIN_TIP_HPP
+#define LIBBITCOIN_SERVER_CHAIN_TIP_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// A snapshot of the confirmed top block, set on start and by each chain
+/// reorganization, so that tip queries are answered without a chain read.
+/// The serialized header response is retained once the header is known.
+/// The stamp paces any periodic refresh of the tip from the store.
+class BCS_API chain_tip
+  : system::noncopyable
+{
+public:
+    typedef std::chrono::steady_clock clock;
+
+    /// Construct an empty tip (height zero and null hash, no header).
+    chain_tip();
+
+    /// The height of the top block.
+    size_t height() const;
+
+    /// The hash of the top block.
+    system::hash_digest hash() const;
+
+    /// Copy the serialized header response of the tip, if at the height.
+    bool find(system::data_chunk& out, size_t height) const;
+
+    /// Copy the serialized header response of the tip, if of the hash.
+    bool find(system::data_chunk& out, const system::hash_digest& hash) const;
+
+    /// Set the top block, of which the header is not known.
+    void set(size_t height, const system::hash_digest& hash);
+
+    /// Set the top block and retain its serialized header response.
+    void set(size_t height, const system::chain::header& header);
+
+    /// True, and stamped with now, if interval has elapsed since the stamp.
+    bool stale(clock::time_point now, clock::duration interval);
+
+private:
+    // These are protected by mutex.
+    clock::time_point stamped_;
+    size_t height_;
+    system::hash_digest hash_;
+    system::data_chunk response_;
+    mutable system::shared_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
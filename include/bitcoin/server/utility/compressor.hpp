@@ -0,0 +1,60 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_COMPRESSOR_HPP
+#define LIBBITCOIN_SERVER_COMPRESSOR_HPP
+
+#include <string>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/message.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// Payload compression in the lz4 block format, prefixed by the size of the
+/// uncompressed payload so that any lz4 block decoder may size its output.
+/// Compression is greedy and single pass, favoring speed over ratio.
+class BCS_API compressor
+{
+public:
+    /// [ size:4 ][ lz4 block... ]
+    static system::data_chunk compress(const system::data_chunk& data);
+
+    /// Decompress the size prefixed lz4 block, false if invalid.
+    static bool decompress(system::data_chunk& out,
+        const system::data_chunk& data);
+
+    /// [ code:4 ] or [ code:4 ][ size:4 ][ lz4 block... ]
+    /// Compress a query response payload, following its result code.
+    static system::data_chunk compress_response(
+        const system::data_chunk& payload);
+
+    /// True if the command is the compressed (.lz4) variant of a query.
+    static bool is_compressed(const std::string& command);
+
+    /// Compress the response if its command is a compressed variant.
+    /// A response that has already been compressed is returned unchanged.
+    static message compress_response(message&& response);
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
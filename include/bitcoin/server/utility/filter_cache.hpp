@@ -0,0 +1,104 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_FILTER_CACHE_HPP
+#define LIBBITCOIN_SERVER_FILTER_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// A contiguous array of the block hash, filter hash and filter header of
+/// basic compact filters, from genesis to the highest height yet read from
+/// the chain, from which filter header and checkpoint queries are answered.
+/// The array is extended by filter queries and truncated by reorganization,
+/// and an extension is rejected if a reorganization has popped blocks since
+/// its query began (as indicated by the generation).
+class BCS_API filter_cache
+  : system::noncopyable
+{
+public:
+    typedef std::vector<system::compact_filter_ptr> filters;
+
+    /// The (basic) filter type of the cache.
+    static const uint8_t filter_type;
+
+    /// The height interval of filter header checkpoints.
+    static const size_t checkpoint_interval;
+
+    /// Construct an empty cache, which retains nothing if not enabled.
+    filter_cache(bool enabled);
+
+    /// The current generation, advanced by each reorganization that pops.
+    size_t generation() const;
+
+    /// The number of cached filters, which is also the first uncached height.
+    size_t size() const;
+
+    /// Read the headers of the range, false if not fully cached.
+    bool read(system::message::compact_filter_headers& out, uint8_t type,
+        size_t start_height, size_t stop_height) const;
+
+    /// Read the headers of the range, false if not fully cached.
+    bool read(system::message::compact_filter_headers& out, uint8_t type,
+        size_t start_height, const system::hash_digest& stop_hash) const;
+
+    /// Read the checkpoint ending at the block, false if not cached.
+    bool read(system::message::compact_filter_checkpoint& out, uint8_t type,
+        const system::hash_digest& stop_hash) const;
+
+    /// Append the filters, which must start at or below the first uncached
+    /// height, if of the cache type and the generation remains current.
+    void write(size_t height, const filters& filters, size_t generation);
+
+    /// Drop filters above the fork point.
+    void reorganize(size_t fork_height, bool popped);
+
+private:
+    struct entry
+    {
+        system::hash_digest block_hash;
+        system::hash_digest filter_hash;
+        system::hash_digest filter_header;
+    };
+
+    bool find(size_t& out, const system::hash_digest& block_hash) const;
+    void read(system::message::compact_filter_headers& out,
+        size_t start_height, size_t stop_height) const;
+
+    // This is thread safe.
+    const bool enabled_;
+
+    // These are protected by mutex.
+    size_t generation_;
+    std::vector<entry> entries_;
+    std::unordered_map<system::hash_digest, size_t> heights_;
+    mutable system::shared_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_FILTER_RANGE_HPP
+#define LIBBITCOIN_SERVER_FILTER_RANGE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/message.hpp>
+#include <bitcoin/server/utility/filter_cache.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// Gathers a range of compact filters, which may complete in any order and
+/// on any thread, into a series of bounded response messages. The fetched
+/// filters are then written to the filter cache.
+class BCS_API filter_range
+  : system::noncopyable
+{
+public:
+    typedef std::shared_ptr<filter_range> ptr;
+
+    /// Construct a response for count (non-zero) filters from height.
+    filter_range(filter_cache& cache, size_t generation, size_t height,
+        size_t count, const message& request, send_handler handler);
+
+    /// Set the filter at index, sending the responses once all are set.
+    /// Each index must be set exactly once.
+    void set(size_t index, const system::code& ec,
+        system::compact_filter_ptr filter);
+
+private:
+    void send();
+
+    // These are thread safe.
+    filter_cache& cache_;
+    const size_t generation_;
+    const size_t height_;
+    const message request_;
+    const send_handler handler_;
+    std::atomic<size_t> remaining_;
+
+    // Each element is written by one lookup and read after all complete.
+    filter_cache::filters filters_;
+    std::vector<system::code> codes_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,76 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_HEADER_CACHE_HPP
+#define LIBBITCOIN_SERVER_HEADER_CACHE_HPP
+
+#include <cstddef>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// A contiguous array of serialized confirmed headers, from genesis to the
+/// highest height yet read from the chain. The array is extended by header
+/// range queries and kept current by chain reorganization, and an extension
+/// is rejected if a reorganization has popped blocks since its query began
+/// (as indicated by the generation).
+class BCS_API header_cache
+  : system::noncopyable
+{
+public:
+    /// The size of a serialized header.
+    static const size_t header_size;
+
+    /// Construct an empty cache, which retains nothing if not enabled.
+    header_cache(bool enabled);
+
+    /// The current generation, advanced by each reorganization that pops.
+    size_t generation() const;
+
+    /// The number of cached headers, which is also the first uncached height.
+    size_t size() const;
+
+    /// Append up to count cached headers from height, return count appended.
+    size_t read(system::data_chunk& out, size_t height, size_t count) const;
+
+    /// Append the serialized headers, which must start at the first uncached
+    /// height, if the generation remains current.
+    void write(size_t height, const system::data_chunk& headers,
+        size_t generation);
+
+    /// Drop headers above the fork point and append any incoming blocks.
+    void reorganize(size_t fork_height,
+        const system::block_const_ptr_list& incoming, bool popped);
+
+private:
+    // This is thread safe.
+    const bool enabled_;
+
+    // These are protected by mutex.
+    size_t generation_;
+    system::data_chunk headers_;
+    mutable system::shared_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_HEADER_RANGE_HPP
+#define LIBBITCOIN_SERVER_HEADER_RANGE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/message.hpp>
+#include <bitcoin/server/utility/header_cache.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// Gathers the uncached tail of a header range, which may complete in any
+/// order and on any thread, into one packed response message. The fetched
+/// headers are then written to the header cache.
+class BCS_API header_range
+  : system::noncopyable
+{
+public:
+    typedef std::shared_ptr<header_range> ptr;
+
+    /// Construct a response for count (non-zero) headers from height,
+    /// following the prefix of code and cached headers.
+    header_range(header_cache& cache, size_t generation, size_t height,
+        size_t count, system::data_chunk&& prefix, const message& request,
+        send_handler handler);
+
+    /// Set the header at index, sending the response once all are set.
+    /// Each index must be set exactly once.
+    void set(size_t index, const system::code& ec,
+        system::header_const_ptr header);
+
+private:
+    void send();
+
+    // These are thread safe.
+    header_cache& cache_;
+    const size_t generation_;
+    const size_t height_;
+    const message request_;
+    const send_handler handler_;
+    std::atomic<size_t> remaining_;
+
+    // Each element is written by one lookup and read after all complete.
+    system::data_chunk prefix_;
+    system::data_chunk headers_;
+    std::vector<system::code> codes_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_HISTORY_CACHE_HPP
+#define LIBBITCOIN_SERVER_HISTORY_CACHE_HPP
+
+#include <array>
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// A size-bounded, least recently used cache of the full payment histories
+/// of payment keys (script hashes). Reorganizations and pool transactions
+/// drop only the histories of the keys of their transactions, so that hot
+/// keys not in a block remain cached across blocks. Any history suffix (by
+/// from height) is read from a cached history. A store is rejected if its
+/// key may have been dropped since its query began (by sequence).
+class BCS_API history_cache
+  : system::noncopyable
+{
+public:
+    /// Construct a cache of up to capacity bytes of records (zero disables).
+    history_cache(size_t capacity);
+
+    /// True if the cache has capacity.
+    bool enabled() const;
+
+    /// The current sequence, advanced by each drop.
+    size_t sequence() const;
+
+    /// Copy the cached records at or above from height, true if found.
+    bool find(system::chain::payment_record::list& out,
+        const system::hash_digest& key, size_t from_height);
+
+    /// Cache the full history of the key, unless dropped since sequence.
+    void store(const system::hash_digest& key, size_t sequence,
+        const system::chain::payment_record::list& records);
+
+    /// Drop the histories of the keys.
+    void drop(const system::hash_list& keys);
+
+    /// The cached keys, most recently used first.
+    system::hash_list keys() const;
+
+private:
+    struct entry
+    {
+        system::hash_digest key;
+        system::chain::payment_record::list records;
+    };
+
+    typedef std::list<entry> entries;
+    typedef std::unordered_map<system::hash_digest, entries::iterator> index;
+
+    // Drops are recorded by slot of key, a collision only rejects a store.
+    static const size_t slot_count = 4096;
+    static size_t slot(const system::hash_digest& key);
+    static size_t size(const system::chain::payment_record::list& records);
+
+    // This is thread safe.
+    const size_t capacity_;
+
+    // These are protected by mutex.
+    size_t size_;
+    size_t sequence_;
+    entries entries_;
+    index index_;
+    std::array<size_t, slot_count> dropped_;
+    mutable system::shared_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
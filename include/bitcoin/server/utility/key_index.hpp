@@ -0,0 +1,116 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_KEY_INDEX_HPP
+#define LIBBITCOIN_SERVER_KEY_INDEX_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/route.hpp>
+#include <bitcoin/server/messages/subscription.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// Payment key subscriptions, hashed by key across independently locked
+/// shards. Each shard maintains a wheel of expiration buckets, so that purge
+/// visits only keys subscribed or renewed within expired buckets.
+class BCS_API key_index
+  : system::noncopyable
+{
+public:
+    typedef subscription::list list;
+
+    /// Construct an index of up to limit subscriptions.
+    key_index(size_t limit);
+
+    /// True if there are no subscriptions.
+    bool empty() const;
+
+    /// The number of subscriptions.
+    size_t size() const;
+
+    /// Add the route to the key, or renew its subscription time.
+    /// Renewal does not change the batching or the transaction notification
+    /// of an existing subscription.
+    system::code subscribe(const system::hash_digest& key, const route& route,
+        uint32_t id, time_t now, bool batched, bool transactions);
+
+    /// Remove the route from the key, if subscribed.
+    void unsubscribe(const system::hash_digest& key, const route& route);
+
+    /// Append each subscription to the key.
+    void match(list& out, const system::hash_digest& key) const;
+
+    /// Remove and append subscriptions updated before cutoff.
+    /// Removal may lag cutoff by up to one bucket period. A shard lock is
+    /// released after each batch of keys (zero is unbounded), bounding the
+    /// pause to notifiers.
+    /// Returns the longest period for which any shard lock was held.
+    std::chrono::microseconds purge(list& out, time_t cutoff, size_t batch);
+
+    /// Write all subscriptions, each shard is copied under its lock and then
+    /// written outside of it. Returns the number of subscriptions written.
+    size_t save(system::writer& sink) const;
+
+    /// Subscribe each saved subscription updated at or after cutoff, with
+    /// its saved update time. Returns the number of subscriptions loaded.
+    size_t load(system::reader& source, time_t cutoff);
+
+private:
+    typedef std::unordered_set<system::hash_digest> keys;
+
+    struct shard
+    {
+        // Subscriptions by key, and keys by bucket of update time.
+        std::unordered_map<system::hash_digest, list> subscriptions;
+        std::map<time_t, keys> wheel;
+        mutable system::shared_mutex mutex;
+    };
+
+    // Keys are script hashes, so a key byte selects a uniform shard.
+    static const size_t shard_count = 16;
+    static const time_t bucket_seconds = 60;
+
+    static time_t bucket(time_t time);
+    static bool purge(shard& shard, list& out, time_t cutoff, size_t batch);
+    shard& select(const system::hash_digest& key);
+    const shard& select(const system::hash_digest& key) const;
+
+    // This is thread safe.
+    const size_t limit_;
+    std::atomic<size_t> size_;
+
+    // Each shard is protected by its mutex.
+    std::array<shard, shard_count> shards_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,43 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_PAYMENT_KEYS_HPP
+#define LIBBITCOIN_SERVER_PAYMENT_KEYS_HPP
+
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// Derivation of the payment keys (script hashes) of a transaction, shared
+/// by notification, the unconfirmed index and the history cache.
+class BCS_API payment_keys
+{
+public:
+    /// The unique payment keys of the input and output scripts, sorted.
+    /// The scripts are serialized into one buffer, so that a transaction is
+    /// keyed with one allocation rather than one for each script.
+    static system::hash_list extract(const system::chain::transaction& tx);
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_PUBLICATION_HPP
+#define LIBBITCOIN_SERVER_PUBLICATION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// A block or transaction serialized once and shared by all services that
+/// publish it. The json rendering is produced on first use and then shared by
+/// all websockets that broadcast the same publication.
+class BCS_API publication
+  : system::noncopyable
+{
+public:
+    typedef std::shared_ptr<const publication> ptr;
+    typedef std::vector<ptr> list;
+    typedef std::shared_ptr<const std::string> json_ptr;
+
+    /// Construct a block publication at the given height.
+    publication(system::block_const_ptr block, size_t height);
+
+    /// Construct an (unconfirmed) transaction publication.
+    publication(system::transaction_const_ptr tx);
+
+    /// The height of the block, zero for a transaction.
+    size_t height() const;
+
+    /// The hash of the block or transaction.
+    const system::hash_digest& hash() const;
+
+    /// The canonical serialization of the block or transaction.
+    const system::data_chunk& data() const;
+
+    /// The compressed canonical serialization, compressed on first use and
+    /// then shared by all services that publish it.
+    const system::data_chunk& compressed() const;
+
+    /// The transaction, null for a block.
+    system::transaction_const_ptr transaction() const;
+
+    /// The block header and transaction hashes, empty for a transaction.
+    system::data_chunk compact() const;
+
+    /// True if the serialization matches the given data.
+    bool matches(const system::data_chunk& data) const;
+
+    /// The json rendering using the given sequence, rendered at most once for
+    /// each distinct sequence and encoding. Each websocket (secure or public)
+    /// broadcasts with its own sequence, so a rendering is retained for each.
+    /// A compact rendering carries the base16 serialization in place of the
+    /// object.
+    json_ptr json(uint16_t sequence, bool compact) const;
+
+private:
+    struct rendering
+    {
+        uint16_t sequence;
+        bool compact;
+        json_ptr json;
+    };
+
+    std::string to_compact_json(uint16_t sequence) const;
+
+    // These are thread safe.
+    const system::block_const_ptr block_;
+    const system::transaction_const_ptr transaction_;
+    const size_t height_;
+    const system::hash_digest hash_;
+    const system::data_chunk data_;
+
+    // These are protected by mutex.
+    mutable std::vector<rendering> renderings_;
+    mutable std::shared_ptr<const system::data_chunk> compressed_;
+    mutable system::upgrade_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,122 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_PUBLISHER_HPP
+#define LIBBITCOIN_SERVER_PUBLISHER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/utility/publication.hpp>
+#include <bitcoin/server/utility/serial_queue.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+class server_node;
+
+/// This class is thread safe.
+/// The shared publication stage, subscribed once to the node on behalf of all
+/// block and transaction services. Each block and transaction is serialized
+/// once and the resulting publication is passed to every registered service,
+/// and retained briefly so that websockets can reuse its json rendering.
+/// Blocks are published on a dedicated thread, in reorganization order, so
+/// that the reorganization handler returns without waiting on services.
+class BCS_API publisher
+  : system::noncopyable
+{
+public:
+    typedef std::function<void(const publication::list& blocks)>
+        block_handler;
+    typedef std::function<void(publication::ptr tx)> transaction_handler;
+
+    /// Construct a publication stage.
+    publisher(server_node& node);
+
+    /// Stop block publication, discarding pending reorganizations.
+    void stop();
+
+    /// Register a block service handler, subscribing to the node on first use.
+    void subscribe_blocks(block_handler&& handler);
+
+    /// Register a transaction service handler, subscribing on first use.
+    void subscribe_transactions(transaction_handler&& handler);
+
+    /// Find a recently published block by its serialization.
+    publication::ptr find_block(const system::data_chunk& data) const;
+
+    /// Find a recently published transaction by its serialization.
+    publication::ptr find_transaction(const system::data_chunk& data) const;
+
+    /// Find a recent block or publish it (unannounced) from its serialization
+    /// so that its rendering is shared even after eviction, null if invalid.
+    publication::ptr restore_block(const system::data_chunk& data,
+        size_t height);
+
+    /// Find a recent transaction or publish it (unannounced) from its
+    /// serialization, null if invalid.
+    publication::ptr restore_transaction(const system::data_chunk& data);
+
+    /// The number of blocks published since start.
+    uint64_t published_blocks() const;
+
+    /// The number of transactions published since start.
+    uint64_t published_transactions() const;
+
+private:
+    typedef std::deque<publication::ptr> publications;
+
+    static publication::ptr find(const publications& recent,
+        const system::data_chunk& data);
+
+    bool handle_reorganization(const system::code& ec, size_t fork_height,
+        system::block_const_ptr_list_const_ptr incoming,
+        system::block_const_ptr_list_const_ptr outgoing);
+    void publish_blocks(size_t fork_height,
+        system::block_const_ptr_list_const_ptr incoming);
+    bool handle_transaction(const system::code& ec,
+        system::transaction_const_ptr tx);
+
+    static void retain(publications& recent, publication::ptr item,
+        size_t limit);
+    publication::ptr restore(publications& recent, publication::ptr item,
+        size_t limit);
+
+    // These are thread safe.
+    server_node& node_;
+    serial_queue queue_;
+    std::atomic<uint64_t> published_blocks_;
+    std::atomic<uint64_t> published_transactions_;
+
+    // These are protected by mutex.
+    std::vector<block_handler> block_handlers_;
+    std::vector<transaction_handler> transaction_handlers_;
+    publications blocks_;
+    publications transactions_;
+    mutable system::shared_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
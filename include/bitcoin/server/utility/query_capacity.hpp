@@ -0,0 +1,62 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_QUERY_CAPACITY_HPP
+#define LIBBITCOIN_SERVER_QUERY_CAPACITY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// The queries dispatched to the workers of one query service lane that are
+/// not yet complete. A query is complete once its handler has returned, as
+/// the worker may then accept another. The service dispatches from its
+/// backlog only while the lane has free capacity, so that queries wait (and
+/// are prioritized and limited) in the backlog rather than in worker queues.
+class BCS_API query_capacity
+  : system::noncopyable
+{
+public:
+    /// Construct an idle lane.
+    query_capacity();
+
+    /// Count a query dispatched to the lane.
+    void dispatched();
+
+    /// Count a query of the lane completed (on any thread).
+    void completed();
+
+    /// The number of queries dispatched to the lane and not yet completed.
+    size_t outstanding() const;
+
+    /// True if fewer than limit queries are outstanding.
+    bool available(size_t limit) const;
+
+private:
+    std::atomic<size_t> outstanding_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,119 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_QUERY_METRICS_HPP
+#define LIBBITCOIN_SERVER_QUERY_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/message.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// Request, response, error, in flight and latency counters for each query
+/// command, and relay and drop counters for the query services. Latency is
+/// measured from the receipt of a query to the send of each of its responses.
+class BCS_API query_metrics
+  : system::noncopyable
+{
+public:
+    /// Latency buckets are powers of two microseconds, the last unbounded.
+    static const size_t buckets = 26;
+
+    /// The service counters and the queries in flight across all commands.
+    struct summary
+    {
+        uint64_t requested;
+        uint64_t responded;
+        uint64_t dropped;
+        uint64_t rejected;
+        uint64_t in_flight;
+    };
+
+    query_metrics();
+
+    /// Register a command, commands must be registered before recording.
+    void attach(const std::string& command);
+
+    /// Record the dispatch of a query to its command handler.
+    void dispatch(const std::string& command);
+
+    /// Record the return of a command handler.
+    void complete(const std::string& command);
+
+    /// Record a response to a query, reading its code and latency.
+    void respond(const message& response);
+
+    /// Record a request relayed by a query service.
+    void requested();
+
+    /// Record a response relayed by a query service.
+    void responded();
+
+    /// Record a message that a query service or worker failed to send.
+    void dropped();
+
+    /// Record a query rejected by a query service for admission.
+    void rejected();
+
+    /// Render all counters in the plaintext prometheus exposition format.
+    std::string report() const;
+
+    /// Read the service counters and the total of queries in flight.
+    summary summarize() const;
+
+private:
+    struct counters
+    {
+        counters();
+
+        std::atomic<uint64_t> requests;
+        std::atomic<uint64_t> responses;
+        std::atomic<uint64_t> errors;
+        std::atomic<uint64_t> in_flight;
+        std::atomic<uint64_t> latency_sum;
+        std::array<std::atomic<uint64_t>, buckets> latencies;
+    };
+
+    typedef std::map<std::string, counters> command_map;
+
+    counters* find(const std::string& command);
+
+    // These are thread safe.
+    std::atomic<uint64_t> requested_;
+    std::atomic<uint64_t> responded_;
+    std::atomic<uint64_t> dropped_;
+    std::atomic<uint64_t> rejected_;
+
+    // This is protected by mutex, counters are atomic.
+    command_map commands_;
+    mutable system::shared_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
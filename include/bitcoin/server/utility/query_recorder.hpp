@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_QUERY_RECORDER_HPP
+#define LIBBITCOIN_SERVER_QUERY_RECORDER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/message.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// Captures the queries received by the query workers to a compact binary
+/// log, each as its time of receipt (microseconds from the start of capture),
+/// command and payload. Records are buffered and written in blocks, so that
+/// capture does not write the file for each query. The log is replayed by
+/// the bs-bench replay mode.
+class BCS_API query_recorder
+  : system::noncopyable
+{
+public:
+    struct entry
+    {
+        uint64_t offset;
+        std::string command;
+        system::data_chunk data;
+    };
+
+    typedef std::vector<entry> entries;
+
+    /// Open the capture file for writing (empty path disables).
+    query_recorder(const boost::filesystem::path& file);
+
+    /// Write any buffered records.
+    ~query_recorder();
+
+    /// True if the capture file is open.
+    bool enabled() const;
+
+    /// Record the query.
+    void capture(const message& request);
+
+    /// Write any buffered records to the file.
+    void flush();
+
+    /// Read the records of a capture file, false if it is not valid.
+    static bool load(entries& out, const boost::filesystem::path& file);
+
+    /// Append the serialized record to the buffer.
+    static void serialize(system::data_chunk& out, uint64_t offset,
+        const std::string& command, const system::data_chunk& data);
+
+    /// Read the records of a serialized capture, false if truncated.
+    static bool deserialize(entries& out, const system::data_chunk& data);
+
+private:
+    void write();
+
+    // This is thread safe.
+    std::atomic<bool> enabled_;
+
+    // These are protected by mutex.
+    std::shared_ptr<system::ofstream> stream_;
+    system::data_chunk buffer_;
+    message::time_point start_;
+    bool started_;
+    mutable system::shared_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,71 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_QUERY_TRACER_HPP
+#define LIBBITCOIN_SERVER_QUERY_TRACER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/message.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// Samples queries for tracing and writes slow and sampled queries to the
+/// slow query log, identified by route and id. A sampled query records the
+/// times at which it is executed and each of its responses is created, so
+/// that its latency is divided into wait, execute and send stages.
+class BCS_API query_tracer
+  : system::noncopyable
+{
+public:
+    typedef message::time_point time_point;
+
+    /// Construct a tracer, sampling one of every sampling queries and logging
+    /// each query slower than slow_milliseconds (zero disables either).
+    query_tracer(uint32_t sampling, uint32_t slow_milliseconds);
+
+    /// Sample the query for tracing if it is next in the sampling interval.
+    void sample(message& request);
+
+    /// Log the query if it has waited in a service backlog beyond the limit.
+    void relay(const message& request);
+
+    /// Log the response if it is slow or sampled.
+    void respond(const message& response);
+
+    /// Describe the response by trace id, with its stage times if sampled.
+    static std::string describe(const message& response, time_point sent);
+
+private:
+    bool slow(const message& query, time_point now) const;
+
+    // These are thread safe.
+    const uint32_t sampling_;
+    const int64_t slow_microseconds_;
+    std::atomic<uint32_t> counter_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,71 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_RATE_LIMITER_HPP
+#define LIBBITCOIN_SERVER_RATE_LIMITER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <bitcoin/protocol.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is not thread safe.
+/// Token buckets of query admission for each client identity. Each bucket
+/// holds up to one second of tokens and refills continuously at the rate.
+class BCS_API rate_limiter
+  : system::noncopyable
+{
+public:
+    typedef std::chrono::steady_clock clock;
+    typedef bc::protocol::zmq::message::address identity;
+
+    /// Construct a limiter of rate queries per second (zero is unlimited).
+    rate_limiter(uint32_t rate);
+
+    /// The number of tracked identities.
+    size_t size() const;
+
+    /// Take a token from the identity's bucket, false if it is empty.
+    bool admit(const identity& client, clock::time_point now);
+
+    /// Drop buckets that would be full at now, as they are indistinct from
+    /// untracked identities.
+    void prune(clock::time_point now);
+
+private:
+    struct bucket
+    {
+        double tokens;
+        clock::time_point updated;
+    };
+
+    double refill(const bucket& bucket, clock::time_point now) const;
+
+    const double rate_;
+    std::map<identity, bucket> buckets_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,77 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_REQUEST_COALESCER_HPP
+#define LIBBITCOIN_SERVER_REQUEST_COALESCER_HPP
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/message.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// Identical queries (by command and arguments) in flight at the same time
+/// share the lookup of the first, and each is answered with a copy of its
+/// serialized response. Only queries with a single response are coalesced.
+class BCS_API request_coalescer
+  : system::noncopyable
+{
+public:
+    /// Construct a coalescer (if not enabled no request is joined).
+    request_coalescer(bool enabled);
+
+    /// The number of lookups in flight that may be joined.
+    size_t pending() const;
+
+    /// Join the request to an identical lookup in flight, true if joined.
+    /// Otherwise the caller performs the lookup and the handler is replaced
+    /// by one that also answers each request joined in the meantime.
+    bool join(send_handler& handler, const message& request);
+
+private:
+    struct waiter
+    {
+        message request;
+        send_handler handler;
+    };
+
+    typedef std::vector<waiter> waiters;
+
+    static std::string to_key(const message& request);
+
+    void complete(message&& response, const std::string& key,
+        send_handler handler);
+
+    // This is thread safe.
+    const bool enabled_;
+
+    // This is protected by mutex.
+    std::unordered_map<std::string, waiters> pending_;
+    mutable system::shared_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_RESPONSE_CACHE_HPP
+#define LIBBITCOIN_SERVER_RESPONSE_CACHE_HPP
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/message.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// A size-bounded, least recently used cache of serialized query responses,
+/// keyed by command, arguments and witness. Entries are dropped on chain
+/// reorganization, and a store is rejected if a reorganization has occurred
+/// since its query began (as indicated by the generation).
+class BCS_API response_cache
+  : system::noncopyable
+{
+public:
+    /// Construct a cache of up to capacity bytes of payload (zero disables).
+    response_cache(size_t capacity);
+
+    /// The current generation, advanced by each clear.
+    size_t generation() const;
+
+    /// Copy the cached response payload for the request, true if found.
+    bool find(system::data_chunk& out, const message& request,
+        bool witness);
+
+    /// Send the cached response to the handler, true if found.
+    bool respond(const message& request, bool witness, send_handler handler);
+
+    /// Cache the response payload, if the generation remains current.
+    void store(const message& request, bool witness, size_t generation,
+        const system::data_chunk& payload);
+
+    /// Drop all entries and advance the generation.
+    void clear();
+
+private:
+    struct entry
+    {
+        std::string key;
+        system::data_chunk payload;
+    };
+
+    typedef std::list<entry> entries;
+    typedef std::unordered_map<std::string, entries::iterator> index;
+
+    static std::string to_key(const message& request, bool witness);
+
+    // This is thread safe.
+    const size_t capacity_;
+
+    // These are protected by mutex.
+    size_t size_;
+    size_t generation_;
+    entries entries_;
+    index index_;
+    mutable system::shared_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
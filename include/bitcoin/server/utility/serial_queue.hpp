@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_SERIAL_QUEUE_HPP
+#define LIBBITCOIN_SERVER_SERIAL_QUEUE_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// A dedicated thread that executes jobs in the order pushed, so that a
+/// subscription handler may hand off its work and return immediately.
+class BCS_API serial_queue
+  : system::noncopyable
+{
+public:
+    typedef std::function<void()> job;
+
+    serial_queue();
+
+    /// Stop and join the thread, discarding pending jobs.
+    ~serial_queue();
+
+    /// Start the thread, no-op if started.
+    void start();
+
+    /// Stop and join the thread, discarding pending jobs.
+    void stop();
+
+    /// Queue a job for execution, false if not started.
+    bool push(job&& item);
+
+private:
+    void run();
+
+    // These are protected by mutex.
+    bool running_;
+    std::deque<job> jobs_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,107 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_STEALTH_INDEX_HPP
+#define LIBBITCOIN_SERVER_STEALTH_INDEX_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/route.hpp>
+#include <bitcoin/server/messages/subscription.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// Stealth prefix subscriptions, in one hash table per filter length. A
+/// bitmap of occupied lengths limits each match to one probe per length in
+/// use, and a wheel of expiration buckets bounds purge as with key_index.
+class BCS_API stealth_index
+  : system::noncopyable
+{
+public:
+    typedef subscription::list list;
+
+    /// Construct an index of up to limit subscriptions.
+    stealth_index(size_t limit);
+
+    /// True if there are no subscriptions.
+    bool empty() const;
+
+    /// The number of subscriptions.
+    size_t size() const;
+
+    /// Add the route to the filter, or renew its subscription time.
+    system::code subscribe(const system::binary& filter, const route& route,
+        uint32_t id, time_t now);
+
+    /// Remove the route from the filter, if subscribed.
+    void unsubscribe(const system::binary& filter, const route& route);
+
+    /// Append each subscription with a filter matching prefix.
+    void match(list& out, uint32_t prefix) const;
+
+    /// Remove and append subscriptions updated before cutoff.
+    /// Removal may lag cutoff by up to one bucket period. The lock is
+    /// released after each batch of filters (zero is unbounded), bounding the
+    /// pause to notifiers. Returns the longest period the lock was held.
+    std::chrono::microseconds purge(list& out, time_t cutoff, size_t batch);
+
+private:
+    // Filters by value of their leading bits, for one filter length.
+    typedef std::unordered_map<uint32_t, list> filters;
+
+    // A filter length and value, for expiration buckets.
+    typedef uint64_t entry;
+    typedef std::unordered_set<entry> entries;
+
+    // Lengths are indexed from one (the bitmap and table cover 1..32).
+    static const size_t lengths = sizeof(uint32_t) * system::byte_bits;
+    static const time_t bucket_seconds = 60;
+
+    static time_t bucket(time_t time);
+    static uint32_t to_stream(uint32_t prefix);
+    static uint32_t to_stream(const system::binary& filter);
+    static uint32_t leading(uint32_t stream, size_t bits);
+    bool purge(list& out, time_t cutoff, size_t batch);
+    void erase(size_t bits, uint32_t value);
+
+    // This is thread safe.
+    const size_t limit_;
+
+    // These are protected by mutex.
+    size_t size_;
+    uint32_t occupied_;
+    std::array<filters, lengths> filters_;
+    std::map<time_t, entries> wheel_;
+    mutable system::shared_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
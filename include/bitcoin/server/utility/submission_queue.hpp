@@ -0,0 +1,74 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_SUBMISSION_QUEUE_HPP
+#define LIBBITCOIN_SERVER_SUBMISSION_QUEUE_HPP
+
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// Transaction submissions pending organization, deduplicated by hash, so
+/// that concurrent submissions of one transaction are organized once and
+/// each is answered with its result. The organizer is asynchronous, so that
+/// no query worker waits on organization.
+class BCS_API submission_queue
+  : system::noncopyable
+{
+public:
+    typedef std::function<void(const system::code&)> result_handler;
+    typedef std::function<void(system::transaction_const_ptr,
+        result_handler)> organizer;
+
+    /// Construct a queue of up to limit pending transactions (zero is
+    /// unbounded), each passed once to the organizer.
+    submission_queue(organizer&& organize, size_t limit);
+
+    /// The number of transactions pending organization.
+    size_t pending() const;
+
+    /// Submit the transaction, the handler is invoked with its result.
+    /// Returns oversubscribed (without invoking the handler) if at limit.
+    system::code submit(system::transaction_const_ptr tx,
+        result_handler&& handler);
+
+private:
+    typedef std::vector<result_handler> handlers;
+
+    void complete(const system::code& ec, const system::hash_digest& hash);
+
+    // These are thread safe.
+    const organizer organize_;
+    const size_t limit_;
+
+    // This is protected by mutex.
+    std::unordered_map<system::hash_digest, handlers> pending_;
+    mutable system::shared_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,56 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_THREAD_AFFINITY_HPP
+#define LIBBITCOIN_SERVER_THREAD_AFFINITY_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// Placement of threads on a set of cores, configured as a list of core
+/// numbers and ranges (such as "0-3,8"). Memory is allocated on the node of
+/// the core that first touches it, so a thread is pinned as it starts, before
+/// it allocates, and the cores of one socket then keep its memory local.
+class BCS_API thread_affinity
+{
+public:
+    /// Parse the core list, false if invalid (empty is valid).
+    static bool parse(std::vector<size_t>& out, const std::string& cores);
+
+    /// Pin the calling thread to the cores, no-op if empty. A failure is
+    /// logged as a warning for the named thread, which is left unpinned.
+    static bool pin(const std::string& cores, const std::string& name);
+
+    /// Pin each thread of the running pool to the cores, no-op if empty.
+    /// Each thread is held (for up to a second) until all are pinned, so that
+    /// no thread is pinned twice while another is not pinned.
+    static void pin(system::threadpool& pool, const std::string& cores,
+        const std::string& name);
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
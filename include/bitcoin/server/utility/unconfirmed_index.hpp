@@ -0,0 +1,76 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_UNCONFIRMED_INDEX_HPP
+#define LIBBITCOIN_SERVER_UNCONFIRMED_INDEX_HPP
+
+#include <cstddef>
+#include <deque>
+#include <unordered_map>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+/// This class is thread safe.
+/// Unconfirmed transaction hashes by payment key (script hash), added as
+/// transactions are accepted to the pool and removed as they are confirmed.
+/// Transactions dropped from the pool are not announced, so the oldest are
+/// evicted once the limit is reached.
+class BCS_API unconfirmed_index
+  : system::noncopyable
+{
+public:
+    /// Construct an index of up to limit transactions (zero disables).
+    unconfirmed_index(size_t limit);
+
+    /// The number of indexed transactions.
+    size_t size() const;
+
+    /// Index the transaction by the payment keys of its scripts.
+    void add(const system::chain::transaction& tx);
+
+    /// Index the transaction by its payment keys, as extracted.
+    void add(const system::chain::transaction& tx, system::hash_list&& keys);
+
+    /// Remove the transactions of the confirmed blocks.
+    void confirm(const system::block_const_ptr_list& blocks);
+
+    /// Append the hashes of unconfirmed transactions of the key.
+    void read(system::hash_list& out, const system::hash_digest& key) const;
+
+private:
+    typedef std::unordered_map<system::hash_digest, system::hash_list> map;
+
+    void remove(const system::hash_digest& tx_hash);
+
+    // This is thread safe.
+    const size_t limit_;
+
+    // These are protected by mutex.
+    map transactions_by_key_;
+    map keys_by_transaction_;
+    std::deque<system::hash_digest> order_;
+    mutable system::shared_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
@@ -19,6 +19,7 @@
 #ifndef LIBBITCOIN_SERVER_WEB_BLOCK_SOCKET_HPP
 #define LIBBITCOIN_SERVER_WEB_BLOCK_SOCKET_HPP
 
+#include <cstdint>
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/settings.hpp>
@@ -36,9 +37,10 @@ class BCS_API block_socket
 public:
     typedef std::shared_ptr<block_socket> ptr;
 
-    /// Construct a block socket service endpoint.
+    /// Construct a block socket service endpoint, compact sockets render
+    /// blocks as base16 serializations in place of json objects.
     block_socket(bc::protocol::zmq::context& context, server_node& node,
-        bool secure);
+        bool secure, bool compact);
 
 protected:
     // Implement the service.
@@ -48,10 +50,18 @@ protected:
     virtual const system::config::endpoint& websocket_endpoint() const override;
 
 private:
-    bool handle_block(bc::protocol::zmq::socket& subscriber);
+    bool handle_block(bc::protocol::zmq::message& notification);
+    bool handle_chunk(bc::protocol::zmq::message& notification,
+        uint16_t& sequence, uint32_t& height, system::data_chunk& block);
 
+    const bool compact_;
     const bc::server::settings& settings_;
     const bc::protocol::settings& protocol_settings_;
+    server_node& node_;
+
+    // These are used only on the work thread.
+    uint16_t chunk_sequence_;
+    system::data_chunk chunks_;
 };
 
 } // namespace server
@@ -49,7 +49,7 @@ protected:
     virtual const system::config::endpoint& websocket_endpoint() const override;
 
 private:
-    bool handle_heartbeat(bc::protocol::zmq::socket& subscriber);
+    bool handle_heartbeat(bc::protocol::zmq::message& notification);
 
     const bc::server::settings& settings_;
     const bc::protocol::settings& protocol_settings_;
@@ -19,6 +19,9 @@
 #ifndef LIBBITCOIN_SERVER_WEB_QUERY_SOCKET_HPP
 #define LIBBITCOIN_SERVER_WEB_QUERY_SOCKET_HPP
 
+#include <cstdint>
+#include <string>
+#include <unordered_set>
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/settings.hpp>
@@ -58,11 +61,19 @@ protected:
     const system::config::endpoint& query_endpoint() const;
 
 private:
+    static std::string native_command(const std::string& command);
+
     bool handle_query(bc::protocol::zmq::socket& dealer);
+    bool set_compact(uint32_t sequence);
+    bool clear_compact(uint32_t sequence);
 
     const bc::server::settings& settings_;
     const bc::protocol::settings& protocol_settings_;
     std::shared_ptr<bc::protocol::zmq::socket> service_;
+
+    // These are protected by mutex.
+    std::unordered_set<uint32_t> compact_sequences_;
+    system::shared_mutex compact_mutex_;
 };
 
 } // namespace server
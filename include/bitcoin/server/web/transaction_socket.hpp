@@ -36,9 +36,10 @@ class BCS_API transaction_socket
 public:
     typedef std::shared_ptr<transaction_socket> ptr;
 
-    /// Construct a transaction socket service endpoint.
+    /// Construct a transaction socket service endpoint, compact sockets
+    /// render transactions as base16 serializations in place of json objects.
     transaction_socket(bc::protocol::zmq::context& context, server_node& node,
-        bool secure);
+        bool secure, bool compact);
 
 protected:
 
@@ -49,10 +50,12 @@ protected:
     virtual const system::config::endpoint& websocket_endpoint() const override;
 
 private:
-    bool handle_transaction(bc::protocol::zmq::socket& subscriber);
+    bool handle_transaction(bc::protocol::zmq::message& notification);
 
+    const bool compact_;
     const bc::server::settings& settings_;
     const bc::protocol::settings& protocol_settings_;
+    server_node& node_;
 };
 
 } // namespace server
@@ -19,22 +19,27 @@
 #ifndef LIBBITCOIN_SERVER_NOTIFICATION_WORKER_HPP
 #define LIBBITCOIN_SERVER_NOTIFICATION_WORKER_HPP
 
+#include <atomic>
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 #include <bitcoin/system.hpp>
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/messages/message.hpp>
 #include <bitcoin/server/messages/route.hpp>
 #include <bitcoin/server/messages/subscription.hpp>
 #include <bitcoin/server/settings.hpp>
-
-// Include after define.hpp (placeholders).
-#include <boost/bimap.hpp>
-#include <boost/bimap/multiset_of.hpp>
+#include <bitcoin/server/utility/cached_socket.hpp>
+#include <bitcoin/server/utility/key_index.hpp>
+#include <bitcoin/server/utility/payment_keys.hpp>
+#include <bitcoin/server/utility/serial_queue.hpp>
+#include <bitcoin/server/utility/stealth_index.hpp>
 
 namespace libbitcoin {
 namespace server {
@@ -56,14 +61,25 @@ public:
     /// Start the worker.
     bool start() override;
 
-    /// Subscribe to payment key notifications.
+    /// Subscribe to payment key notifications, optionally batched or
+    /// carrying the transaction.
     virtual system::code subscribe_key(const message& request,
-        system::hash_digest&& key, bool unsubscribe);
+        system::hash_digest&& key, bool unsubscribe, bool batched,
+        bool transactions);
 
     /// Subscribe to stealth notifications.
     virtual system::code subscribe_stealth(const message& request,
         system::binary&& prefix_filter, bool unsubscribe);
 
+    /// The number of payment key subscriptions.
+    size_t key_subscriptions() const;
+
+    /// The number of stealth subscriptions.
+    size_t stealth_subscriptions() const;
+
+    /// The longest period for which purge has held a subscription lock.
+    std::chrono::microseconds maximum_purge_pause() const;
+
 protected:
 
     // Implement the service.
@@ -72,35 +88,49 @@ protected:
 private:
     typedef bc::protocol::zmq::socket socket;
     typedef std::unordered_set<uint32_t> stealth_set;
-    typedef std::unordered_set<system::hash_digest> key_set;
 
-    // Purge:     route.created (constant: 1).
-    // Notify:    address (constant: 1).
-    // Subscribe: address + route (constant + linear).
-    // Drop:      route (linear) [not implemented].
-    // A bidirectional map is used for efficient hash and age retrieval.
-    // This produces the effect of a circular hash table of subscriptions.
-    // Since address hashes are fixed length, 1 query returns all matches.
-    typedef boost::bimaps::bimap<
-        boost::bimaps::multiset_of<system::hash_digest>,
-        boost::bimaps::multiset_of<subscription>> key_subscriptions;
-
-    // Purge:     route.created (constant: 1).
-    // Notify:    prefix (constant: 24 [32-8]).
-    // Subscribe: prefix + route (constant + linear).
-    // Drop:      route (linear) [not implemented].
-    // A bidirectional map is used for efficient prefix and age retrieval.
-    // This produces the effect of a circular hash table of subscriptions.
-    // Since prefix matching varies by length, but is constrained to 8-32 bits,
-    // we simply query 24 times against the hash table to find all matches.
-    typedef boost::bimaps::bimap<
-        boost::bimaps::multiset_of<system::binary>,
-        boost::bimaps::multiset_of<subscription >> stealth_subscriptions;
+    // The payment keys and stealth prefixes of one transaction.
+    struct extraction
+    {
+        system::hash_digest tx_hash;
+        const system::chain::transaction* tx;
+        system::hash_list keys;
+        stealth_set prefixes;
+    };
+
+    typedef std::vector<extraction> extractions;
+
+    // A subscription matched to a source, with its sequence as of the match.
+    struct match
+    {
+        subscription::ptr routing;
+        size_t index;
+        uint16_t sequence;
+    };
+
+    typedef std::vector<match> matches;
+
+    // Batched notifications to one route, accumulated for one reorganization.
+    // The route address identifies the client within its service instance.
+    struct batch
+    {
+        subscription::ptr routing;
+        uint32_t count;
+        system::data_chunk tuples;
+    };
+
+    typedef std::pair<uint16_t, bc::protocol::zmq::message::address> client;
+    typedef std::map<client, batch> batches;
 
     static time_t current_time();
     time_t cutoff_time() const;
     int32_t purge_milliseconds() const;
     void purge();
+    void record_pause(std::chrono::microseconds pause);
+
+    boost::filesystem::path snapshot_file() const;
+    void load_subscriptions();
+    void save_subscriptions() const;
 
     bool key_subscriptions_empty() const;
     bool stealth_subscriptions_empty() const;
@@ -111,18 +141,34 @@ private:
     bool handle_transaction_pool(const system::code& ec,
         system::transaction_const_ptr tx);
 
-    void notify_block(socket& dealer, size_t height,
-        system::block_const_ptr block);
-    void notify_transaction(socket& dealer, size_t height,
+    system::code notify_blocks(socket& dealer, size_t fork_height,
+        system::block_const_ptr_list_const_ptr blocks);
+    system::code notify_block(socket& dealer, size_t height,
+        system::block_const_ptr block, batches& batched);
+    system::code notify_transaction(socket& dealer, size_t height,
         const system::chain::transaction& tx);
-    void notify(socket& dealer, const key_set& keys,
-        const stealth_set& prefixes, size_t height,
-        const system::hash_digest& tx_hash);
-
-    socket::ptr connect();
-    bool send(socket& dealer, const subscription& routing,
-        const std::string& command, const system::code& status, size_t height,
+    system::code notify(socket& dealer, const extractions& items,
+        size_t height, batches& batched);
+    system::code notify(socket& dealer, const matches& items,
+        const extractions& sources, const std::string& command,
+        size_t height, batches& batched);
+    system::code notify_batches(socket& dealer, const batches& batched);
+
+    size_t partitions(size_t transactions) const;
+    void extract_partition(extractions& out,
+        const system::chain::transaction::list& txs, size_t begin,
+        size_t end, bool keys, bool stealth) const;
+    static void extract(extraction& out,
+        const system::chain::transaction& tx, bool keys, bool stealth);
+    system::code notify_expirations(socket& dealer,
+        const subscription::list& expires, const std::string& command);
+
+    system::code send(socket& dealer, const subscription& routing,
+        uint16_t sequence, const std::string& command,
+        const system::code& status, size_t height,
         const system::hash_digest& tx_hash);
+    system::code send(socket& dealer, const subscription& routing,
+        uint16_t sequence, size_t height, const system::data_chunk& tx);
 
     // These are thread safe.
     const bool secure_;
@@ -130,15 +176,36 @@ private:
     const bc::server::settings& settings_;
     const bc::protocol::settings& external_;
     const bc::protocol::settings internal_;
-    const system::config::endpoint& worker_;
+    const system::config::endpoint worker_;
+    const size_t threads_;
     bc::protocol::zmq::authenticator& authenticator_;
     server_node& node_;
 
-    // These are protected by mutex.
-    key_subscriptions key_subscriptions_;
-    stealth_subscriptions stealth_subscriptions_;
-    mutable system::upgrade_mutex key_mutex_;
-    mutable system::upgrade_mutex stealth_mutex_;
+    // Each dealer is bound to one notification source and reused across
+    // notifications, avoiding a socket connect per block or transaction.
+    cached_socket block_dealer_;
+    cached_socket transaction_dealer_;
+    cached_socket purge_dealer_;
+
+    // Block notifications are sent in order, off the reorganization thread.
+    serial_queue reorganizations_;
+
+    // Purge:     expired buckets (linear in expired keys).
+    // Notify:    address (constant: 1).
+    // Subscribe: address + route (constant + linear in routes per address).
+    // Drop:      route (linear) [not implemented].
+    // This is thread safe, each shard is protected by its own mutex.
+    key_index key_subscriptions_;
+
+    // This is thread safe.
+    std::atomic<int64_t> maximum_pause_;
+
+    // Purge:     expired buckets (linear in expired filters).
+    // Notify:    prefix (constant: one per filter length in use).
+    // Subscribe: prefix + route (constant + linear in routes per prefix).
+    // Drop:      route (linear) [not implemented].
+    // This is thread safe.
+    stealth_index stealth_subscriptions_;
 };
 
 } // namespace server
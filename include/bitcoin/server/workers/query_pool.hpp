@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_SERVER_QUERY_POOL_HPP
+#define LIBBITCOIN_SERVER_QUERY_POOL_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <bitcoin/protocol.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/utility/query_capacity.hpp>
+#include <bitcoin/server/workers/query_worker.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+class server_node;
+
+/// This class is thread safe.
+/// The elastic standard lane query workers of a query service instance, in
+/// addition to its configured workers. A worker is added while queries wait
+/// in the service backlog and one is retired after a period without backlog.
+/// Each worker occupies a slot, which the service dispatches through its own
+/// endpoint and capacity, so that a retiring worker is first removed from
+/// dispatch and then answers the queries already dispatched to it. Workers
+/// are started on the node threadpool, and retire on their own threads.
+class BCS_API query_pool
+  : system::noncopyable
+{
+public:
+    typedef std::chrono::steady_clock clock;
+
+    /// Construct a pool of up to limit workers (zero disables).
+    query_pool(bc::protocol::zmq::authenticator& authenticator,
+        server_node& node, bool secure, uint16_t instance, size_t limit);
+
+    /// The number of worker slots.
+    size_t slots() const;
+
+    /// The capacity of the worker of the slot.
+    query_capacity& capacity(size_t slot);
+
+    /// True if the slot has a started worker that is not retiring.
+    bool dispatchable(size_t slot) const;
+
+    /// Evaluate the depth of the service backlog and the wait of its oldest
+    /// query, adding or retiring a worker as required. This must be invoked
+    /// on the service thread, which dispatches the slots.
+    void adjust(size_t depth, clock::duration wait, clock::time_point now);
+
+    /// Stop all workers, no worker is added after stop.
+    void stop();
+
+private:
+    struct slot
+    {
+        query_capacity capacity;
+        std::atomic<bool> active;
+        bool retiring;
+        query_worker::ptr worker;
+    };
+
+    void grow(size_t index);
+    void shrink();
+    void reap();
+
+    // These are thread safe.
+    const bool secure_;
+    const uint16_t instance_;
+    bc::protocol::zmq::authenticator& authenticator_;
+    server_node& node_;
+    std::atomic<bool> adjusting_;
+    std::atomic<bool> stopped_;
+
+    // This is protected by limit to the single service thread.
+    clock::time_point busy_;
+
+    // Slot workers are protected by mutex, retiring by the service thread.
+    std::vector<std::shared_ptr<slot>> slots_;
+    mutable system::shared_mutex mutex_;
+};
+
+} // namespace server
+} // namespace libbitcoin
+
+#endif
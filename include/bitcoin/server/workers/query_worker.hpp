@@ -19,6 +19,9 @@
 #ifndef LIBBITCOIN_SERVER_QUERY_WORKER_HPP
 #define LIBBITCOIN_SERVER_QUERY_WORKER_HPP
 
+#include <atomic>
+#include <cstddef>
+#include <deque>
 #include <memory>
 #include <functional>
 #include <string>
@@ -27,6 +30,11 @@
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/messages/message.hpp>
 #include <bitcoin/server/settings.hpp>
+#include <bitcoin/server/utility/cached_socket.hpp>
+#include <bitcoin/server/utility/query_capacity.hpp>
+#include <bitcoin/server/utility/query_metrics.hpp>
+#include <bitcoin/server/utility/query_recorder.hpp>
+#include <bitcoin/server/utility/query_tracer.hpp>
 
 namespace libbitcoin {
 namespace server {
@@ -41,14 +49,27 @@ class BCS_API query_worker
 public:
     typedef std::shared_ptr<query_worker> ptr;
 
-    /// Construct a query worker.
+    /// Construct a query worker of the query service instance, connected
+    /// to the given lane endpoint and completing its queries against the
+    /// capacity of that lane.
     query_worker(bc::protocol::zmq::authenticator& authenticator,
-        server_node& node, bool secure);
+        server_node& node, query_capacity& capacity,
+        const system::config::endpoint& endpoint, bool secure,
+        uint16_t instance);
+
+    /// Signal the worker to exit once its lane has no query outstanding,
+    /// returns without waiting. The lane must no longer be dispatched.
+    void retire();
+
+    /// True once a retiring worker has answered its queries and exited.
+    bool retired() const;
 
 protected:
     typedef bc::protocol::zmq::socket socket;
 
-    typedef std::function<void(const message&, send_handler)> command_handler;
+    // Handlers are the static interface methods, invoked directly.
+    typedef void(*command_handler)(server_node&, const message&,
+        send_handler);
     typedef std::unordered_map<std::string, command_handler> command_map;
 
     virtual void attach_interface();
@@ -56,24 +77,56 @@ protected:
 
     virtual bool connect(socket& dealer);
     virtual bool disconnect(socket& dealer);
+    virtual bool bind(socket& puller);
+    virtual bool unbind(socket& puller);
     virtual void query(socket& dealer);
+    virtual void respond(socket& puller, socket& dealer);
 
     // Implement the worker.
     virtual void work();
 
 private:
-    static void send(const message& response,
-        bc::protocol::zmq::socket& dealer);
+    static system::code signal(bc::protocol::zmq::socket& pusher);
+    static std::string responses_endpoint(bool secure);
+
+    bool accepting() const;
+    bool drained() const;
+    std::shared_ptr<query_worker> outstanding();
+    void flush(bc::protocol::zmq::socket& dealer);
+    void send(message&& response, bc::protocol::zmq::socket& dealer);
+    void deliver(message&& outgoing, bc::protocol::zmq::socket& dealer);
+    void execute(command_handler handler,
+        std::shared_ptr<const message> request);
+    void enqueue(message&& response);
 
     // These are thread safe.
     const bool secure_;
+    const uint16_t instance_;
     const std::string security_;
     const bc::server::settings& settings_;
     const bc::protocol::settings& external_;
     const bc::protocol::settings internal_;
-    const system::config::endpoint& worker_;
+    const system::config::endpoint worker_;
+    const system::config::endpoint responses_;
     bc::protocol::zmq::authenticator& authenticator_;
     server_node& node_;
+    query_metrics& metrics_;
+    query_tracer& tracer_;
+    query_recorder& recorder_;
+    query_capacity& capacity_;
+
+    // Requests executing on the node threadpool queue their responses for
+    // the worker thread and signal it through this pusher, so that response
+    // payloads are moved rather than copied through an inproc socket.
+    cached_socket pusher_;
+    std::atomic<size_t> in_flight_;
+    std::atomic<size_t> outstanding_;
+    std::atomic<bool> retiring_;
+    std::atomic<bool> retired_;
+
+    // This is protected by mutex.
+    std::deque<message> pending_;
+    system::shared_mutex pending_mutex_;
 
     // This is protected by worker base class mutex.
     command_map command_handlers_;
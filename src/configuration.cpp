@@ -33,5 +33,16 @@ configuration::configuration(config::settings context)
 {
 }
 
+// The manual session remains, but there are no peers for it to connect.
+void configuration::disable_sessions()
+{
+    network.inbound_port = 0;
+    network.inbound_connections = 0;
+    network.outbound_connections = 0;
+    network.host_pool_capacity = 0;
+    network.peers.clear();
+    network.seeds.clear();
+}
+
 } // namespace server
 } // namespace libbitcoin
@@ -18,10 +18,13 @@
  */
 #include <bitcoin/server/interface/blockchain.hpp>
 
+#include <algorithm>
 #include <cstdint>
 #include <cstddef>
 #include <functional>
+#include <memory>
 #include <utility>
+#include <vector>
 #include <bitcoin/blockchain.hpp>
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/configuration.hpp>
@@ -43,6 +46,43 @@ static constexpr size_t index_size = sizeof(uint32_t);
 static constexpr size_t point_size = hash_size + sizeof(uint32_t);
 static constexpr auto canonical = system::message::version::level::canonical;
 
+// Batch queries are bounded by the number of lookups.
+static constexpr size_t batch_limit = 10000;
+static constexpr size_t headers_limit = 2000;
+static constexpr size_t filters_limit = 1000;
+
+// History pages are bounded, and are streamed in bounded responses.
+static constexpr uint32_t history_page_limit = 100000;
+static constexpr size_t history_chunk_records = 1000;
+
+// The history cursor of the first page and following the last page.
+static constexpr uint32_t history_no_cursor = max_uint32;
+
+// The ordinal of the record at position among the records of its height.
+static uint32_t history_ordinal(const payment_record::list& payments,
+    size_t position)
+{
+    const auto height = payments[position].height();
+    return static_cast<uint32_t>(std::count_if(payments.begin(),
+        payments.begin() + position, [height](const payment_record& record)
+        {
+            return record.height() == height;
+        }));
+}
+
+// The position of the record at the cursor height and ordinal, or the end.
+static size_t history_position(const payment_record::list& payments,
+    uint32_t height, uint32_t ordinal)
+{
+    uint32_t count = 0;
+
+    for (size_t position = 0; position < payments.size(); ++position)
+        if (payments[position].height() == height && count++ == ordinal)
+            return position;
+
+    return payments.size();
+}
+
 // TODO: create interface doc for unordered list, unconfirmeds and key change.
 void blockchain::fetch_history4(server_node& node, const message& request,
     send_handler handler)
@@ -61,10 +101,62 @@ void blockchain::fetch_history4(server_node& node, const message& request,
     auto deserial = make_safe_deserializer(data.begin(), data.end());
     const auto key = deserial.read_reverse<hash_digest>();
     const size_t from_height = deserial.read_4_bytes_little_endian();
+    auto& cache = node.histories();
 
-    node.chain().fetch_history(key, default_limit, from_height,
-        std::bind(&blockchain::history_fetched,
-            _1, _2, request, handler));
+    // Any suffix of a hot key history is read from its cached full history.
+    payment_record::list payments;
+    if (cache.find(payments, key, from_height))
+    {
+        history_fetched(error::success, payments, request, handler);
+        return;
+    }
+
+    // Identical queries in flight share one lookup and its response.
+    if (node.coalescer().join(handler, request))
+        return;
+
+    if (!cache.enabled())
+    {
+        node.chain().fetch_history(key, default_limit, from_height,
+            std::bind(&blockchain::history_fetched,
+                _1, _2, request, handler));
+        return;
+    }
+
+    // The store is discarded if the key is dropped before the fetch returns.
+    // The store reads the full history, which is scanned for any from height.
+    const auto sequence = cache.sequence();
+    node.chain().fetch_history(key, default_limit, 0,
+        std::bind(&blockchain::history_cached,
+            _1, _2, key, from_height, request, handler, std::ref(cache),
+                sequence));
+}
+
+void blockchain::history_cached(const code& ec,
+    const payment_record::list& payments, const hash_digest& key,
+    size_t from_height, const message& request, send_handler handler,
+    history_cache& cache, size_t sequence)
+{
+    if (ec)
+    {
+        history_fetched(ec, {}, request, handler);
+        return;
+    }
+
+    cache.store(key, sequence, payments);
+
+    if (from_height == 0)
+    {
+        history_fetched(ec, payments, request, handler);
+        return;
+    }
+
+    payment_record::list suffix;
+    for (const auto& record: payments)
+        if (record.height() >= from_height)
+            suffix.push_back(record);
+
+    history_fetched(ec, suffix, request, handler);
 }
 
 void blockchain::history_fetched(const code& ec,
@@ -83,6 +175,178 @@ void blockchain::history_fetched(const code& ec,
     handler(message(request, std::move(result)));
 }
 
+// Lookups may complete concurrently, each sets its own batch result.
+void blockchain::fetch_history_batch(server_node& node,
+    const message& request, send_handler handler)
+{
+    static constexpr size_t default_limit = 0;
+    const auto& data = request.data();
+    const auto count = data.size() < sizeof(uint32_t) ? 0 :
+        (data.size() - sizeof(uint32_t)) / hash_size;
+
+    if (count == 0 || count > batch_limit ||
+        data.size() != sizeof(uint32_t) + count * hash_size)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    // [ from_height:4 ]
+    // [[ key:32 ]...]
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    const size_t from_height = deserial.read_4_bytes_little_endian();
+    const auto batch = std::make_shared<batch_response>(count, request,
+        handler);
+
+    for (size_t index = 0; index < count; ++index)
+        node.chain().fetch_history(deserial.read_reverse<hash_digest>(),
+            default_limit, from_height,
+            std::bind(&blockchain::history_batched,
+                _1, _2, batch, index));
+}
+
+void blockchain::history_batched(const code& ec,
+    const payment_record::list& payments, batch_response::ptr batch,
+    size_t index)
+{
+    static const auto record_size = payment_record::satoshi_fixed_size(true);
+
+    if (ec)
+    {
+        batch->set(index, ec, {});
+        return;
+    }
+
+    data_chunk result(record_size * payments.size());
+    auto serial = make_unsafe_serializer(result.begin());
+
+    // Unconfirmed transactions have height sentinal of max_uint32.
+    for (const auto& record: payments)
+        record.to_data(serial, true);
+
+    batch->set(index, error::success, std::move(result));
+}
+
+// The cursor is the height of the next record and its ordinal among the
+// records of that height, so records added ahead of it at other heights do
+// not shift the page, as they would a record offset. The store limits history
+// from the most recent record, so a page is read with the records that
+// precede its cursor, which are then skipped.
+void blockchain::fetch_history5(server_node& node, const message& request,
+    send_handler handler)
+{
+    static constexpr size_t history_args_size = hash_size +
+        4 * sizeof(uint32_t);
+
+    const auto& data = request.data();
+
+    if (data.size() != history_args_size)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    // [ key:32 ]
+    // [ from_height:4 ]
+    // [ limit:4 ] (zero for maximum)
+    // [ cursor_height:4 ] (max_uint32 for first page)
+    // [ cursor_ordinal:4 ] (max_uint32 for first page)
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    const auto key = deserial.read_reverse<hash_digest>();
+    const size_t from_height = deserial.read_4_bytes_little_endian();
+    const auto requested = deserial.read_4_bytes_little_endian();
+    const auto cursor_height = deserial.read_4_bytes_little_endian();
+    const auto cursor_ordinal = deserial.read_4_bytes_little_endian();
+
+    const auto limit = requested == 0 ? history_page_limit :
+        std::min(requested, history_page_limit);
+
+    // The page and the record that follows it, if it precedes the cursor.
+    fetch_history_page(node, key, from_height, size_t(limit) + 1,
+        cursor_height, cursor_ordinal, limit, request, handler);
+}
+
+void blockchain::fetch_history_page(server_node& node, const hash_digest& key,
+    size_t from_height, size_t fetch, uint32_t cursor_height,
+    uint32_t cursor_ordinal, uint32_t limit, const message& request,
+    send_handler handler)
+{
+    node.chain().fetch_history(key, fetch, from_height,
+        std::bind(&blockchain::history_paged,
+            _1, _2, std::ref(node), key, from_height, fetch, cursor_height,
+                cursor_ordinal, limit, request, handler));
+}
+
+void blockchain::history_paged(const code& ec,
+    const payment_record::list& payments, server_node& node,
+    const hash_digest& key, size_t from_height, size_t fetched,
+    uint32_t cursor_height, uint32_t cursor_ordinal, uint32_t limit,
+    const message& request, send_handler handler)
+{
+    static const auto record_size = payment_record::satoshi_fixed_size(true);
+    static constexpr size_t header_size = code_size + 2 * sizeof(uint32_t) +
+        sizeof(uint8_t);
+
+    if (ec)
+    {
+        handler(message(request, ec));
+        return;
+    }
+
+    // All records have been read if fewer than requested were returned.
+    const auto complete = fetched == 0 || payments.size() < fetched;
+    const auto first = cursor_height == history_no_cursor &&
+        cursor_ordinal == history_no_cursor;
+
+    const auto begin = first ? size_t(0) :
+        history_position(payments, cursor_height, cursor_ordinal);
+    const auto end = std::min(begin + limit, payments.size());
+
+    // Read twice the records until the page and the record that follows it
+    // are read, or there are no more records (zero reads all records).
+    if (!complete && end == payments.size())
+    {
+        const auto fetch = fetched > max_size_t / 2 ? 0 : 2 * fetched;
+        fetch_history_page(node, key, from_height, fetch, cursor_height,
+            cursor_ordinal, limit, request, handler);
+        return;
+    }
+
+    // The record that follows the page is the next cursor, if any.
+    const auto more = end < payments.size();
+    const auto next_height = more ?
+        static_cast<uint32_t>(payments[end].height()) : history_no_cursor;
+    const auto next_ordinal = more ? history_ordinal(payments, end) :
+        history_no_cursor;
+
+    auto index = begin;
+
+    do
+    {
+        const auto count = std::min(history_chunk_records, end - index);
+        const auto last = (index + count == end);
+
+        // [ code:4 ]
+        // [ next_height:4 ] (max_uint32 following the last page)
+        // [ next_ordinal:4 ] (max_uint32 following the last page)
+        // [ last:1 ] (of this page)
+        // [ records... ]
+        data_chunk result(header_size + record_size * count);
+        auto serial = make_unsafe_serializer(result.begin());
+        serial.write_error_code(error::success);
+        serial.write_4_bytes_little_endian(next_height);
+        serial.write_4_bytes_little_endian(next_ordinal);
+        serial.write_byte(last ? 1 : 0);
+
+        // Unconfirmed transactions have height sentinal of max_uint32.
+        for (auto record = index; record < index + count; ++record)
+            payments[record].to_data(serial, true);
+
+        handler(message(request, std::move(result)));
+        index += count;
+    } while (index < end);
+}
+
 void blockchain::fetch_transaction(server_node& node, const message& request,
     send_handler handler)
 {
@@ -101,10 +365,16 @@ void blockchain::fetch_transaction(server_node& node, const message& request,
     // This response excludes witness data so as not to break old parsers.
     const auto require_confirmed = true;
     const auto witness = false;
+    auto& cache = node.responses();
+    const auto generation = cache.generation();
+
+    if (cache.respond(request, witness, handler))
+        return;
 
     node.chain().fetch_transaction(hash, require_confirmed, witness,
         std::bind(&blockchain::transaction_fetched,
-            _1, _2, _3, _4, request, handler));
+            _1, _2, _3, _4, request, handler, std::ref(cache), witness,
+                generation));
 }
 
 void blockchain::fetch_transaction2(server_node& node, const message& request,
@@ -127,14 +397,21 @@ void blockchain::fetch_transaction2(server_node& node, const message& request,
     const auto require_confirmed = true;
     const auto witness = script::is_enabled(
         node.blockchain_settings().enabled_forks(), rule_fork::bip141_rule);
+    auto& cache = node.responses();
+    const auto generation = cache.generation();
+
+    if (cache.respond(request, witness, handler))
+        return;
 
     node.chain().fetch_transaction(hash, require_confirmed, witness,
         std::bind(&blockchain::transaction_fetched,
-            _1, _2, _3, _4, request, handler));
+            _1, _2, _3, _4, request, handler, std::ref(cache), witness,
+                generation));
 }
 
 void blockchain::transaction_fetched(const code& ec, transaction_const_ptr tx,
-    size_t, size_t, const message& request, send_handler handler)
+    size_t, size_t, const message& request, send_handler handler,
+    response_cache& cache, bool witness, size_t generation)
 {
     if (ec)
     {
@@ -142,15 +419,51 @@ void blockchain::transaction_fetched(const code& ec, transaction_const_ptr tx,
         return;
     }
 
-    auto result = build_chunk(
-    {
-        message::to_bytes(error::success),
-        tx->to_data(canonical)
-    });
+    auto result = message::to_bytes(*tx, canonical);
 
+    cache.store(request, witness, generation, result);
     handler(message(request, std::move(result)));
 }
 
+void blockchain::fetch_transactions(server_node& node,
+    const message& request, send_handler handler)
+{
+    const auto& data = request.data();
+    const auto count = data.size() / hash_size;
+
+    if (count == 0 || count > batch_limit || data.size() % hash_size != 0)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    // The response is restricted to confirmed transactions.
+    // This response can include witness data (based on configuration).
+    const auto require_confirmed = true;
+    const auto witness = script::is_enabled(
+        node.blockchain_settings().enabled_forks(), rule_fork::bip141_rule);
+
+    // [[ hash:32 ]...]
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    const auto batch = std::make_shared<batch_response>(count, request,
+        handler);
+
+    for (size_t index = 0; index < count; ++index)
+        node.chain().fetch_transaction(deserial.read_hash(),
+            require_confirmed, witness,
+            std::bind(&blockchain::transaction_batched,
+                _1, _2, _3, _4, batch, index));
+}
+
+void blockchain::transaction_batched(const code& ec, transaction_const_ptr tx,
+    size_t, size_t, batch_response::ptr batch, size_t index)
+{
+    if (ec)
+        batch->set(index, ec, {});
+    else
+        batch->set(index, error::success, tx->to_data(canonical));
+}
+
 void blockchain::fetch_last_height(server_node& node, const message& request,
     send_handler handler)
 {
@@ -162,9 +475,9 @@ void blockchain::fetch_last_height(server_node& node, const message& request,
         return;
     }
 
-    node.chain().fetch_last_height(
-        std::bind(&blockchain::last_height_fetched,
-            _1, _2, request, handler));
+    // The tip is answered from its snapshot, without a chain read.
+    last_height_fetched(error::success, node.tip().height(), request,
+        handler);
 }
 
 void blockchain::last_height_fetched(const code& ec, size_t last_height,
@@ -206,10 +519,12 @@ void blockchain::fetch_compact_filter_by_hash(server_node& node,
     auto deserial = make_safe_deserializer(data.begin(), data.end());
     const auto filter_type = deserial.read_byte();
     const auto block_hash = deserial.read_hash();
+    auto& cache = node.filters();
+    const auto generation = cache.generation();
 
     node.chain().fetch_compact_filter(filter_type, block_hash,
         std::bind(&blockchain::compact_filter_fetched,
-            _1, _2, _3, request, handler));
+            _1, _2, _3, request, handler, std::ref(cache), generation));
 }
 
 void blockchain::fetch_compact_filter_by_height(server_node& node,
@@ -221,15 +536,18 @@ void blockchain::fetch_compact_filter_by_height(server_node& node,
     auto deserial = make_safe_deserializer(data.begin(), data.end());
     const auto filter_type = deserial.read_byte();
     const uint64_t height = deserial.read_4_bytes_little_endian();
+    auto& cache = node.filters();
+    const auto generation = cache.generation();
 
     node.chain().fetch_compact_filter(filter_type, height,
         std::bind(&blockchain::compact_filter_fetched,
-            _1, _2, _3, request, handler));
+            _1, _2, _3, request, handler, std::ref(cache), generation));
 }
 
 void blockchain::compact_filter_fetched(const code& ec,
-    system::compact_filter_ptr response, size_t, const message& request,
-    send_handler handler)
+    system::compact_filter_ptr response, size_t height,
+    const message& request, send_handler handler, filter_cache& cache,
+    size_t generation)
 {
     if (ec)
     {
@@ -237,17 +555,61 @@ void blockchain::compact_filter_fetched(const code& ec,
         return;
     }
 
+    // Extends the filter header array if this is its next filter.
+    cache.write(height, { response }, generation);
+
     // [ code:4 ]
     // [ compact filter... ]
-    auto result = build_chunk(
-    {
-        message::to_bytes(error::success),
-        response->to_data(canonical)
-    });
+    auto result = message::to_bytes(*response, canonical);
 
     handler(message(request, std::move(result)));
 }
 
+void blockchain::fetch_compact_filters(server_node& node,
+    const message& request, send_handler handler)
+{
+    static constexpr size_t filters_args_size = 1u + 2 * sizeof(uint32_t);
+    const auto& data = request.data();
+
+    if (data.size() != filters_args_size)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    // [ filter_type:1 ]
+    // [ start_height:4 ]
+    // [ stop_height:4 ]
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    const auto filter_type = deserial.read_byte();
+    const size_t start_height = deserial.read_4_bytes_little_endian();
+    const size_t stop_height = deserial.read_4_bytes_little_endian();
+
+    if (stop_height < start_height ||
+        stop_height - start_height >= filters_limit)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    auto& cache = node.filters();
+    const auto generation = cache.generation();
+    const auto count = stop_height - start_height + 1;
+    const auto range = std::make_shared<filter_range>(cache, generation,
+        start_height, count, request, handler);
+
+    for (size_t index = 0; index < count; ++index)
+        node.chain().fetch_compact_filter(filter_type, start_height + index,
+            std::bind(&blockchain::filter_ranged,
+                _1, _2, _3, range, index));
+}
+
+void blockchain::filter_ranged(const code& ec, compact_filter_ptr filter,
+    size_t, filter_range::ptr range, size_t index)
+{
+    range->set(index, ec, filter);
+}
+
 void blockchain::fetch_compact_filter_headers(server_node& node,
     const message& request, send_handler handler)
 {
@@ -271,6 +633,13 @@ void blockchain::fetch_compact_filter_headers_by_hash(server_node& node,
     const auto filter_type = deserial.read_byte();
     const auto start_height = deserial.read_4_bytes_little_endian();
     const auto stop_hash = deserial.read_hash();
+    system::message::compact_filter_headers headers;
+
+    if (node.filters().read(headers, filter_type, start_height, stop_hash))
+    {
+        handler(message(request, message::to_bytes(headers, canonical)));
+        return;
+    }
 
     node.chain().fetch_compact_filter_headers(filter_type, start_height,
         stop_hash, std::bind(&blockchain::compact_filter_headers_fetched,
@@ -287,6 +656,13 @@ void blockchain::fetch_compact_filter_headers_by_height(server_node& node,
     const auto filter_type = deserial.read_byte();
     const auto start_height = deserial.read_4_bytes_little_endian();
     const auto stop_height = deserial.read_4_bytes_little_endian();
+    system::message::compact_filter_headers headers;
+
+    if (node.filters().read(headers, filter_type, start_height, stop_height))
+    {
+        handler(message(request, message::to_bytes(headers, canonical)));
+        return;
+    }
 
     node.chain().fetch_compact_filter_headers(filter_type, start_height,
         stop_height, std::bind(&blockchain::compact_filter_headers_fetched,
@@ -305,11 +681,7 @@ void blockchain::compact_filter_headers_fetched(const code& ec,
 
     // [ code:4 ]
     // [ compact filter headers... ]
-    auto result = build_chunk(
-    {
-        message::to_bytes(error::success),
-        response->to_data(canonical)
-    });
+    auto result = message::to_bytes(*response, canonical);
 
     handler(message(request, std::move(result)));
 }
@@ -328,6 +700,13 @@ void blockchain::fetch_compact_filter_checkpoint(server_node& node,
     auto deserial = make_safe_deserializer(data.begin(), data.end());
     const auto filter_type = deserial.read_byte();
     const auto stop_hash = deserial.read_hash();
+    system::message::compact_filter_checkpoint checkpoint;
+
+    if (node.filters().read(checkpoint, filter_type, stop_hash))
+    {
+        handler(message(request, message::to_bytes(checkpoint, canonical)));
+        return;
+    }
 
     node.chain().fetch_compact_filter_checkpoint(filter_type, stop_hash,
         std::bind(&blockchain::compact_filter_checkpoint_fetched,
@@ -346,11 +725,7 @@ void blockchain::compact_filter_checkpoint_fetched(const code& ec,
 
     // [ code:4 ]
     // [ compact filter checkpoint... ]
-    auto result = build_chunk(
-    {
-        message::to_bytes(error::success),
-        checkpoint->to_data(canonical),
-    });
+    auto result = message::to_bytes(*checkpoint, canonical);
 
     handler(message(request, std::move(result)));
 }
@@ -368,6 +743,32 @@ void blockchain::fetch_block(server_node& node, const message& request,
         handler(message(request, error::bad_stream));
 }
 
+// Each chunk is a response, so the client may parse as the block arrives.
+// The chunks are produced together, so this limits response size only.
+void blockchain::fetch_block_chunks(server_node& node, const message& request,
+    send_handler handler)
+{
+    const auto& data = request.data();
+    const auto witness = script::is_enabled(
+        node.blockchain_settings().enabled_forks(), rule_fork::bip141_rule);
+    const auto chunk_size = size_t(
+        node.server_settings().query_chunk_kilobytes) << 10;
+
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+
+    if (data.size() == hash_size)
+        node.chain().fetch_block(deserial.read_hash(), witness,
+            std::bind(&blockchain::block_chunked,
+                _1, _2, chunk_size, request, handler));
+    else if (data.size() == sizeof(uint32_t))
+        node.chain().fetch_block(
+            size_t(deserial.read_4_bytes_little_endian()), witness,
+            std::bind(&blockchain::block_chunked,
+                _1, _2, chunk_size, request, handler));
+    else
+        handler(message(request, error::bad_stream));
+}
+
 void blockchain::fetch_block_by_hash(server_node& node,
     const message& request, send_handler handler)
 {
@@ -379,10 +780,15 @@ void blockchain::fetch_block_by_hash(server_node& node,
 
     const auto witness = script::is_enabled(
         node.blockchain_settings().enabled_forks(), rule_fork::bip141_rule);
+    auto& cache = node.responses();
+    const auto generation = cache.generation();
+
+    if (cache.respond(request, witness, handler))
+        return;
 
     node.chain().fetch_block(block_hash, witness,
         std::bind(&blockchain::block_fetched,
-            _1, _2, request, handler));
+            _1, _2, request, handler, std::ref(cache), witness, generation));
 }
 
 void blockchain::fetch_block_by_height(server_node& node,
@@ -396,10 +802,15 @@ void blockchain::fetch_block_by_height(server_node& node,
 
     const auto witness = script::is_enabled(
         node.blockchain_settings().enabled_forks(), rule_fork::bip141_rule);
+    auto& cache = node.responses();
+    const auto generation = cache.generation();
+
+    if (cache.respond(request, witness, handler))
+        return;
 
     node.chain().fetch_block(height, witness,
         std::bind(&blockchain::block_fetched,
-            _1, _2, request, handler));
+            _1, _2, request, handler, std::ref(cache), witness, generation));
 }
 
 void blockchain::fetch_block_header(server_node& node, const message& request,
@@ -415,6 +826,63 @@ void blockchain::fetch_block_header(server_node& node, const message& request,
         handler(message(request, error::bad_stream));
 }
 
+void blockchain::fetch_block_headers(server_node& node,
+    const message& request, send_handler handler)
+{
+    static constexpr size_t headers_args_size = 2 * sizeof(uint32_t);
+    const auto& data = request.data();
+
+    if (data.size() != headers_args_size)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    // [ from_height:4 ]
+    // [ count:4 ]
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    const size_t from_height = deserial.read_4_bytes_little_endian();
+    const size_t count = deserial.read_4_bytes_little_endian();
+
+    if (count == 0 || count > headers_limit)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    auto& cache = node.headers();
+    const auto generation = cache.generation();
+
+    // [ code:4 ]
+    // [[ header:80 ]...]
+    data_chunk result;
+    result.reserve(code_size + count * header_cache::header_size);
+    extend_data(result, message::to_bytes(error::success));
+    const auto cached = cache.read(result, from_height, count);
+
+    if (cached == count)
+    {
+        handler(message(request, std::move(result)));
+        return;
+    }
+
+    // The range is truncated at the top, and the uncached tail is fetched.
+    const auto height = from_height + cached;
+    const auto range = std::make_shared<header_range>(cache, generation,
+        height, count - cached, std::move(result), request, handler);
+
+    for (size_t index = 0; index < count - cached; ++index)
+        node.chain().fetch_block_header(height + index,
+            std::bind(&blockchain::header_ranged,
+                _1, _2, range, index));
+}
+
+void blockchain::header_ranged(const code& ec, header_const_ptr header,
+    header_range::ptr range, size_t index)
+{
+    range->set(index, ec, header);
+}
+
 void blockchain::fetch_block_header_by_hash(server_node& node,
     const message& request, send_handler handler)
 {
@@ -423,10 +891,28 @@ void blockchain::fetch_block_header_by_hash(server_node& node,
 
     auto deserial = make_safe_deserializer(data.begin(), data.end());
     const auto block_hash = deserial.read_hash();
+    data_chunk tip;
+
+    // The tip header is answered from its snapshot, without a chain read.
+    if (node.tip().find(tip, block_hash))
+    {
+        handler(message(request, std::move(tip)));
+        return;
+    }
+
+    auto& cache = node.responses();
+    const auto generation = cache.generation();
+
+    if (cache.respond(request, false, handler))
+        return;
+
+    // Identical queries in flight share one lookup and its response.
+    if (node.coalescer().join(handler, request))
+        return;
 
     node.chain().fetch_block_header(block_hash,
         std::bind(&blockchain::block_header_fetched,
-            _1, _2, request, handler));
+            _1, _2, request, handler, std::ref(cache), generation));
 }
 
 void blockchain::fetch_block_header_by_height(server_node& node,
@@ -437,14 +923,33 @@ void blockchain::fetch_block_header_by_height(server_node& node,
 
     auto deserial = make_safe_deserializer(data.begin(), data.end());
     const uint64_t height = deserial.read_4_bytes_little_endian();
+    data_chunk tip;
+
+    // The tip header is answered from its snapshot, without a chain read.
+    if (node.tip().find(tip, height))
+    {
+        handler(message(request, std::move(tip)));
+        return;
+    }
+
+    auto& cache = node.responses();
+    const auto generation = cache.generation();
+
+    if (cache.respond(request, false, handler))
+        return;
+
+    // Identical queries in flight share one lookup and its response.
+    if (node.coalescer().join(handler, request))
+        return;
 
     node.chain().fetch_block_header(height,
         std::bind(&blockchain::block_header_fetched,
-            _1, _2, request, handler));
+            _1, _2, request, handler, std::ref(cache), generation));
 }
 
 void blockchain::block_fetched(const code& ec, block_const_ptr block,
-    const message& request, send_handler handler)
+    const message& request, send_handler handler, response_cache& cache,
+    bool witness, size_t generation)
 {
     if (ec)
     {
@@ -454,17 +959,52 @@ void blockchain::block_fetched(const code& ec, block_const_ptr block,
 
     // [ code:4 ]
     // [ block... ]
-    auto result = build_chunk(
-    {
-        message::to_bytes(error::success),
-        block->to_data(canonical),
-    });
+    auto result = message::to_bytes(*block, canonical);
 
+    cache.store(request, witness, generation, result);
     handler(message(request, std::move(result)));
 }
 
+void blockchain::block_chunked(const code& ec, block_const_ptr block,
+    size_t chunk_size, const message& request, send_handler handler)
+{
+    static constexpr size_t header_size = code_size + 2 * sizeof(uint32_t);
+
+    if (ec)
+    {
+        handler(message(request, ec));
+        return;
+    }
+
+    const auto data = block->to_data(canonical);
+    const auto total = data.size();
+    size_t offset = 0;
+
+    do
+    {
+        const auto size = chunk_size == 0 ? total :
+            std::min(chunk_size, total - offset);
+        const auto begin = data.begin() + offset;
+
+        // [ code:4 ]
+        // [ offset:4 ]
+        // [ total:4 ] (of the block, complete at offset + chunk = total)
+        // [ chunk... ]
+        data_chunk result(header_size + size);
+        auto serial = make_unsafe_serializer(result.begin());
+        serial.write_error_code(error::success);
+        serial.write_4_bytes_little_endian(static_cast<uint32_t>(offset));
+        serial.write_4_bytes_little_endian(static_cast<uint32_t>(total));
+        std::copy(begin, begin + size, result.begin() + header_size);
+
+        handler(message(request, std::move(result)));
+        offset += size;
+    } while (offset < total);
+}
+
 void blockchain::block_header_fetched(const code& ec, header_const_ptr header,
-    const message& request, send_handler handler)
+    const message& request, send_handler handler, response_cache& cache,
+    size_t generation)
 {
     if (ec)
     {
@@ -474,12 +1014,9 @@ void blockchain::block_header_fetched(const code& ec, header_const_ptr header,
 
     // [ code:4 ]
     // [ block... ]
-    auto result = build_chunk(
-    {
-        message::to_bytes(error::success),
-        header->to_data(canonical)
-    });
+    auto result = message::to_bytes(*header, canonical);
 
+    cache.store(request, false, generation, result);
     handler(message(request, std::move(result)));
 }
 
@@ -603,6 +1140,47 @@ void blockchain::fetch_spend(server_node& node, const message& request,
             _1, _2, request, handler));
 }
 
+// Lookups are issued in request order on this thread, as the spend lookup is
+// synchronous, and each sets its result at its position in the request.
+void blockchain::fetch_spends(server_node& node, const message& request,
+    send_handler handler)
+{
+    const auto& data = request.data();
+    const auto count = data.size() / point_size;
+
+    if (count == 0 || count > batch_limit || data.size() % point_size != 0)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    // [[ hash:32 ][ index:4 ]...]
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    const auto batch = std::make_shared<batch_response>(count, request,
+        handler);
+
+    for (size_t index = 0; index < count; ++index)
+    {
+        output_point outpoint;
+
+        // Failure to parse will result in a not found output.
+        /* bool */ outpoint.from_data(deserial);
+
+        node.chain().fetch_spend(outpoint,
+            std::bind(&blockchain::spend_batched,
+                _1, _2, batch, index));
+    }
+}
+
+void blockchain::spend_batched(const code& ec, const input_point& inpoint,
+    batch_response::ptr batch, size_t index)
+{
+    if (ec)
+        batch->set(index, ec, {});
+    else
+        batch->set(index, error::success, inpoint.to_data());
+}
+
 void blockchain::spend_fetched(const code& ec, const input_point& inpoint,
     const message& request, send_handler handler)
 {
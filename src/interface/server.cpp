@@ -44,5 +44,19 @@ void server::version(server_node&, const message& request,
     handler(message(request, std::move(result)));
 }
 
+void server::stats(server_node& node, const message& request,
+    send_handler handler)
+{
+    // [ code:4 ]
+    // [ report... ]
+    auto result = build_chunk(
+    {
+        message::to_bytes(error::success),
+        to_chunk(node.metrics().report())
+    });
+
+    handler(message(request, std::move(result)));
+}
+
 } // namespace server
 } // namespace libbitcoin
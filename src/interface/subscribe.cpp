@@ -49,7 +49,52 @@ void subscribe::key(server_node& node, const message& request,
     auto deserial = make_safe_deserializer(data.begin(), data.end());
     auto key = deserial.read_hash();
 
-    auto ec = node.subscribe_key(request, std::move(key), false);
+    auto ec = node.subscribe_key(request, std::move(key), false, false,
+        false);
+    handler(message(request, ec));
+}
+
+void subscribe::key2(server_node& node, const message& request,
+    send_handler handler)
+{
+    static constexpr size_t args_size = hash_size;
+
+    const auto& data = request.data();
+
+    if (data.size() != args_size)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    // [ key:32 ]
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    auto key = deserial.read_hash();
+
+    auto ec = node.subscribe_key(request, std::move(key), false, true,
+        false);
+    handler(message(request, ec));
+}
+
+void subscribe::key_transactions(server_node& node, const message& request,
+    send_handler handler)
+{
+    static constexpr size_t args_size = hash_size;
+
+    const auto& data = request.data();
+
+    if (data.size() != args_size)
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    // [ key:32 ]
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    auto key = deserial.read_hash();
+
+    auto ec = node.subscribe_key(request, std::move(key), false, false,
+        true);
     handler(message(request, ec));
 }
 
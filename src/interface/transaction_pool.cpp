@@ -88,38 +88,62 @@ void transaction_pool::transaction_fetched(const code& ec,
 
     // [ code:4 ]
     // [ tx:... ]
-    auto result = build_chunk(
+    auto result = message::to_bytes(*tx, canonical);
+
+    handler(message(request, std::move(result)));
+}
+
+// This does not scan the pool, and is empty if the index is disabled.
+void transaction_pool::fetch_history(server_node& node,
+    const message& request, send_handler handler)
+{
+    const auto& data = request.data();
+
+    if (data.size() != hash_size)
     {
-        message::to_bytes(error::success),
-        tx->to_data(canonical)
-    });
+        handler(message(request, error::bad_stream));
+        return;
+    }
+
+    // [ key:32 ] (reversed, as blockchain.fetch_history4)
+    auto deserial = make_safe_deserializer(data.begin(), data.end());
+    const auto key = deserial.read_reverse<hash_digest>();
+
+    hash_list hashes;
+    node.unconfirmed().read(hashes, key);
+
+    // [ code:4 ]
+    // [[ hash:32 ]...]
+    data_chunk result(sizeof(uint32_t) + hash_size * hashes.size());
+    auto serial = make_unsafe_serializer(result.begin());
+    serial.write_error_code(error::success);
+
+    for (const auto& hash: hashes)
+        serial.write_hash(hash);
 
     handler(message(request, std::move(result)));
 }
 
 // Save to tx pool and announce to all connected peers.
 // FUTURE: conditionally subscribe to penetration notifications.
-void transaction_pool::broadcast(server_node& /* node */, const message& request,
+// Submissions are deduplicated by hash and answered when organized, so this
+// worker does not wait on organization.
+void transaction_pool::broadcast(server_node& node, const message& request,
     send_handler handler)
 {
-    // TODO: re-implement.
-    handler(message(request, error::not_implemented));
+    const auto tx = std::make_shared<system::message::transaction>();
 
-    ////const auto tx = std::make_shared<bc::message::transaction>();
-
-    ////if (!tx->from_data(canonical, request.data()))
-    ////{
-    ////    handler(message(request, error::bad_stream));
-    ////    return;
-    ////}
+    if (!tx->from_data(canonical, request.data()))
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
 
-    ////// Organize into our chain.
-    ////tx->metadata.simulate = false;
+    const auto ec = node.broadcasts().submit(tx,
+        std::bind(handle_broadcast, _1, request, handler));
 
-    ////// This call is async but blocks on other organizations until started.
-    ////// Subscribed channels will pick up and announce via tx inventory to peers.
-    ////node.chain().organize(tx,
-    ////    std::bind(handle_broadcast, _1, request, handler));
+    if (ec)
+        handler(message(request, ec));
 }
 
 void transaction_pool::handle_broadcast(const code& ec, const message& request,
@@ -129,26 +153,23 @@ void transaction_pool::handle_broadcast(const code& ec, const message& request,
     handler(message(request, ec));
 }
 
-void transaction_pool::validate2(server_node& /* node */, const message& request,
+// Validations are deduplicated apart from broadcasts, as they only simulate.
+void transaction_pool::validate2(server_node& node, const message& request,
     send_handler handler)
 {
-    // TODO: re-implement.
-    handler(message(request, error::not_implemented));
-
-    ////const auto tx = std::make_shared<bc::message::transaction>();
+    const auto tx = std::make_shared<system::message::transaction>();
 
-    ////if (!tx->from_data(canonical, request.data()))
-    ////{
-    ////    handler(message(request, error::bad_stream));
-    ////    return;
-    ////}
+    if (!tx->from_data(canonical, request.data()))
+    {
+        handler(message(request, error::bad_stream));
+        return;
+    }
 
-    ////// Simulate organization into our chain.
-    ////tx->metadata.simulate = true;
+    const auto ec = node.validations().submit(tx,
+        std::bind(handle_validated2, _1, request, handler));
 
-    ////// This call is async but blocks on other organizations until started.
-    ////node.chain().organize(tx,
-    ////    std::bind(handle_validated2, _1, request, handler));
+    if (ec)
+        handler(message(request, ec));
 }
 
 void transaction_pool::handle_validated2(const code& ec,
@@ -48,7 +48,8 @@ void unsubscribe::key(server_node& node, const message& request,
     auto deserial = make_safe_deserializer(data.begin(), data.end());
     auto key = deserial.read_hash();
 
-    auto ec = node.subscribe_key(request, std::move(key), true);
+    auto ec = node.subscribe_key(request, std::move(key), true, false,
+        false);
     handler(message(request, ec));
 }
 
@@ -18,7 +18,9 @@
  */
 #include <bitcoin/server/messages/message.hpp>
 
+#include <chrono>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <utility>
 #include <bitcoin/protocol.hpp>
@@ -55,10 +57,16 @@ data_chunk message::to_bytes(const code& ec)
 
 // Incoming messages pass their route security.
 message::message(bool secure)
-  : id_(0), secure_(secure)
+  : message(secure, 0)
 {
 }
 
+message::message(bool secure, uint16_t instance)
+  : id_(0), compressed_(false), secure_(secure)
+{
+    route_.set_instance(instance);
+}
+
 message::message(const message& request, const code& ec)
   : message(request, to_bytes(ec))
 {
@@ -69,6 +77,11 @@ message::message(const message& request, data_chunk&& data)
     id_(request.id_),
     data_(std::move(data)),
     route_(request.route_),
+    received_(request.received_),
+    created_(request.trace_ ? std::chrono::steady_clock::now() :
+        request.received_),
+    trace_(request.trace_),
+    compressed_(false),
     secure_(false)
 {
 }
@@ -85,6 +98,7 @@ message::message(const subscription& route, const std::string& command,
     id_(route.id()),
     data_(std::move(data)),
     route_(route),
+    compressed_(false),
     secure_(false)
 {
 }
@@ -117,6 +131,54 @@ bool message::secure() const
     return secure_;
 }
 
+std::chrono::steady_clock::time_point message::received() const
+{
+    return received_;
+}
+
+bool message::compressed() const
+{
+    return compressed_;
+}
+
+void message::set_compressed()
+{
+    compressed_ = true;
+}
+
+// Tracing.
+//-----------------------------------------------------------------------------
+// The clock is read for sampled queries only, so that tracing is free when
+// not sampled. The execution time is written before the handler is invoked,
+// and so is read only after any of the responses that it produces.
+
+void message::sample()
+{
+    trace_ = std::make_shared<trace>();
+    trace_->executed = received_;
+}
+
+bool message::traced() const
+{
+    return !!trace_;
+}
+
+void message::executing() const
+{
+    if (trace_)
+        trace_->executed = std::chrono::steady_clock::now();
+}
+
+message::time_point message::executed() const
+{
+    return trace_ ? trace_->executed : received_;
+}
+
+message::time_point message::created() const
+{
+    return trace_ ? created_ : received_;
+}
+
 // Transport.
 //-------------------------------------------------------------------------
 
@@ -128,6 +190,59 @@ code message::receive(zmq::socket& socket)
     if (ec)
         return ec;
 
+    received_ = std::chrono::steady_clock::now();
+    return decode(message);
+}
+
+code message::send(zmq::socket& socket) const
+{
+    zmq::message message;
+    enqueue_header(message);
+    message.enqueue(data_);
+    return socket.send(message);
+}
+
+// Large responses (blocks, history) are not copied into the outgoing frames.
+code message::transfer(zmq::socket& socket)
+{
+    zmq::message message;
+    enqueue_header(message);
+    message.enqueue(std::move(data_));
+    data_.clear();
+    return socket.send(message);
+}
+
+// Notifications are preceded by the query service instance of the client.
+code message::receive_notification(zmq::socket& socket)
+{
+    zmq::message message;
+    const auto ec = socket.receive(message);
+
+    if (ec)
+        return ec;
+
+    uint16_t instance;
+
+    if (!message.dequeue(instance))
+        return error::bad_stream;
+
+    route_.set_instance(instance);
+    received_ = std::chrono::steady_clock::now();
+    return decode(message);
+}
+
+code message::notify(zmq::socket& socket)
+{
+    zmq::message message;
+    message.enqueue_little_endian(route_.instance());
+    enqueue_header(message);
+    message.enqueue(std::move(data_));
+    data_.clear();
+    return socket.send(message);
+}
+
+code message::decode(zmq::message& message)
+{
     if (message.size() < 4 || message.size() > 5)
         return error::bad_stream;
 
@@ -162,16 +277,14 @@ code message::receive(zmq::socket& socket)
     if (!message.dequeue(id_))
         return error::bad_stream;
 
-    // Serialized query.
+    // Serialized query (moved from the frame queue).
     data_ = message.dequeue_data();
 
     return error::success;
 }
 
-code message::send(zmq::socket& socket) const
+void message::enqueue_header(zmq::message& message) const
 {
-    zmq::message message;
-
     // Encode the routing information.
     //-------------------------------------------------------------------------
 
@@ -187,9 +300,6 @@ code message::send(zmq::socket& socket) const
     //-------------------------------------------------------------------------
     message.enqueue(command_);
     message.enqueue_little_endian(id_);
-    message.enqueue(data_);
-
-    return socket.send(message);
 }
 
 } // namespace server
@@ -18,6 +18,7 @@
  */
 #include <bitcoin/server/messages/route.hpp>
 
+#include <cstdint>
 #include <string>
 #include <bitcoin/protocol.hpp>
 
@@ -34,6 +35,7 @@ static const zmq::message::address default_address
 
 route::route()
   : delimited_(false),
+    instance_(0),
     address_(default_address)
 {
 }
@@ -43,7 +45,7 @@ bool route::delimited() const
     return delimited_;
 }
 
-zmq::message::address route::address() const
+const zmq::message::address& route::address() const
 {
     return address_;
 }
@@ -58,6 +60,16 @@ void route::set_address(const zmq::message::address& value)
     address_ = value;
 }
 
+uint16_t route::instance() const
+{
+    return instance_;
+}
+
+void route::set_instance(uint16_t value)
+{
+    instance_ = value;
+}
+
 std::string route::display() const
 {
     return "[" + encode_base16(address_) + "]" + (delimited_ ? "[]" : "");
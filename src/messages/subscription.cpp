@@ -18,6 +18,7 @@
  */
 #include <bitcoin/server/messages/subscription.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <bitcoin/system.hpp>
@@ -26,17 +27,43 @@
 namespace libbitcoin {
 namespace server {
 
+subscription::list::iterator subscription::find(list& subscriptions,
+    const route& route)
+{
+    return std::find_if(subscriptions.begin(), subscriptions.end(),
+        [&route](const ptr& item)
+        {
+            return *item == route;
+        });
+}
+
 subscription::subscription(const subscription& other)
   : route(other),
     id_(other.id_),
+    batched_(other.batched_),
+    transactions_(other.transactions_),
     updated_(other.updated_.load()),
     sequence_(other.sequence_.load())
 {
 }
 
 subscription::subscription(const route& return_route, uint32_t id, time_t now)
+  : subscription(return_route, id, now, false)
+{
+}
+
+subscription::subscription(const route& return_route, uint32_t id, time_t now,
+    bool batched)
+  : subscription(return_route, id, now, batched, false)
+{
+}
+
+subscription::subscription(const route& return_route, uint32_t id, time_t now,
+    bool batched, bool transactions)
   : route(return_route),
     id_(id),
+    batched_(batched),
+    transactions_(transactions),
     updated_(now),
     sequence_(0)
 {
@@ -47,6 +74,16 @@ uint32_t subscription::id() const
     return id_;
 }
 
+bool subscription::batched() const
+{
+    return batched_;
+}
+
+bool subscription::transactions() const
+{
+    return transactions_;
+}
+
 time_t subscription::updated() const
 {
     return updated_;
@@ -57,9 +94,9 @@ void subscription::set_updated(time_t now) const
     updated_ = now;
 }
 
-void subscription::increment() const
+uint16_t subscription::increment() const
 {
-    ++sequence_;
+    return ++sequence_;
 }
 
 uint16_t subscription::sequence() const
@@ -82,12 +119,14 @@ bool subscription::operator<(const subscription& other) const
 bool subscription::operator==(const subscription& other) const
 {
     return delimited_ == other.delimited_ &&
+        instance_ == other.instance_ &&
         address_ == other.address_;
 }
 
 bool subscription::operator==(const route& other) const
 {
     return delimited_ == other.delimited() &&
+        instance_ == other.instance() &&
         address_ == other.address();
 }
 
@@ -99,6 +138,8 @@ void swap(subscription& left, subscription& right)
     // Must be unqualified (no std namespace).
     swap(static_cast<route&>(left), static_cast<route&>(right));
     swap(left.id_, right.id_);
+    swap(left.batched_, right.batched_);
+    swap(left.transactions_, right.transactions_);
 
     // Swapping the atomics in assignment operator does not require atomicity.
     left.updated_ = right.updated_.exchange(left.updated_);
@@ -682,36 +682,236 @@ options_metadata parser::load_settings()
         value<uint32_t>(&configured.protocol.handshake_seconds),
         "The time limit to complete the connection handshake, defaults to 30."
     )
+    (
+        "server.query_send_high_water",
+        value<uint32_t>(&configured.server.query_send_high_water),
+        "Drop query service messages at this outgoing backlog level, defaults to 0 (server.send_high_water)."
+    )
+    (
+        "server.query_receive_high_water",
+        value<uint32_t>(&configured.server.query_receive_high_water),
+        "Drop query service messages at this incoming backlog level, defaults to 0 (server.receive_high_water)."
+    )
+    (
+        "server.block_send_high_water",
+        value<uint32_t>(&configured.server.block_send_high_water),
+        "Drop block publishing service messages at this outgoing backlog level, defaults to 0 (server.send_high_water)."
+    )
+    (
+        "server.block_receive_high_water",
+        value<uint32_t>(&configured.server.block_receive_high_water),
+        "Drop block publishing service messages at this incoming backlog level, defaults to 0 (server.receive_high_water)."
+    )
+    (
+        "server.transaction_send_high_water",
+        value<uint32_t>(&configured.server.transaction_send_high_water),
+        "Drop transaction publishing service messages at this outgoing backlog level, defaults to 0 (server.send_high_water)."
+    )
+    (
+        "server.transaction_receive_high_water",
+        value<uint32_t>(&configured.server.transaction_receive_high_water),
+        "Drop transaction publishing service messages at this incoming backlog level, defaults to 0 (server.receive_high_water)."
+    )
     (
         "server.secure_only",
         value<bool>(&configured.server.secure_only),
         "Disable public endpoints, defaults to false."
     )
+    (
+        "server.query_only",
+        value<bool>(&configured.server.query_only),
+        "Serve the existing chain without synchronizing or connecting to peers, defaults to false."
+    )
+    (
+        "server.query_instances",
+        value<uint16_t>(&configured.server.query_instances),
+        "The number of independent query services per endpoint, each with its own workers, instances after the first bound to successive query instances endpoint ports, defaults to 1."
+    )
     (
         "server.query_workers",
         value<uint16_t>(&configured.server.query_workers),
         "The number of query worker threads per endpoint, defaults to 1 (0 disables service)."
     )
+    (
+        "server.query_workers_limit",
+        value<uint16_t>(&configured.server.query_workers_limit),
+        "The maximum number of query worker threads per endpoint, added while queries wait and retired when idle, defaults to 0 (fixed at query_workers)."
+    )
+    (
+        "server.express_query_workers",
+        value<uint16_t>(&configured.server.express_query_workers),
+        "The number of query worker threads per endpoint for constant cost commands, defaults to 1 (0 shares standard workers)."
+    )
+    (
+        "server.query_concurrency",
+        value<uint16_t>(&configured.server.query_concurrency),
+        "The maximum number of queries in flight per query worker, defaults to 16 (0 executes on the worker)."
+    )
+    (
+        "server.query_rate_limit",
+        value<uint32_t>(&configured.server.query_rate_limit),
+        "The maximum queries per second from each client, defaults to 0 (unlimited)."
+    )
+    (
+        "server.query_backlog_limit",
+        value<uint32_t>(&configured.server.query_backlog_limit),
+        "The maximum number of queries awaiting a worker per endpoint, defaults to 1000 (0 unlimited)."
+    )
+    (
+        "server.query_client_backlog_limit",
+        value<uint32_t>(&configured.server.query_client_backlog_limit),
+        "The maximum number of queries awaiting a worker from each client, defaults to 100 (0 unlimited)."
+    )
+    (
+        "server.response_cache_megabytes",
+        value<uint32_t>(&configured.server.response_cache_megabytes),
+        "The size of the block, header and transaction query response cache, defaults to 16 (0 disables)."
+    )
+    (
+        "server.header_cache_enabled",
+        value<bool>(&configured.server.header_cache_enabled),
+        "Enable the in-memory header array for header range queries, defaults to true."
+    )
+    (
+        "server.filter_cache_enabled",
+        value<bool>(&configured.server.filter_cache_enabled),
+        "Enable the in-memory compact filter header array for filter header and checkpoint queries, defaults to true."
+    )
+    (
+        "server.unconfirmed_index_limit",
+        value<uint32_t>(&configured.server.unconfirmed_index_limit),
+        "The maximum number of transactions in the in-memory unconfirmed history index, defaults to 100000 (0 disables)."
+    )
+    (
+        "server.history_cache_megabytes",
+        value<uint32_t>(&configured.server.history_cache_megabytes),
+        "The maximum size of the in-memory payment key history cache, defaults to 16 (0 disables)."
+    )
+    (
+        "server.warm_up_blocks",
+        value<uint32_t>(&configured.server.warm_up_blocks),
+        "The number of most recent blocks read before query services start, defaults to 0 (disabled)."
+    )
+    (
+        "server.warm_up_directory",
+        value<path>(&configured.server.warm_up_directory),
+        "The directory of the hot key snapshot saved on stop and read before query services start, defaults to empty (disabled)."
+    )
+    (
+        "server.query_chunk_kilobytes",
+        value<uint32_t>(&configured.server.query_chunk_kilobytes),
+        "The maximum block data in each chunked block query response, defaults to 256 (0 unbounded)."
+    )
+    (
+        "server.coalescing_enabled",
+        value<bool>(&configured.server.coalescing_enabled),
+        "Share one lookup among identical header and history queries in flight, defaults to true."
+    )
+    (
+        "server.slow_query_milliseconds",
+        value<uint32_t>(&configured.server.slow_query_milliseconds),
+        "Log each query response slower than this to the slow_query log, defaults to 0 (disabled)."
+    )
+    (
+        "server.query_trace_sampling",
+        value<uint32_t>(&configured.server.query_trace_sampling),
+        "Trace the stage times of one of every this many queries, defaults to 0 (disabled)."
+    )
+    (
+        "server.query_capture_file",
+        value<path>(&configured.server.query_capture_file),
+        "The file to which each query is captured for replay by bs-bench, defaults to empty (disabled)."
+    )
+    (
+        "server.submission_limit",
+        value<uint32_t>(&configured.server.submission_limit),
+        "The maximum number of distinct transactions pending broadcast or validation, defaults to 10000 (0 unlimited)."
+    )
     (
         "server.subscription_limit",
         value<uint32_t>(&configured.server.subscription_limit),
         "The maximum number of query subscriptions, defaults to 1000 (0 disables subscribe)."
     )
+    (
+        "server.key_subscription_limit",
+        value<uint32_t>(&configured.server.key_subscription_limit),
+        "The maximum number of payment key subscriptions, defaults to 1000 (0 disables key subscribe)."
+    )
     (
         "server.subscription_expiration_minutes",
         value<uint32_t>(&configured.server.subscription_expiration_minutes),
         "The query subscription expiration time, defaults to 10 (0 disables expiration)."
     )
+    (
+        "server.subscription_directory",
+        value<path>(&configured.server.subscription_directory),
+        "The directory of key subscription snapshots restored on start, defaults to empty (disabled)."
+    )
+    (
+        "server.purge_pause_budget_microseconds",
+        value<uint32_t>(&configured.server.purge_pause_budget_microseconds),
+        "The subscription purge pause above which a warning is logged, defaults to 1000 (0 disables)."
+    )
+    (
+        "server.notification_threads",
+        value<uint16_t>(&configured.server.notification_threads),
+        "The maximum number of partitions of a block matched at once on the node threadpool, defaults to 0 (physical cores)."
+    )
+    (
+        "server.query_service_cores",
+        value<std::string>(&configured.server.query_service_cores),
+        "The cores of the query service threads, such as '0-3,8', defaults to empty (not pinned)."
+    )
+    (
+        "server.query_worker_cores",
+        value<std::string>(&configured.server.query_worker_cores),
+        "The cores of the query worker threads, such as '0-3,8', defaults to empty (not pinned)."
+    )
+    (
+        "server.query_handler_cores",
+        value<std::string>(&configured.server.query_handler_cores),
+        "The cores of the node threadpool threads, which execute query handlers, such as '0-3,8', defaults to empty (not pinned)."
+    )
+    (
+        "server.notification_cores",
+        value<std::string>(&configured.server.notification_cores),
+        "The cores of the notification worker threads, such as '0-3,8', defaults to empty (not pinned)."
+    )
+    (
+        "server.publisher_cores",
+        value<std::string>(&configured.server.publisher_cores),
+        "The cores of the heartbeat, block and transaction service threads, such as '0-3,8', defaults to empty (not pinned)."
+    )
     (
         "server.heartbeat_service_seconds",
         value<uint32_t>(&configured.server.heartbeat_service_seconds),
         "The heartbeat service interval, defaults to 5 (0 disables service)."
     )
+    (
+        "server.heartbeat_status_enabled",
+        value<bool>(&configured.server.heartbeat_status_enabled),
+        "Append a node status frame to each heartbeat, defaults to false."
+    )
     (
         "server.block_service_enabled",
         value<bool>(&configured.server.block_service_enabled),
         "Enable the block publishing service, defaults to false."
     )
+    (
+        "server.compact_block_service_enabled",
+        value<bool>(&configured.server.compact_block_service_enabled),
+        "Enable the compact block publishing service of headers and transaction hashes, defaults to false."
+    )
+    (
+        "server.block_chunk_kilobytes",
+        value<uint32_t>(&configured.server.block_chunk_kilobytes),
+        "Publish each block in messages of this size with a continuation header, defaults to 0 (disabled)."
+    )
+    (
+        "server.block_compression_enabled",
+        value<bool>(&configured.server.block_compression_enabled),
+        "Publish each block lz4 compressed, prefixed by its size, defaults to false."
+    )
     (
         "server.transaction_service_enabled",
         value<bool>(&configured.server.transaction_service_enabled),
@@ -727,6 +927,16 @@ options_metadata parser::load_settings()
         value<config::authority::list>(&configured.server.blacklists),
         "Blocked client IP address, multiple entries allowed."
     )
+    (
+        "server.metrics_endpoint",
+        value<endpoint>(&configured.server.metrics_endpoint),
+        "The plaintext query metrics endpoint, not authenticated, defaults to none (disabled)."
+    )
+    (
+        "server.ipc_directory",
+        value<path>(&configured.server.ipc_directory),
+        "The directory of the public ipc query and publishing endpoints, not authenticated, defaults to empty (disabled)."
+    )
 
     /* [websockets] */
     (
@@ -749,6 +959,16 @@ options_metadata parser::load_settings()
         value<endpoint>(&configured.server.websockets_secure_transaction_endpoint),
         "The secure transaction publishing websocket endpoint, defaults to 'tcp://*:9064'."
     )
+    (
+        "websockets.secure_compact_block_endpoint",
+        value<endpoint>(&configured.server.websockets_secure_compact_block_endpoint),
+        "The secure block publishing websocket endpoint rendering base16 serializations, defaults to none (disabled)."
+    )
+    (
+        "websockets.secure_compact_transaction_endpoint",
+        value<endpoint>(&configured.server.websockets_secure_compact_transaction_endpoint),
+        "The secure transaction publishing websocket endpoint rendering base16 serializations, defaults to none (disabled)."
+    )
     (
         "websockets.public_query_endpoint",
         value<endpoint>(&configured.server.websockets_public_query_endpoint),
@@ -769,6 +989,16 @@ options_metadata parser::load_settings()
         value<endpoint>(&configured.server.websockets_public_transaction_endpoint),
         "The public transaction websocket publishing endpoint, defaults to 'tcp://*:9074'."
     )
+    (
+        "websockets.public_compact_block_endpoint",
+        value<endpoint>(&configured.server.websockets_public_compact_block_endpoint),
+        "The public block publishing websocket endpoint rendering base16 serializations, defaults to none (disabled)."
+    )
+    (
+        "websockets.public_compact_transaction_endpoint",
+        value<endpoint>(&configured.server.websockets_public_compact_transaction_endpoint),
+        "The public transaction publishing websocket endpoint rendering base16 serializations, defaults to none (disabled)."
+    )
     (
         "websockets.enabled",
         value<bool>(&configured.server.websockets_enabled),
@@ -826,6 +1056,16 @@ options_metadata parser::load_settings()
         value<endpoint>(&configured.server.zeromq_secure_transaction_endpoint),
         "The secure transaction publishing zeromq endpoint, defaults to 'tcp://*:9084'."
     )
+    (
+        "zeromq.secure_compact_block_endpoint",
+        value<endpoint>(&configured.server.zeromq_secure_compact_block_endpoint),
+        "The secure compact block publishing zeromq endpoint, defaults to 'tcp://*:9085'."
+    )
+    (
+        "zeromq.secure_query_instances_endpoint",
+        value<endpoint>(&configured.server.zeromq_secure_query_instances_endpoint),
+        "The first secure query zeromq endpoint of instances after the first, defaults to 'tcp://*:9101'."
+    )
     (
         "zeromq.public_query_endpoint",
         value<endpoint>(&configured.server.zeromq_public_query_endpoint),
@@ -846,6 +1086,16 @@ options_metadata parser::load_settings()
         value<endpoint>(&configured.server.zeromq_public_transaction_endpoint),
         "The public transaction publishing zeromq endpoint, defaults to 'tcp://*:9094'."
     )
+    (
+        "zeromq.public_compact_block_endpoint",
+        value<endpoint>(&configured.server.zeromq_public_compact_block_endpoint),
+        "The public compact block publishing zeromq endpoint, defaults to 'tcp://*:9095'."
+    )
+    (
+        "zeromq.public_query_instances_endpoint",
+        value<endpoint>(&configured.server.zeromq_public_query_instances_endpoint),
+        "The first public query zeromq endpoint of instances after the first, defaults to 'tcp://*:9201'."
+    )
     (
         "zeromq.server_private_key",
         value<config::sodium>(&configured.server.zeromq_server_private_key),
@@ -884,6 +1134,10 @@ bool parser::parse(int argc, const char* argv[], std::ostream& error)
         // Clear the config file path if it wasn't used.
         if (!file)
             configured.file.clear();
+
+        // A query only server starts no peer sessions.
+        if (configured.server.query_only)
+            configured.disable_sessions();
     }
     catch (const boost::program_options::error& e)
     {
@@ -18,13 +18,21 @@
  */
 #include <bitcoin/server/server_node.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <cstdio>
 #include <functional>
+#include <future>
 #include <memory>
 #include <utility>
+#include <vector>
 #include <bitcoin/node.hpp>
 #include <bitcoin/server/configuration.hpp>
 #include <bitcoin/server/messages/route.hpp>
+#include <bitcoin/server/utility/thread_affinity.hpp>
 #include <bitcoin/server/workers/query_worker.hpp>
 
 namespace libbitcoin {
@@ -36,16 +44,35 @@ using namespace bc::protocol;
 using namespace bc::system;
 using namespace bc::system::chain;
 
+static const auto tip_refresh_interval = std::chrono::seconds(1);
+
 server_node::server_node(const configuration& configuration)
   : full_node(configuration),
     configuration_(configuration),
     authenticator_(*this),
-    secure_query_service_(authenticator_, *this, true),
-    public_query_service_(authenticator_, *this, false),
+    publisher_(*this),
+    responses_(size_t(configuration.server.response_cache_megabytes) << 20),
+    headers_(configuration.server.header_cache_enabled),
+    filters_(configuration.server.filter_cache_enabled),
+    unconfirmed_(configuration.server.unconfirmed_index_limit),
+    histories_(size_t(configuration.server.history_cache_megabytes) << 20),
+    coalescer_(configuration.server.coalescing_enabled),
+    broadcasts_(std::bind(&server_node::organize_transaction,
+        this, _1, false, _2), configuration.server.submission_limit),
+    validations_(std::bind(&server_node::organize_transaction,
+        this, _1, true, _2), configuration.server.submission_limit),
+    tracer_(configuration.server.query_trace_sampling,
+        configuration.server.slow_query_milliseconds),
+    recorder_(configuration.server.query_capture_file),
+    secure_query_service_(authenticator_, *this, true, 0),
+    public_query_service_(authenticator_, *this, false, 0),
+    metrics_service_(authenticator_, *this),
     secure_heartbeat_service_(authenticator_, *this, true),
     public_heartbeat_service_(authenticator_, *this, false),
-    secure_block_service_(authenticator_, *this, true),
-    public_block_service_(authenticator_, *this, false),
+    secure_block_service_(authenticator_, *this, true, false),
+    public_block_service_(authenticator_, *this, false, false),
+    secure_compact_block_service_(authenticator_, *this, true, true),
+    public_compact_block_service_(authenticator_, *this, false, true),
     secure_transaction_service_(authenticator_, *this, true),
     public_transaction_service_(authenticator_, *this, false),
     secure_notification_worker_(authenticator_, *this, true),
@@ -54,10 +81,15 @@ server_node::server_node(const configuration& configuration)
     public_query_websockets_(authenticator_, *this, false),
     secure_heartbeat_websockets_(authenticator_, *this, true),
     public_heartbeat_websockets_(authenticator_, *this, false),
-    secure_block_websockets_(authenticator_, *this, true),
-    public_block_websockets_(authenticator_, *this, false),
-    secure_transaction_websockets_(authenticator_, *this, true),
-    public_transaction_websockets_(authenticator_, *this, false)
+    secure_block_websockets_(authenticator_, *this, true, false),
+    public_block_websockets_(authenticator_, *this, false, false),
+    secure_compact_block_websockets_(authenticator_, *this, true, true),
+    public_compact_block_websockets_(authenticator_, *this, false, true),
+    secure_transaction_websockets_(authenticator_, *this, true, false),
+    public_transaction_websockets_(authenticator_, *this, false, false),
+    secure_compact_transaction_websockets_(authenticator_, *this, true, true),
+    public_compact_transaction_websockets_(authenticator_, *this, false, true),
+    ready_(false)
 {
 }
 
@@ -96,6 +128,15 @@ void server_node::run(result_handler handler)
         return;
     }
 
+    // A query only server does not run the node sessions, so it does not
+    // synchronize, and serves the chain as it was opened. Its configuration
+    // also disables the sessions started with the node (see parser).
+    if (configuration_.server.query_only)
+    {
+        handle_running(error::success, handler);
+        return;
+    }
+
     // The handler is invoked on a new thread.
     full_node::run(
         std::bind(&server_node::handle_running,
@@ -134,6 +175,15 @@ void server_node::handle_running(const code& , result_handler handler)
 
 bool server_node::stop()
 {
+    // The hot keys are saved only if queries have been serviced.
+    if (ready_.exchange(false))
+        save_hot_keys();
+
+    recorder_.flush();
+
+    // Pending publications are discarded before the services stop.
+    publisher_.stop();
+
     // Suspend new work last so we can use work to clear subscribers.
     return authenticator_.stop() && full_node::stop();
 }
@@ -149,13 +199,13 @@ bool server_node::close()
 // ----------------------------------------------------------------------------
 
 code server_node::subscribe_key(const message& request,
-    hash_digest&& key, bool unsubscribe)
+    hash_digest&& key, bool unsubscribe, bool batched, bool transactions)
 {
     return request.secure() ?
         secure_notification_worker_.subscribe_key(request,
-            std::move(key), unsubscribe) :
+            std::move(key), unsubscribe, batched, transactions) :
         public_notification_worker_.subscribe_key(request,
-            std::move(key), unsubscribe);
+            std::move(key), unsubscribe, batched, transactions);
 }
 
 code server_node::subscribe_stealth(const message& request,
@@ -168,15 +218,419 @@ code server_node::subscribe_stealth(const message& request,
             std::move(prefix_filter), unsubscribe);
 }
 
+size_t server_node::key_subscriptions(bool secure) const
+{
+    return secure ? secure_notification_worker_.key_subscriptions() :
+        public_notification_worker_.key_subscriptions();
+}
+
+size_t server_node::stealth_subscriptions(bool secure) const
+{
+    return secure ? secure_notification_worker_.stealth_subscriptions() :
+        public_notification_worker_.stealth_subscriptions();
+}
+
+// Publication.
+// ----------------------------------------------------------------------------
+
+publisher& server_node::publications()
+{
+    return publisher_;
+}
+
+// Query.
+// ----------------------------------------------------------------------------
+
+// A query only server does not run the node, so its reorganization
+// subscription is not advanced. Its tip is instead reread from the store, at
+// most once per refresh interval. Queries are answered from the prior tip
+// until the reads complete.
+chain_tip& server_node::tip()
+{
+    if (configuration_.server.query_only &&
+        tip_.stale(chain_tip::clock::now(), tip_refresh_interval))
+        refresh_tip();
+
+    return tip_;
+}
+
+response_cache& server_node::responses()
+{
+    return responses_;
+}
+
+header_cache& server_node::headers()
+{
+    return headers_;
+}
+
+filter_cache& server_node::filters()
+{
+    return filters_;
+}
+
+unconfirmed_index& server_node::unconfirmed()
+{
+    return unconfirmed_;
+}
+
+history_cache& server_node::histories()
+{
+    return histories_;
+}
+
+request_coalescer& server_node::coalescer()
+{
+    return coalescer_;
+}
+
+submission_queue& server_node::broadcasts()
+{
+    return broadcasts_;
+}
+
+submission_queue& server_node::validations()
+{
+    return validations_;
+}
+
+query_metrics& server_node::metrics()
+{
+    return metrics_;
+}
+
+query_tracer& server_node::tracer()
+{
+    return tracer_;
+}
+
+query_recorder& server_node::recorder()
+{
+    return recorder_;
+}
+
+void server_node::refresh_tip()
+{
+    chain().fetch_last_height(
+        std::bind(&server_node::handle_top_height,
+            this, _1, _2));
+}
+
+void server_node::handle_top_height(const code& ec, size_t height)
+{
+    if (ec)
+        return;
+
+    chain().fetch_block_header(height,
+        std::bind(&server_node::handle_top_header,
+            this, _1, _2, height));
+}
+
+void server_node::handle_top_header(const code& ec, header_const_ptr header,
+    size_t height)
+{
+    if (ec || !header || header->hash() == tip_.hash())
+        return;
+
+    tip_.set(height, *header);
+}
+
+// Cached responses by height or confirmation are invalid after a reorg.
+bool server_node::handle_reorganization(const code& ec, size_t fork_height,
+    block_const_ptr_list_const_ptr incoming,
+    block_const_ptr_list_const_ptr outgoing)
+{
+    if (ec == error::service_stopped)
+        return false;
+
+    if (ec)
+        return true;
+
+    // A confirmed reorganization always has incoming blocks, the last of
+    // which is the new top.
+    if (incoming && !incoming->empty())
+        tip_.set(fork_height + incoming->size(), incoming->back()->header());
+
+    const auto popped = outgoing && !outgoing->empty();
+
+    if (popped)
+        responses_.clear();
+
+    if (incoming)
+    {
+        headers_.reorganize(fork_height, *incoming, popped);
+        unconfirmed_.confirm(*incoming);
+    }
+
+    filters_.reorganize(fork_height, popped);
+
+    // Only the histories of the keys of changed blocks are dropped.
+    if (configuration_.server.history_cache_megabytes > 0)
+    {
+        if (incoming)
+            drop_histories(*incoming);
+
+        if (outgoing)
+            drop_histories(*outgoing);
+    }
+
+    return true;
+}
+
+// Transactions are indexed by payment key until confirmed (or evicted).
+bool server_node::handle_transaction(const code& ec, transaction_const_ptr tx)
+{
+    if (ec == error::service_stopped)
+        return false;
+
+    if (ec || !tx)
+        return true;
+
+    // The keys are extracted once for both the index and the history cache.
+    auto keys = payment_keys::extract(*tx);
+
+    // The unconfirmed records of the keys of the transaction have changed.
+    if (configuration_.server.history_cache_megabytes > 0)
+        histories_.drop(keys);
+
+    unconfirmed_.add(*tx, std::move(keys));
+    return true;
+}
+
+// The chain does not yet expose transaction organization, so each unique
+// submission is answered as not implemented until it does.
+void server_node::organize_transaction(transaction_const_ptr /* tx */,
+    bool /* simulate */, result_handler handler)
+{
+    // TODO: re-implement.
+    handler(error::not_implemented);
+
+    ////tx->metadata.simulate = simulate;
+
+    ////// This call is async but blocks on other organizations until started.
+    ////// Subscribed channels will pick up and announce via tx inventory to peers.
+    ////chain().organize(tx, handler);
+}
+
+void server_node::drop_histories(const block_const_ptr_list& blocks)
+{
+    for (const auto block: blocks)
+        for (const auto& tx: block->transactions())
+            histories_.drop(payment_keys::extract(tx));
+}
+
+// Warm-up.
+// Recent blocks and the hot keys of the prior run are read before the query
+// services start, so that the first queries do not read cold store pages.
+// The hot key histories are also stored to the history cache.
+// ----------------------------------------------------------------------------
+
+// The reads of each batch are issued before any is awaited.
+static constexpr size_t warm_batch = 64;
+
+// Each read completes once with its handler, in any order and on any thread.
+void server_node::warm(size_t count, warm_reader read)
+{
+    for (size_t first = 0; first < count && !stopped(); first += warm_batch)
+    {
+        const auto size = std::min(warm_batch, count - first);
+        const auto remaining = std::make_shared<std::atomic<size_t>>(size);
+        const auto done = std::make_shared<std::promise<void>>();
+        auto batch = done->get_future();
+
+        const auto complete = [remaining, done]()
+        {
+            if (--(*remaining) == 0)
+                done->set_value();
+        };
+
+        for (auto index = first; index < first + size; ++index)
+            read(index, complete);
+
+        batch.wait();
+    }
+}
+
+void server_node::warm_up()
+{
+    const auto& settings = configuration_.server;
+
+    if (settings.warm_up_blocks == 0 && settings.warm_up_directory.empty())
+        return;
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto blocks = warm_blocks();
+    const auto keys = warm_keys();
+    const auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now() - start);
+
+    LOG_INFO(LOG_SERVER)
+        << "Warmed (" << blocks << ") blocks and (" << keys
+        << ") hot keys in " << elapsed.count() << " seconds.";
+}
+
+// The blocks are read from the top down, reading each header and transaction.
+size_t server_node::warm_blocks()
+{
+    const auto top = tip_.height();
+    const auto count = std::min(size_t(configuration_.server.warm_up_blocks),
+        top + 1);
+
+    warm(count, [this, top](size_t index, warm_handler complete)
+    {
+        chain().fetch_block(top - index, true,
+            [complete](const code&, block_const_ptr)
+            {
+                complete();
+            });
+    });
+
+    return count;
+}
+
+size_t server_node::warm_keys()
+{
+    if (configuration_.server.warm_up_directory.empty())
+        return 0;
+
+    bc::system::ifstream stream(hot_keys_file().string(), std::ios::binary);
+
+    if (!stream.good())
+        return 0;
+
+    hash_list keys;
+    istream_reader source(stream);
+
+    while (true)
+    {
+        const auto key = source.read_hash();
+
+        if (!source)
+            break;
+
+        keys.push_back(key);
+    }
+
+    const auto sequence = histories_.sequence();
+
+    warm(keys.size(), [this, &keys, sequence](size_t index,
+        warm_handler complete)
+    {
+        const auto& key = keys[index];
+        chain().fetch_history(key, 0, 0,
+            [this, key, sequence, complete](const code& ec,
+                const payment_record::list& records)
+            {
+                if (!ec)
+                    histories_.store(key, sequence, records);
+
+                complete();
+            });
+    });
+
+    return keys.size();
+}
+
+// The hot keys are those of the history cache, most recently used first.
+void server_node::save_hot_keys() const
+{
+    if (configuration_.server.warm_up_directory.empty() ||
+        !histories_.enabled())
+        return;
+
+    const auto file = hot_keys_file();
+    const auto temporary = file.string() + ".tmp";
+
+    {
+        bc::system::ofstream stream(temporary, std::ios::binary);
+        ostream_writer sink(stream);
+
+        for (const auto& key: histories_.keys())
+            sink.write_hash(key);
+
+        stream.flush();
+
+        if (!stream.good())
+        {
+            LOG_WARNING(LOG_SERVER)
+                << "Failed to save hot keys to " << temporary;
+            return;
+        }
+    }
+
+    if (std::rename(temporary.c_str(), file.string().c_str()) != 0)
+        LOG_WARNING(LOG_SERVER)
+            << "Failed to replace hot keys at " << file.string();
+}
+
+boost::filesystem::path server_node::hot_keys_file() const
+{
+    return configuration_.server.warm_up_directory / "hot_keys.dat";
+}
+
 // Services.
 // ----------------------------------------------------------------------------
 
 bool server_node::start_services()
 {
-    return
-        start_authenticator() && start_query_services() &&
-        start_heartbeat_services() && start_block_services() &&
-        start_transaction_services();
+    // The tip is set from the top block before any query is serviced, and
+    // its header is retained from the first reorganization.
+    const auto top = top_block();
+    tip_.set(top.height(), top.hash());
+
+    // The tip is set to the last incoming block of each reorg.
+    // Only successful responses are cached, so new blocks do not invalidate.
+    // The header array is extended by new blocks and truncated by reorgs.
+    // The filter header array is truncated by reorgs.
+    // The unconfirmed index is pruned of the transactions of new blocks.
+    // The history cache drops the keys of block and pool transactions.
+    subscribe_blocks(
+        std::bind(&server_node::handle_reorganization,
+            this, _1, _2, _3, _4));
+
+    if (configuration_.server.unconfirmed_index_limit > 0 ||
+        configuration_.server.history_cache_megabytes > 0)
+        subscribe_transactions(
+            std::bind(&server_node::handle_transaction,
+                this, _1, _2));
+
+    // The node threadpool executes query handlers (and reads warm pages).
+    thread_affinity::pin(thread_pool(),
+        configuration_.server.query_handler_cores, "query handler");
+
+    // Store pages are read before the query services start.
+    warm_up();
+
+    // The zeromq query path is started first, so that it is serviceable
+    // while the remaining services start.
+    if (!start_authenticator() || !start_query_services())
+        return false;
+
+    ready_ = true;
+    LOG_INFO(LOG_SERVER) << "Query services are ready.";
+
+    // Each remaining service binds its own endpoint and blocks on its own
+    // start, so these start concurrently.
+    auto websockets = std::async(std::launch::async,
+        &server_node::start_query_websockets, this);
+    auto heartbeats = std::async(std::launch::async,
+        &server_node::start_heartbeat_services, this);
+    auto blocks = std::async(std::launch::async,
+        &server_node::start_block_services, this);
+    auto transactions = std::async(std::launch::async,
+        &server_node::start_transaction_services, this);
+    auto metrics = std::async(std::launch::async,
+        &server_node::start_metrics_service, this);
+
+    // Each start must complete before any failure is returned.
+    const auto websockets_started = websockets.get();
+    const auto heartbeats_started = heartbeats.get();
+    const auto blocks_started = blocks.get();
+    const auto transactions_started = transactions.get();
+    const auto metrics_started = metrics.get();
+
+    return websockets_started && heartbeats_started && blocks_started &&
+        transactions_started && metrics_started;
 }
 
 bool server_node::start_authenticator()
@@ -188,7 +642,9 @@ bool server_node::start_authenticator()
         ((settings.query_workers == 0) &&
         (settings.heartbeat_service_seconds == 0) &&
         (!settings.block_service_enabled) &&
-        (!settings.transaction_service_enabled)))
+        (!settings.compact_block_service_enabled) &&
+        (!settings.transaction_service_enabled) &&
+        (!settings.metrics_endpoint)))
         return true;
 
     return authenticator_.start();
@@ -204,27 +660,40 @@ bool server_node::start_query_services()
 
     // Start secure service, query workers and notification workers if enabled.
     if (settings.zeromq_server_private_key &&
-        (!secure_query_service_.start() || !start_query_workers(true) ||
-        (settings.subscription_limit > 0 && !start_notification_workers(true))))
+        (!secure_query_service_.start() ||
+        !start_query_workers(secure_query_service_, true, 0) ||
+        (settings.subscription_limit > 0 &&
+            !start_notification_workers(true)) ||
+        !start_query_instances(true)))
             return false;
 
     // Start public service, query workers and notification workers if enabled.
     if (!settings.secure_only &&
-        (!public_query_service_.start() || !start_query_workers(false) ||
-        (settings.subscription_limit > 0 && !start_notification_workers(false))))
+        (!public_query_service_.start() ||
+        !start_query_workers(public_query_service_, false, 0) ||
+        (settings.subscription_limit > 0 &&
+            !start_notification_workers(false)) ||
+        !start_query_instances(false)))
             return false;
 
-    if (settings.websockets_enabled)
-    {
-        // Start secure service if enabled.
-        if (settings.zeromq_server_private_key &&
-            !secure_query_websockets_.start())
-            return false;
+    return true;
+}
 
-        // Start public service if enabled.
-        if (!settings.secure_only && !public_query_websockets_.start())
-            return false;
-    }
+bool server_node::start_query_websockets()
+{
+    const auto& settings = configuration_.server;
+
+    if (settings.query_workers == 0 || !settings.websockets_enabled)
+        return true;
+
+    // Start secure service if enabled.
+    if (settings.zeromq_server_private_key &&
+        !secure_query_websockets_.start())
+        return false;
+
+    // Start public service if enabled.
+    if (!settings.secure_only && !public_query_websockets_.start())
+        return false;
 
     return true;
 }
@@ -264,6 +733,18 @@ bool server_node::start_block_services()
 {
     const auto& settings = configuration_.server;
 
+    if (settings.compact_block_service_enabled)
+    {
+        // Start secure service if enabled.
+        if (settings.zeromq_server_private_key &&
+            !secure_compact_block_service_.start())
+            return false;
+
+        // Start public service if enabled.
+        if (!settings.secure_only && !public_compact_block_service_.start())
+            return false;
+    }
+
     if (!settings.block_service_enabled)
         return true;
 
@@ -285,6 +766,17 @@ bool server_node::start_block_services()
         // Start public service if enabled.
         if (!settings.secure_only && !public_block_websockets_.start())
             return false;
+
+        // Start compact services if configured.
+        if (settings.zeromq_server_private_key &&
+            settings.websockets_secure_compact_block_endpoint &&
+            !secure_compact_block_websockets_.start())
+            return false;
+
+        if (!settings.secure_only &&
+            settings.websockets_public_compact_block_endpoint &&
+            !public_compact_block_websockets_.start())
+            return false;
     }
 
     return true;
@@ -316,30 +808,180 @@ bool server_node::start_transaction_services()
         // Start public service if enabled.
         if (!settings.secure_only && !public_transaction_websockets_.start())
             return false;
+
+        // Start compact services if configured.
+        if (settings.zeromq_server_private_key &&
+            settings.websockets_secure_compact_transaction_endpoint &&
+            !secure_compact_transaction_websockets_.start())
+            return false;
+
+        if (!settings.secure_only &&
+            settings.websockets_public_compact_transaction_endpoint &&
+            !public_compact_transaction_websockets_.start())
+            return false;
     }
 
     return true;
 }
 
+bool server_node::start_metrics_service()
+{
+    if (!configuration_.server.metrics_endpoint)
+        return true;
+
+    return metrics_service_.start();
+}
+
 // Called from start_query_services.
-bool server_node::start_query_workers(bool secure)
+bool server_node::start_query_instances(bool secure)
 {
     auto& server = *this;
     const auto& settings = configuration_.server;
 
-    for (auto count = 0; count < settings.query_workers; ++count)
+    if (!validate_query_instances(secure))
+        return false;
+
+    // The first instance is a member, as it also serves subscriptions.
+    for (uint16_t instance = 1; instance < settings.query_instances;
+        ++instance)
     {
-        const auto worker = std::make_shared<query_worker>(authenticator_,
-            server, secure);
+        const auto service = std::make_shared<query_service>(authenticator_,
+            server, secure, instance);
+
+        if (!service->start() ||
+            !start_query_workers(*service, secure, instance))
+            return false;
+
+        // Services register with stop handler just to keep them in scope.
+        subscribe_stop([=](const code&) { service->stop(); });
+    }
+
+    return true;
+}
+
+// Called from start_query_instances.
+// Instance ports follow the instances endpoint, and must not collide with
+// those of any other service, or of the instances of the other security.
+bool server_node::validate_query_instances(bool secure) const
+{
+    const auto& settings = configuration_.server;
+    const auto security = secure ? "secure" : "public";
+
+    if (settings.query_instances < 2)
+        return true;
+
+    const auto last = static_cast<uint16_t>(settings.query_instances - 1);
+    const auto first = settings.zeromq_query_endpoint(secure, 1).port();
+    const auto other = settings.zeromq_query_endpoint(!secure, 1).port();
+
+    if (first == 0 || size_t(first) + last - 1 > max_uint16)
+    {
+        LOG_ERROR(LOG_SERVER)
+            << "The " << security << " query instances endpoint port range "
+            << "is invalid for " << settings.query_instances << " instances.";
+        return false;
+    }
+
+    const std::vector<config::endpoint> services
+    {
+        settings.zeromq_secure_query_endpoint,
+        settings.zeromq_secure_heartbeat_endpoint,
+        settings.zeromq_secure_block_endpoint,
+        settings.zeromq_secure_transaction_endpoint,
+        settings.zeromq_secure_compact_block_endpoint,
+        settings.zeromq_public_query_endpoint,
+        settings.zeromq_public_heartbeat_endpoint,
+        settings.zeromq_public_block_endpoint,
+        settings.zeromq_public_transaction_endpoint,
+        settings.zeromq_public_compact_block_endpoint,
+        settings.websockets_secure_query_endpoint,
+        settings.websockets_secure_heartbeat_endpoint,
+        settings.websockets_secure_block_endpoint,
+        settings.websockets_secure_transaction_endpoint,
+        settings.websockets_secure_compact_block_endpoint,
+        settings.websockets_secure_compact_transaction_endpoint,
+        settings.websockets_public_query_endpoint,
+        settings.websockets_public_heartbeat_endpoint,
+        settings.websockets_public_block_endpoint,
+        settings.websockets_public_transaction_endpoint,
+        settings.websockets_public_compact_block_endpoint,
+        settings.websockets_public_compact_transaction_endpoint,
+        settings.metrics_endpoint
+    };
+
+    const auto collides = [=](uint16_t port)
+    {
+        return port >= first && size_t(port) < size_t(first) + last;
+    };
 
-        if (!worker->start())
+    for (const auto& service: services)
+    {
+        if (collides(service.port()))
+        {
+            LOG_ERROR(LOG_SERVER)
+                << "The " << security << " query instance port "
+                << service.port() << " collides with endpoint " << service
+                << ", configure zeromq." << security
+                << "_query_instances_endpoint.";
             return false;
+        }
+    }
+
+    // Each security starts its instances, so either detects the overlap.
+    if (other != 0 && other < size_t(first) + last &&
+        size_t(other) + last > first)
+    {
+        LOG_ERROR(LOG_SERVER)
+            << "The secure and public query instance port ranges overlap.";
+        return false;
+    }
+
+    return true;
+}
+
+// Called from start_query_services and start_query_instances.
+bool server_node::start_query_workers(query_service& service, bool secure,
+    uint16_t instance)
+{
+    auto& server = *this;
+    const auto& settings = configuration_.server;
+
+    const auto workers = settings.query_workers +
+        settings.express_query_workers;
+
+    std::vector<std::shared_ptr<query_worker>> started;
+    std::vector<std::future<bool>> starts;
+
+    // Express lane workers follow the standard lane workers.
+    // Each worker only connects to its service, so workers start concurrently.
+    for (auto count = 0; count < workers; ++count)
+    {
+        const auto express = count >= settings.query_workers;
+        const auto endpoint = express ?
+            query_service::express_endpoint(secure, instance) :
+            query_service::worker_endpoint(secure, instance);
+        const auto worker = std::make_shared<query_worker>(authenticator_,
+            server, service.capacity(express), endpoint, secure, instance);
+
+        started.push_back(worker);
+        starts.push_back(std::async(std::launch::async,
+            [worker]() { return worker->start(); }));
+    }
+
+    auto success = true;
+
+    for (size_t index = 0; index < started.size(); ++index)
+    {
+        const auto worker = started[index];
+
+        if (!starts[index].get())
+            success = false;
 
         // Workers register with stop handler just to keep them in scope.
         subscribe_stop([=](const code&) { worker->stop(); });
     }
 
-    return true;
+    return success;
 }
 
 // Called from start_query_services.
@@ -18,6 +18,8 @@
  */
 #include <bitcoin/server/services/block_service.hpp>
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -26,6 +28,7 @@
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/server_node.hpp>
 #include <bitcoin/server/settings.hpp>
+#include <bitcoin/server/utility/thread_affinity.hpp>
 
 namespace libbitcoin {
 namespace server {
@@ -39,19 +42,29 @@ using role = zmq::socket::role;
 static const auto domain = "block";
 static const auto public_worker = "inproc://public_block";
 static const auto secure_worker = "inproc://secure_block";
+static const auto public_compact_worker = "inproc://public_compact_block";
+static const auto secure_compact_worker = "inproc://secure_compact_block";
 
 block_service::block_service(zmq::authenticator& authenticator,
-    server_node& node, bool secure)
+    server_node& node, bool secure, bool compact)
   : worker(priority(node.server_settings().priority)),
     secure_(secure),
-    security_(secure ? "secure" : "public"),
+    compact_(compact),
+    security_(std::string(secure ? "secure" : "public") +
+        (compact ? " compact" : "")),
     settings_(node.server_settings()),
-    external_(node.protocol_settings()),
+    external_(bc::server::settings::zeromq_tuned(node.protocol_settings(),
+        settings_.block_send_high_water,
+        settings_.block_receive_high_water)),
     internal_(external_.send_high_water, external_.receive_high_water),
-    service_(settings_.zeromq_block_endpoint(secure)),
-    worker_(secure ? secure_worker : public_worker),
+    service_(compact ? settings_.zeromq_compact_block_endpoint(secure) :
+        settings_.zeromq_block_endpoint(secure)),
+    worker_(compact ?
+        (secure ? secure_compact_worker : public_compact_worker) :
+        (secure ? secure_worker : public_worker)),
     authenticator_(authenticator),
     node_(node),
+    pusher_(authenticator, role::pusher, worker_, internal_),
 
     // Pick a random sequence counter start, will wrap around at overflow.
     sequence_(static_cast<uint16_t>(pseudo_random(0, max_uint16)))
@@ -61,10 +74,10 @@ block_service::block_service(zmq::authenticator& authenticator,
 // There is no unsubscribe so this class shouldn't be restarted.
 bool block_service::start()
 {
-    // Subscribe to blockchain reorganizations.
-    node_.subscribe_blocks(
-        std::bind(&block_service::handle_reorganization,
-            this, _1, _2, _3, _4));
+    // Subscribe to blocks serialized by the shared publication stage.
+    node_.publications().subscribe_blocks(
+        std::bind(&block_service::handle_blocks,
+            this, _1));
 
     return zmq::worker::start();
 }
@@ -73,6 +86,9 @@ bool block_service::start()
 // The publisher drops messages for lost peers (clients) and high water.
 void block_service::work()
 {
+    thread_affinity::pin(settings_.publisher_cores,
+        security_ + " block service");
+
     zmq::socket xpub(authenticator_, role::extended_publisher, external_);
     zmq::socket puller(authenticator_, role::puller, internal_);
 
@@ -85,8 +101,11 @@ void block_service::work()
     // Relay messages between subscriber and publisher (blocks on context).
     relay(xpub, puller);
 
+    // The cached pusher must be closed for the context to terminate.
+    const auto pusher_stop = pusher_.stop();
+
     // Unbind the sockets and exit this thread.
-    finished(unbind(xpub, puller));
+    finished(unbind(xpub, puller) && pusher_stop);
 }
 
 // Bind/Unbind.
@@ -107,6 +126,25 @@ bool block_service::bind(zmq::socket& xpub, zmq::socket& xsub)
         return false;
     }
 
+    // Trusted local clients may also connect over ipc, without curve or tcp.
+    if (!secure_ && !settings_.ipc_directory.empty())
+    {
+        const auto ipc = settings_.zeromq_ipc_endpoint(compact_ ?
+            "compact_block" : "block");
+        ec = xpub.bind(ipc);
+
+        if (ec)
+        {
+            LOG_ERROR(LOG_SERVER)
+                << "Failed to bind " << security_ << " block service to "
+                << ipc << " : " << ec.message();
+            return false;
+        }
+
+        LOG_INFO(LOG_SERVER)
+            << "Bound " << security_ << " block service to " << ipc;
+    }
+
     ec = xsub.bind(worker_);
 
     if (ec)
@@ -143,97 +181,137 @@ bool block_service::unbind(zmq::socket& xpub, zmq::socket& xsub)
 // Publish (integral worker).
 // ----------------------------------------------------------------------------
 
-bool block_service::handle_reorganization(const code& ec, size_t fork_height,
-    block_const_ptr_list_const_ptr incoming, block_const_ptr_list_const_ptr)
-{
-    if (stopped() || ec == error::service_stopped)
-        return false;
-
-    if (ec)
-    {
-        LOG_WARNING(LOG_SERVER)
-            << "Failure handling new block: " << ec.message();
-
-        // Don't let a failure here prevent future notifications.
-        return true;
-    }
-
-    // Nothing to do here, a channel is stopping.
-    if (!incoming || incoming->empty())
-        return true;
-
-    // Do not announce blocks to clients if too far behind.
-    if (node_.chain().is_blocks_stale())
-        return true;
-
-    // Blockchain height is 64 bit but obelisk protocol is 32 bit.
-    publish_blocks(safe_unsigned<uint32_t>(fork_height), incoming);
-    return true;
-}
-
-void block_service::publish_blocks(uint32_t fork_height,
-    block_const_ptr_list_const_ptr blocks)
+// Stale and failure conditions are handled by the publication stage.
+void block_service::handle_blocks(const publication::list& blocks)
 {
     if (stopped())
         return;
 
-    zmq::socket pusher(authenticator_, role::pusher, internal_);
-
     // Subscriptions are off the pub-sub thread so this must connect back.
-    // This could be optimized by caching the socket as thread static.
-    const auto ec = pusher.connect(worker_);
-
-    if (ec == error::service_stopped)
-        return;
+    // The pusher is cached across publications and reconnects on failure.
+    pusher_.send(std::bind(&block_service::publish_blocks,
+        this, _1, std::cref(blocks)));
+}
 
-    if (ec)
+code block_service::publish_blocks(zmq::socket& pusher,
+    const publication::list& blocks)
+{
+    for (const auto block: blocks)
     {
-        LOG_WARNING(LOG_SERVER)
-            << "Failed to connect " << security_ << " block worker: "
-            << ec.message();
-        return;
+        const auto ec = publish_block(pusher, block);
+
+        if (ec)
+            return ec;
     }
 
-    for (const auto block: *blocks)
-        publish_block(pusher, ++fork_height, block);
+    return error::success;
 }
 
 // [ height:4 ]
-// [ block ]
+// [ block ] or [ header:80 ][[ tx hash:32 ]...] (compact)
 // The payload for block publication is delimited within the zeromq message.
 // This is required for compatability and inconsistent with query payloads.
-void block_service::publish_block(zmq::socket& pusher, size_t height,
-    block_const_ptr block)
+code block_service::publish_block(zmq::socket& pusher,
+    publication::ptr block)
 {
     if (stopped())
-        return;
+        return error::service_stopped;
+
+    // Full blocks may be published in a series of messages, compact are small.
+    if (!compact_ && settings_.block_chunk_kilobytes > 0)
+        return publish_chunks(pusher, block);
 
     // [ sequence:2 ]
     // [ height:4 ]
     // [ block:... ]
+    // Blockchain height is 64 bit but obelisk protocol is 32 bit.
+    // The block is serialized once (by the stage) for all block services.
     zmq::message broadcast;
     broadcast.enqueue_little_endian(++sequence_);
-    broadcast.enqueue_little_endian(static_cast<uint32_t>(height));
-    broadcast.enqueue(block->to_data(
-        system::message::version::level::canonical));
+    broadcast.enqueue_little_endian(
+        safe_unsigned<uint32_t>(block->height()));
+
+    if (compact_)
+        broadcast.enqueue(block->compact());
+    else if (settings_.block_compression_enabled)
+        broadcast.enqueue(block->compressed());
+    else
+        broadcast.enqueue(block->data());
 
     const auto ec = pusher.send(broadcast);
 
     if (ec == error::service_stopped)
-        return;
+        return ec;
 
     if (ec)
     {
         LOG_WARNING(LOG_SERVER)
             << "Failed to publish " << security_ << " bloc ["
             << encode_hash(block->hash()) << "] " << ec.message();
-        return;
+        return ec;
     }
 
     // This isn't actually a request, should probably update settings.
     LOG_VERBOSE(LOG_SERVER)
         << "Published " << security_ << " block ["
         << encode_hash(block->hash()) << "] (" << sequence_ << ").";
+    return ec;
+}
+
+// [ sequence:2 ]
+// [ height:4 ]
+// [ offset:4 ]
+// [ total:4 ] (of the block, complete at offset + chunk = total)
+// [ chunk:... ]
+// Each chunk is a message, limiting the size of each message and frame.
+// This does not bound memory, as the publication retains the serialized
+// block and the pusher queues its chunks up to high water. A subscriber may
+// lose any chunk at high water, so it must drop a block that is missing any
+// chunk (as the block websocket does). All chunks of a block share its
+// sequence.
+code block_service::publish_chunks(zmq::socket& pusher,
+    publication::ptr block)
+{
+    const auto chunk_size = size_t(settings_.block_chunk_kilobytes) << 10;
+    const auto& data = settings_.block_compression_enabled ?
+        block->compressed() : block->data();
+    const auto total = data.size();
+    const auto height = safe_unsigned<uint32_t>(block->height());
+    const auto sequence = ++sequence_;
+    size_t offset = 0;
+
+    do
+    {
+        const auto size = std::min(chunk_size, total - offset);
+        const auto begin = data.begin() + offset;
+
+        zmq::message broadcast;
+        broadcast.enqueue_little_endian(sequence);
+        broadcast.enqueue_little_endian(height);
+        broadcast.enqueue_little_endian(static_cast<uint32_t>(offset));
+        broadcast.enqueue_little_endian(static_cast<uint32_t>(total));
+        broadcast.enqueue(data_chunk{ begin, begin + size });
+
+        const auto ec = pusher.send(broadcast);
+
+        if (ec == error::service_stopped)
+            return ec;
+
+        if (ec)
+        {
+            LOG_WARNING(LOG_SERVER)
+                << "Failed to publish " << security_ << " block ["
+                << encode_hash(block->hash()) << "] " << ec.message();
+            return ec;
+        }
+
+        offset += size;
+    } while (offset < total);
+
+    LOG_VERBOSE(LOG_SERVER)
+        << "Published " << security_ << " block ["
+        << encode_hash(block->hash()) << "] (" << sequence_ << ") in chunks.";
+    return error::success;
 }
 
 } // namespace server
@@ -23,6 +23,7 @@
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/server_node.hpp>
 #include <bitcoin/server/settings.hpp>
+#include <bitcoin/server/utility/thread_affinity.hpp>
 
 namespace libbitcoin {
 namespace server {
@@ -55,6 +56,9 @@ heartbeat_service::heartbeat_service(zmq::authenticator& authenticator,
 // The publisher drops messages for lost peers (clients) and high water.
 void heartbeat_service::work()
 {
+    thread_affinity::pin(settings_.publisher_cores,
+        security_ + " heartbeat service");
+
     zmq::socket publisher(authenticator_, role::publisher, external_);
 
     // Bind socket to the service endpoint.
@@ -86,6 +90,38 @@ int32_t heartbeat_service::pulse_milliseconds() const
     return static_cast<int32_t>(capped);
 }
 
+// The status is a fixed size snapshot, so that monitoring reads the node
+// without a query. Counters are totals since start, rates are their deltas.
+// [ top hash:32 ]
+// [ unconfirmed transactions:8 ]
+// [ requests:8 ][ responses:8 ][ drops:8 ][ rejections:8 ][ in flight:8 ]
+// [ key subscriptions:4 ][ stealth subscriptions:4 ]
+// [ published blocks:8 ][ published transactions:8 ]
+data_chunk heartbeat_service::status() const
+{
+    static constexpr size_t status_size = hash_size + 8 * 8 + 2 * 4;
+
+    const auto metrics = node_.metrics().summarize();
+    auto& publications = node_.publications();
+
+    data_chunk out(status_size);
+    auto serial = make_unsafe_serializer(out.begin());
+    serial.write_hash(node_.tip().hash());
+    serial.write_8_bytes_little_endian(node_.unconfirmed().size());
+    serial.write_8_bytes_little_endian(metrics.requested);
+    serial.write_8_bytes_little_endian(metrics.responded);
+    serial.write_8_bytes_little_endian(metrics.dropped);
+    serial.write_8_bytes_little_endian(metrics.rejected);
+    serial.write_8_bytes_little_endian(metrics.in_flight);
+    serial.write_4_bytes_little_endian(static_cast<uint32_t>(
+        node_.key_subscriptions(secure_)));
+    serial.write_4_bytes_little_endian(static_cast<uint32_t>(
+        node_.stealth_subscriptions(secure_)));
+    serial.write_8_bytes_little_endian(publications.published_blocks());
+    serial.write_8_bytes_little_endian(publications.published_transactions());
+    return out;
+}
+
 // Bind/Unbind.
 //-----------------------------------------------------------------------------
 
@@ -130,9 +166,13 @@ void heartbeat_service::publish(zmq::socket& publisher)
 
     // [ sequence:2 ]
     // [ height:8 ]
+    // [ status:104 ] (optional)
     zmq::message message;
     message.enqueue_little_endian(++sequence_);
-    message.enqueue_little_endian(node_.top_block().height());
+    message.enqueue_little_endian(node_.tip().height());
+
+    if (settings_.heartbeat_status_enabled)
+        message.enqueue(status());
 
     auto ec = publisher.send(message);
 
@@ -0,0 +1,151 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/services/metrics_service.hpp>
+
+#include <cstdint>
+#include <string>
+#include <bitcoin/protocol.hpp>
+#include <bitcoin/server/server_node.hpp>
+#include <bitcoin/server/settings.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::protocol;
+using namespace bc::system;
+using namespace bc::system::config;
+using role = zmq::socket::role;
+
+// The service rechecks for stop at this interval when idle.
+static constexpr int32_t poll_interval_milliseconds = 100;
+
+metrics_service::metrics_service(zmq::authenticator& authenticator,
+    server_node& node)
+  : worker(priority(node.server_settings().priority)),
+    settings_(node.server_settings()),
+    external_(node.protocol_settings()),
+    service_(settings_.metrics_endpoint),
+    authenticator_(authenticator),
+    metrics_(node.metrics())
+{
+}
+
+// Implement service as a tcp streamer.
+void metrics_service::work()
+{
+    zmq::socket streamer(authenticator_, role::streamer, external_);
+
+    // Bind socket to the service endpoint.
+    if (!started(bind(streamer)))
+        return;
+
+    zmq::poller poller;
+    poller.add(streamer);
+
+    while (!poller.terminated() && !stopped())
+    {
+        if (poller.wait(poll_interval_milliseconds).contains(streamer.id()))
+            respond(streamer);
+    }
+
+    // Unbind the socket and exit this thread.
+    finished(unbind(streamer));
+}
+
+// Bind/Unbind.
+//-----------------------------------------------------------------------------
+
+bool metrics_service::bind(zmq::socket& streamer)
+{
+    const auto ec = streamer.bind(service_);
+
+    if (ec)
+    {
+        LOG_ERROR(LOG_SERVER)
+            << "Failed to bind metrics service to " << service_ << " : "
+            << ec.message();
+        return false;
+    }
+
+    LOG_INFO(LOG_SERVER)
+        << "Bound metrics service to " << service_;
+    return true;
+}
+
+bool metrics_service::unbind(zmq::socket& streamer)
+{
+    // Don't log stop success.
+    if (streamer.stop())
+        return true;
+
+    LOG_ERROR(LOG_SERVER)
+        << "Failed to unbind metrics service.";
+    return false;
+}
+
+// Respond Execution (integral worker).
+//-----------------------------------------------------------------------------
+
+// Any request is answered with the report and the connection is closed.
+void metrics_service::respond(zmq::socket& streamer)
+{
+    if (stopped())
+        return;
+
+    // [ identity ]
+    // [ data... ]
+    zmq::message request;
+    auto ec = streamer.receive(request);
+
+    if (ec || request.size() != 2)
+        return;
+
+    const auto identity = request.dequeue_data();
+
+    // Connection and disconnection are signaled with an empty payload.
+    if (request.dequeue_data().empty())
+        return;
+
+    const auto report = metrics_.report();
+    const auto reply =
+        "HTTP/1.0 200 OK\r\n"
+        "Content-Type: text/plain; version=0.0.4\r\n"
+        "Content-Length: " + std::to_string(report.size()) + "\r\n"
+        "Connection: close\r\n\r\n" + report;
+
+    zmq::message response;
+    response.enqueue(identity);
+    response.enqueue(to_chunk(reply));
+    ec = streamer.send(response);
+
+    // An empty payload to the identity closes the connection.
+    zmq::message close;
+    close.enqueue(identity);
+    close.enqueue();
+
+    if (!ec)
+        ec = streamer.send(close);
+
+    if (ec && ec != error::service_stopped)
+        LOG_DEBUG(LOG_SERVER)
+            << "Failed to send metrics report: " << ec.message();
+}
+
+} // namespace server
+} // namespace libbitcoin
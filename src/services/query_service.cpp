@@ -18,9 +18,20 @@
  */
 #include <bitcoin/server/services/query_service.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <utility>
 #include <bitcoin/protocol.hpp>
+#include <bitcoin/server/messages/message.hpp>
 #include <bitcoin/server/server_node.hpp>
 #include <bitcoin/server/settings.hpp>
+#include <bitcoin/server/utility/thread_affinity.hpp>
 
 namespace libbitcoin {
 namespace server {
@@ -31,29 +42,108 @@ using namespace bc::system::config;
 using role = zmq::socket::role;
 
 static const auto domain = "query";
-static const config::endpoint public_worker("inproc://public_query");
-static const config::endpoint secure_worker("inproc://secure_query");
+static const auto public_worker = "inproc://public_query";
+static const auto secure_worker = "inproc://secure_query";
+static const auto public_express = "inproc://public_query_express";
+static const auto secure_express = "inproc://secure_query_express";
+static const auto public_notify = "inproc://public_query_notify";
+static const auto secure_notify = "inproc://secure_query_notify";
+static const config::endpoint public_local("inproc://public_query_local");
+
+// The broker rechecks for stop at this interval when idle.
+static constexpr int32_t poll_interval_milliseconds = 100;
+
+// The broker rechecks lane capacity at this interval while queries wait.
+static constexpr int32_t saturated_interval_milliseconds = 1;
+
+// Idle client rate buckets are dropped at this interval.
+static const auto prune_interval = std::chrono::seconds(60);
+
+// The elastic worker pool is evaluated at this interval.
+static const auto scale_interval = std::chrono::milliseconds(250);
+
+// The elastic workers are those above the configured workers, up to limit.
+static size_t elastic(const bc::server::settings& settings)
+{
+    const auto limit = settings.query_workers_limit;
+    return limit > settings.query_workers ? limit - settings.query_workers : 0;
+}
+
+// The first instance retains the unsuffixed inprocess endpoint names.
+static config::endpoint instanced(const std::string& name, uint16_t instance)
+{
+    return config::endpoint(instance == 0 ? name :
+        name + "_" + std::to_string(instance));
+}
+
+// The first instance retains the unsuffixed ipc socket name.
+static std::string query_name(uint16_t instance)
+{
+    return instance == 0 ? "query" : "query_" + std::to_string(instance);
+}
+
+// static
+config::endpoint query_service::worker_endpoint(bool secure,
+    uint16_t instance)
+{
+    return instanced(secure ? secure_worker : public_worker, instance);
+}
+
+// static
+config::endpoint query_service::elastic_endpoint(bool secure,
+    uint16_t instance, size_t slot)
+{
+    return instanced(std::string(secure ? secure_worker : public_worker) +
+        "_elastic_" + std::to_string(slot), instance);
+}
+
+// static
+config::endpoint query_service::express_endpoint(bool secure,
+    uint16_t instance)
+{
+    return instanced(secure ? secure_express : public_express, instance);
+}
+
+// static
+const config::endpoint& query_service::local_endpoint()
+{
+    return public_local;
+}
 
 // static
-const config::endpoint& query_service::worker_endpoint(bool secure)
+config::endpoint query_service::notify_endpoint(bool secure,
+    uint16_t instance)
 {
-    return secure ? secure_worker : public_worker;
+    return instanced(secure ? secure_notify : public_notify, instance);
 }
 
 query_service::query_service(zmq::authenticator& authenticator,
-    server_node& node, bool secure)
+    server_node& node, bool secure, uint16_t instance)
   : worker(priority(node.server_settings().priority)),
     secure_(secure),
+    instance_(instance),
     security_(secure ? "secure" : "public"),
     settings_(node.server_settings()),
-    external_(node.protocol_settings()),
+    external_(bc::server::settings::zeromq_tuned(node.protocol_settings(),
+        settings_.query_send_high_water,
+        settings_.query_receive_high_water)),
     internal_(external_.send_high_water, external_.receive_high_water),
-    service_(settings_.zeromq_query_endpoint(secure)),
-    worker_(secure ? secure_worker : public_worker),
-    authenticator_(authenticator)
+    service_(settings_.zeromq_query_endpoint(secure, instance)),
+    worker_(worker_endpoint(secure, instance)),
+    express_(express_endpoint(secure, instance)),
+    authenticator_(authenticator),
+    metrics_(node.metrics()),
+    tracer_(node.tracer()),
+    limiter_(settings_.query_rate_limit),
+    pool_(authenticator, node, secure, instance, elastic(settings_))
 {
 }
 
+query_capacity& query_service::capacity(bool express)
+{
+    return express ? express_capacity_ : capacity_;
+}
+
 // Implement worker as a broker.
 // The dealer blocks until there are available workers.
 // The router drops messages for lost peers (clients) and high water.
@@ -65,26 +155,331 @@ query_service::query_service(zmq::authenticator& authenticator,
 // also be dropped. api.zeromq.org/4-2:zmq-socket
 void query_service::work()
 {
+    thread_affinity::pin(settings_.query_service_cores,
+        security_ + " query service");
+
     zmq::socket router(authenticator_, role::router, external_);
     zmq::socket dealer(authenticator_, role::dealer, internal_);
+    zmq::socket express(authenticator_, role::dealer, internal_);
+    zmq::socket local(authenticator_, role::router, internal_);
+    zmq::socket notify(authenticator_, role::dealer, internal_);
 
-    // Bind sockets to the service and worker endpoints.
-    if (!started(bind(router, dealer)))
+    zmq::poller poller;
+
+    // Bind sockets to the service, worker, elastic, local and notify
+    // endpoints.
+    if (!started(bind(router, dealer, express) && bind_elastic(poller) &&
+        bind(local, notify)))
         return;
 
-    // TODO: tap in to failure conditions, such as high water.
-    // BUGBUG: stop is insufficient to stop the worker, because of relay().
-    // Relay messages between router and dealer (blocks on context).
-    relay(router, dealer);
+    poller.add(router);
+    poller.add(local);
+    poller.add(dealer);
+    poller.add(express);
+    poller.add(notify);
+    auto pruned = rate_limiter::clock::now();
+    auto scaled = pruned;
+
+    // Admit queries from the router into the lane backlogs and relay
+    // responses from the lane dealers. Queries are dispatched from each lane
+    // backlog only while its workers have free capacity, so that queries
+    // wait in the backlog, where they are prioritized and limited. Without
+    // express workers the express backlog is dispatched (first) to the
+    // standard lane. Each relay and any failure to send (such as at high
+    // water) is counted.
+    while (!poller.terminated() && !stopped())
+    {
+        // Completion is not signaled, so waiting queries poll for capacity.
+        const auto idle = express_backlog_.empty() && backlog_.empty();
+        const auto signaled = poller.wait(idle ? poll_interval_milliseconds :
+            saturated_interval_milliseconds);
+
+        if (signaled.contains(router.id()))
+            admit(router, false);
+
+        if (signaled.contains(local.id()))
+            admit(local, true);
+
+        if (signaled.contains(dealer.id()))
+            respond(dealer, router, local);
+
+        if (signaled.contains(express.id()))
+            respond(express, router, local);
+
+        if (signaled.contains(notify.id()))
+            deliver(notify, router, local);
+
+        for (const auto& slot: elastic_)
+            if (signaled.contains(slot->id()))
+                respond(*slot, router, local);
+
+        if (settings_.express_query_workers == 0)
+            dispatch(express_backlog_, dealer);
+        else
+            dispatch(express_backlog_, express, express_capacity_,
+                limit(settings_.express_query_workers));
+
+        dispatch(backlog_, dealer);
+
+        const auto now = rate_limiter::clock::now();
+
+        if (now - pruned >= prune_interval)
+        {
+            limiter_.prune(now);
+            pruned = now;
+        }
+
+        if (now - scaled >= scale_interval)
+        {
+            scale(now);
+            scaled = now;
+        }
+    }
+
+    // Elastic workers are stopped with the service.
+    pool_.stop();
 
     // Unbind the sockets and exit this thread.
-    finished(unbind(router, dealer));
+    const auto elastic_stop = unbind_elastic();
+    const auto local_stop = unbind(local, notify);
+    finished(unbind(router, dealer, express) && local_stop && elastic_stop);
+}
+
+// Each worker accepts up to the query concurrency, or one query at a time if
+// queries execute on the worker thread.
+size_t query_service::limit(size_t workers) const
+{
+    const size_t concurrency = std::max(settings_.query_concurrency,
+        uint16_t(1));
+
+    return workers * concurrency;
+}
+
+// The standard lane backlog includes the express backlog when it has no
+// workers of its own. Queries are stamped on receipt by the same clock.
+void query_service::scale(query_pool::clock::time_point now)
+{
+    const auto shared = settings_.express_query_workers == 0;
+    auto depth = backlog_.size();
+    auto oldest = backlog_.empty() ? now : backlog_.front().received();
+
+    if (shared && !express_backlog_.empty())
+    {
+        depth += express_backlog_.size();
+        oldest = std::min(oldest, express_backlog_.front().received());
+    }
+
+    pool_.adjust(depth, now - oldest, now);
+}
+
+// Relay.
+//-----------------------------------------------------------------------------
+
+// private/static
+bool query_service::is_express(const std::string& command)
+{
+    // Commands of constant cost, which must not wait on history scans.
+    static const std::unordered_set<std::string> commands
+    {
+        "blockchain.fetch_last_height",
+        "blockchain.fetch_block_height",
+        "blockchain.fetch_block_header",
+        "blockchain.fetch_transaction_index",
+        "blockchain.fetch_spend",
+        "transaction_pool.fetch_history",
+        "subscribe.key",
+        "subscribe.key2",
+        "subscribe.key_transactions",
+        "unsubscribe.key",
+        "server.version",
+        "server.stats"
+    };
+
+    return commands.find(command) != commands.end();
+}
+
+
+// Queries are rejected early, with a response, if over the client's rate, the
+// client's share of the backlog or the service backlog limit. So one client
+// cannot fill the backlog and starve the others. Local (websocket relay)
+// queries are not client limited, as the relay multiplexes all websocket
+// clients.
+void query_service::admit(zmq::socket& router, bool local)
+{
+    message request(secure_);
+    auto ec = request.receive(router);
+
+    if (ec == error::service_stopped)
+        return;
+
+    if (!ec && local)
+        locals_.insert(request.route().address());
+
+    if (!ec && !local && !limiter_.admit(request.route().address(),
+        rate_limiter::clock::now()))
+        ec = error::oversubscribed;
+
+    const auto share = settings_.query_client_backlog_limit;
+
+    if (!ec && !local && share != 0)
+    {
+        const auto it = waiting_.find(request.route().address());
+
+        if (it != waiting_.end() && it->second >= share)
+            ec = error::oversubscribed;
+    }
+
+    const auto limit = settings_.query_backlog_limit;
+
+    if (!ec && limit != 0 &&
+        express_backlog_.size() + backlog_.size() >= limit)
+        ec = error::oversubscribed;
+
+    if (ec)
+    {
+        if (ec == error::oversubscribed)
+            metrics_.rejected();
+
+        LOG_DEBUG(LOG_SERVER)
+            << "Rejected " << security_ << " query from "
+            << request.route().display() << " " << ec.message();
+
+        ec = message(request, ec).transfer(router);
+
+        if (ec && ec != error::service_stopped)
+            metrics_.dropped();
+
+        return;
+    }
+
+    if (!local)
+        ++waiting_[request.route().address()];
+
+    if (is_express(request.command()))
+        express_backlog_.push_back(std::move(request));
+    else
+        backlog_.push_back(std::move(request));
+}
+
+// The standard lane dispatches to its configured workers, then to each
+// dispatchable elastic worker, each while it has free capacity.
+void query_service::dispatch(backlog& queue, zmq::socket& dealer)
+{
+    dispatch(queue, dealer, capacity_, limit(settings_.query_workers));
+
+    for (size_t slot = 0; slot < elastic_.size() && !queue.empty(); ++slot)
+        if (pool_.dispatchable(slot))
+            dispatch(queue, *elastic_[slot], pool_.capacity(slot), limit(1));
+}
+
+// Queries are dispatched in order while the lane has free capacity.
+void query_service::dispatch(backlog& queue, zmq::socket& dealer,
+    query_capacity& capacity, size_t limit)
+{
+    while (!queue.empty() && capacity.available(limit))
+    {
+        tracer_.relay(queue.front());
+        release(queue.front().route().address());
+        const auto ec = queue.front().transfer(dealer);
+        queue.pop_front();
+
+        if (ec == error::service_stopped)
+            return;
+
+        if (ec)
+        {
+            metrics_.dropped();
+            LOG_DEBUG(LOG_SERVER)
+                << "Failed to relay " << security_ << " query: "
+                << ec.message();
+            return;
+        }
+
+        capacity.dispatched();
+        metrics_.requested();
+    }
+}
+
+// The client has one less query awaiting a worker.
+void query_service::release(const address& client)
+{
+    const auto it = waiting_.find(client);
+
+    if (it != waiting_.end() && --it->second == 0)
+        waiting_.erase(it);
+}
+
+// Responses are returned to the router of their client.
+void query_service::respond(zmq::socket& dealer, zmq::socket& router,
+    zmq::socket& local)
+{
+    message response(secure_);
+    auto ec = response.receive(dealer);
+
+    if (!ec)
+    {
+        const auto is_local = locals_.find(response.route().address()) !=
+            locals_.end();
+        ec = response.transfer(is_local ? local : router);
+    }
+
+    if (ec == error::service_stopped)
+        return;
+
+    if (ec)
+    {
+        metrics_.dropped();
+        LOG_DEBUG(LOG_SERVER)
+            << "Failed to relay " << security_ << " query response: "
+            << ec.message();
+        return;
+    }
+
+    metrics_.responded();
+}
+
+// Notifications are returned to the router of their client. All are sent to
+// the first instance, which passes those of clients of other instances on to
+// the instance of the client.
+void query_service::deliver(zmq::socket& notify, zmq::socket& router,
+    zmq::socket& local)
+{
+    message notification(secure_);
+    auto ec = notification.receive_notification(notify);
+    const auto instance = notification.route().instance();
+
+    if (!ec && instance != instance_)
+    {
+        ec = instance <= peers_.size() ?
+            notification.notify(*peers_[instance - 1]) : error::not_found;
+    }
+    else if (!ec)
+    {
+        const auto is_local = locals_.find(notification.route().address()) !=
+            locals_.end();
+        ec = notification.transfer(is_local ? local : router);
+    }
+
+    if (ec == error::service_stopped)
+        return;
+
+    if (ec)
+    {
+        metrics_.dropped();
+        LOG_DEBUG(LOG_SERVER)
+            << "Failed to relay " << security_ << " notification: "
+            << ec.message();
+        return;
+    }
+
+    metrics_.responded();
 }
 
 // Bind/Unbind.
 //-----------------------------------------------------------------------------
 
-bool query_service::bind(zmq::socket& router, zmq::socket& dealer)
+bool query_service::bind(zmq::socket& router, zmq::socket& dealer,
+    zmq::socket& express)
 {
     if (!authenticator_.apply(router, domain, secure_))
         return false;
@@ -99,6 +494,24 @@ bool query_service::bind(zmq::socket& router, zmq::socket& dealer)
         return false;
     }
 
+    // Trusted local clients may also connect over ipc, without curve or tcp.
+    if (!secure_ && !settings_.ipc_directory.empty())
+    {
+        const auto ipc = settings_.zeromq_ipc_endpoint(query_name(instance_));
+        ec = router.bind(ipc);
+
+        if (ec)
+        {
+            LOG_ERROR(LOG_SERVER)
+                << "Failed to bind " << security_ << " query service to "
+                << ipc << " : " << ec.message();
+            return false;
+        }
+
+        LOG_INFO(LOG_SERVER)
+            << "Bound " << security_ << " query service to " << ipc;
+    }
+
     ec = dealer.bind(worker_);
 
     if (ec)
@@ -109,16 +522,149 @@ bool query_service::bind(zmq::socket& router, zmq::socket& dealer)
         return false;
     }
 
+    ec = express.bind(express_);
+
+    if (ec)
+    {
+        LOG_ERROR(LOG_SERVER)
+            << "Failed to bind " << security_ << " express query workers to "
+            << express_ << " : " << ec.message();
+        return false;
+    }
+
     LOG_INFO(LOG_SERVER)
         << "Bound " << security_ << " query service to " << service_;
     return true;
 }
 
-bool query_service::unbind(zmq::socket& router, zmq::socket& dealer)
+// Each elastic worker slot is dispatched through its own dealer, so that a
+// retiring worker receives no further queries.
+bool query_service::bind_elastic(zmq::poller& poller)
+{
+    for (size_t slot = 0; slot < pool_.slots(); ++slot)
+    {
+        const auto endpoint = elastic_endpoint(secure_, instance_, slot);
+        const auto dealer = std::make_shared<zmq::socket>(authenticator_,
+            role::dealer, internal_);
+        const auto ec = dealer->bind(endpoint);
+
+        if (ec)
+        {
+            LOG_ERROR(LOG_SERVER)
+                << "Failed to bind " << security_ << " query workers to "
+                << endpoint << " : " << ec.message();
+            return false;
+        }
+
+        poller.add(*dealer);
+        elastic_.push_back(dealer);
+    }
+
+    return true;
+}
+
+bool query_service::unbind_elastic()
+{
+    // Stop all even if one fails.
+    auto stopped = true;
+
+    for (const auto dealer: elastic_)
+        stopped = dealer->stop() && stopped;
+
+    elastic_.clear();
+
+    if (!stopped)
+        LOG_ERROR(LOG_SERVER)
+            << "Failed to unbind " << security_ << " elastic query workers.";
+
+    return stopped;
+}
+
+// The public local router accepts the in process websocket query relay.
+// Each instance accepts notifications, and the first connects a dealer to
+// each of the others so that it can pass on those of their clients.
+bool query_service::bind(zmq::socket& local, zmq::socket& notify)
+{
+    const auto notifications = notify_endpoint(secure_, instance_);
+    auto ec = notify.bind(notifications);
+
+    if (ec)
+    {
+        LOG_ERROR(LOG_SERVER)
+            << "Failed to bind " << security_ << " query service to "
+            << notifications << " : " << ec.message();
+        return false;
+    }
+
+    if (instance_ != 0)
+        return true;
+
+    for (uint16_t instance = 1; instance < settings_.query_instances;
+        ++instance)
+    {
+        const auto endpoint = notify_endpoint(secure_, instance);
+        const auto peer = std::make_shared<zmq::socket>(authenticator_,
+            role::dealer, internal_);
+        ec = peer->connect(endpoint);
+
+        if (ec)
+        {
+            LOG_ERROR(LOG_SERVER)
+                << "Failed to connect " << security_ << " query service to "
+                << endpoint << " : " << ec.message();
+            return false;
+        }
+
+        peers_.push_back(peer);
+    }
+
+    if (secure_)
+        return true;
+
+    ec = local.bind(public_local);
+
+    if (ec)
+    {
+        LOG_ERROR(LOG_SERVER)
+            << "Failed to bind " << security_ << " query service to "
+            << public_local << " : " << ec.message();
+        return false;
+    }
+
+    return true;
+}
+
+bool query_service::unbind(zmq::socket& local, zmq::socket& notify)
 {
-    // Stop both even if one fails.
+    // Stop all even if one fails.
+    auto notify_stop = notify.stop();
+
+    for (const auto peer: peers_)
+        notify_stop = peer->stop() && notify_stop;
+
+    peers_.clear();
+    const auto local_stop = local.stop();
+
+    if (!notify_stop)
+        LOG_ERROR(LOG_SERVER)
+            << "Failed to unbind " << security_
+            << " query service notifications.";
+
+    if (!local_stop)
+        LOG_ERROR(LOG_SERVER)
+            << "Failed to unbind " << security_ << " local query service.";
+
+    // Don't log stop success.
+    return notify_stop && local_stop;
+}
+
+bool query_service::unbind(zmq::socket& router, zmq::socket& dealer,
+    zmq::socket& express)
+{
+    // Stop all even if one fails.
     const auto service_stop = router.stop();
     const auto worker_stop = dealer.stop();
+    const auto express_stop = express.stop();
 
     if (!service_stop)
         LOG_ERROR(LOG_SERVER)
@@ -128,8 +674,12 @@ bool query_service::unbind(zmq::socket& router, zmq::socket& dealer)
         LOG_ERROR(LOG_SERVER)
             << "Failed to unbind " << security_ << " query workers.";
 
+    if (!express_stop)
+        LOG_ERROR(LOG_SERVER)
+            << "Failed to unbind " << security_ << " express query workers.";
+
     // Don't log stop success.
-    return service_stop && worker_stop;
+    return service_stop && worker_stop && express_stop;
 }
 
 } // namespace server
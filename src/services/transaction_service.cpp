@@ -24,6 +24,7 @@
 #include <bitcoin/server/configuration.hpp>
 #include <bitcoin/server/server_node.hpp>
 #include <bitcoin/server/settings.hpp>
+#include <bitcoin/server/utility/thread_affinity.hpp>
 
 namespace libbitcoin {
 namespace server {
@@ -45,12 +46,15 @@ transaction_service::transaction_service(zmq::authenticator& authenticator,
     secure_(secure),
     security_(secure ? "secure" : "public"),
     settings_(node.server_settings()),
-    external_(node.protocol_settings()),
+    external_(bc::server::settings::zeromq_tuned(node.protocol_settings(),
+        settings_.transaction_send_high_water,
+        settings_.transaction_receive_high_water)),
     internal_(external_.send_high_water, external_.receive_high_water),
     service_(settings_.zeromq_transaction_endpoint(secure)),
     worker_(secure ? secure_worker : public_worker),
     authenticator_(authenticator),
     node_(node),
+    pusher_(authenticator, role::pusher, worker_, internal_),
 
     // Pick a random sequence counter start, will wrap around at overflow.
     sequence_(static_cast<uint16_t>(pseudo_random(0, max_uint16)))
@@ -60,10 +64,10 @@ transaction_service::transaction_service(zmq::authenticator& authenticator,
 // There is no unsubscribe so this class shouldn't be restarted.
 bool transaction_service::start()
 {
-    // Subscribe to transaction pool acceptances.
-    node_.subscribe_transactions(
+    // Subscribe to transactions serialized by the shared publication stage.
+    node_.publications().subscribe_transactions(
         std::bind(&transaction_service::handle_transaction,
-            this, _1, _2));
+            this, _1));
 
     return zmq::worker::start();
 }
@@ -72,6 +76,9 @@ bool transaction_service::start()
 // The publisher drops messages for lost peers (clients) and high water.
 void transaction_service::work()
 {
+    thread_affinity::pin(settings_.publisher_cores,
+        security_ + " transaction service");
+
     zmq::socket xpub(authenticator_, role::extended_publisher, external_);
     zmq::socket puller(authenticator_, role::puller, internal_);
 
@@ -84,8 +91,11 @@ void transaction_service::work()
     // Relay messages between subscriber and publisher (blocks on context).
     relay(xpub, puller);
 
+    // The cached pusher must be closed for the context to terminate.
+    const auto pusher_stop = pusher_.stop();
+
     // Unbind the sockets and exit this thread.
-    finished(unbind(xpub, puller));
+    finished(unbind(xpub, puller) && pusher_stop);
 }
 
 // Bind/Unbind.
@@ -106,6 +116,24 @@ bool transaction_service::bind(zmq::socket& xpub, zmq::socket& xsub)
         return false;
     }
 
+    // Trusted local clients may also connect over ipc, without curve or tcp.
+    if (!secure_ && !settings_.ipc_directory.empty())
+    {
+        const auto ipc = settings_.zeromq_ipc_endpoint("transaction");
+        ec = xpub.bind(ipc);
+
+        if (ec)
+        {
+            LOG_ERROR(LOG_SERVER)
+                << "Failed to bind " << security_ << " transaction service to "
+                << ipc << " : " << ec.message();
+            return false;
+        }
+
+        LOG_INFO(LOG_SERVER)
+            << "Bound " << security_ << " transaction service to " << ipc;
+    }
+
     ec = xsub.bind(worker_);
 
     if (ec)
@@ -142,82 +170,50 @@ bool transaction_service::unbind(zmq::socket& xpub, zmq::socket& xsub)
 // Publish (integral worker).
 // ----------------------------------------------------------------------------
 
-bool transaction_service::handle_transaction(const code& ec,
-    transaction_const_ptr tx)
-{
-    if (stopped() || ec == error::service_stopped)
-        return false;
-
-    if (ec)
-    {
-        LOG_WARNING(LOG_SERVER)
-            << "Failure handling new transaction: " << ec.message();
-
-        // Don't let a failure here prevent future notifications.
-        return true;
-    }
-
-    // Nothing to do here, a channel is stopping.
-    if (!tx)
-        return true;
-
-    // Do not announce txs to clients if too far behind.
-    if (node_.chain().is_blocks_stale())
-        return true;
-
-    publish_transaction(tx);
-    return true;
-}
-
-// [ tx... ]
-void transaction_service::publish_transaction(transaction_const_ptr tx)
+// Stale and failure conditions are handled by the publication stage.
+void transaction_service::handle_transaction(publication::ptr tx)
 {
     if (stopped())
         return;
 
-    zmq::socket pusher(authenticator_, role::pusher, internal_);
-
     // Subscriptions are off the pub-sub thread so this must connect back.
-    // This could be optimized by caching the socket as thread static.
-    auto ec = pusher.connect(worker_);
-
-    if (ec == error::service_stopped)
-        return;
-
-    if (ec)
-    {
-        LOG_WARNING(LOG_SERVER)
-            << "Failed to connect " << security_ << " transaction worker: "
-            << ec.message();
-        return;
-    }
+    // The pusher is cached across publications and reconnects on failure.
+    pusher_.send(std::bind(&transaction_service::publish_transaction,
+        this, _1, tx));
+}
 
+// [ tx... ]
+code transaction_service::publish_transaction(zmq::socket& pusher,
+    publication::ptr tx)
+{
     if (stopped())
-        return;
+        return error::service_stopped;
 
     // [ sequence:2 ]
     // [ tx:... ]
     zmq::message broadcast;
     broadcast.enqueue_little_endian(++sequence_);
-    broadcast.enqueue(tx->to_data(system::message::version::level::canonical));
+    // The tx is serialized once (by the stage) for all transaction services.
+    broadcast.enqueue(tx->data());
 
-    ec = pusher.send(broadcast);
+    const auto ec = pusher.send(broadcast);
 
     if (ec == error::service_stopped)
-        return;
+        return ec;
 
     if (ec)
     {
         LOG_WARNING(LOG_SERVER)
             << "Failed to publish " << security_ << " transaction ["
             << encode_hash(tx->hash()) << "] " << ec.message();
-        return;
+        return ec;
     }
 
     // This isn't actually a request, should probably update settings.
     LOG_VERBOSE(LOG_SERVER)
         << "Published " << security_ << " transaction ["
         << encode_hash(tx->hash()) << "] (" << sequence_ << ").";
+    return ec;
 }
 
 } // namespace server
@@ -28,12 +28,44 @@ using namespace bc::system::asio;
 
 settings::settings()
   : priority(false),
+    query_send_high_water(0),
+    query_receive_high_water(0),
+    block_send_high_water(0),
+    block_receive_high_water(0),
+    transaction_send_high_water(0),
+    transaction_receive_high_water(0),
     secure_only(false),
+    query_only(false),
+    query_instances(1),
     query_workers(1),
+    query_workers_limit(0),
+    express_query_workers(1),
+    query_concurrency(16),
+    query_rate_limit(0),
+    query_backlog_limit(1000),
+    query_client_backlog_limit(100),
+    response_cache_megabytes(16),
+    header_cache_enabled(true),
+    filter_cache_enabled(true),
+    unconfirmed_index_limit(100000),
+    history_cache_megabytes(16),
+    warm_up_blocks(0),
+    query_chunk_kilobytes(256),
+    coalescing_enabled(true),
+    slow_query_milliseconds(0),
+    query_trace_sampling(0),
+    submission_limit(10000),
     subscription_limit(1000),
+    key_subscription_limit(1000),
     subscription_expiration_minutes(10),
+    purge_pause_budget_microseconds(1000),
+    notification_threads(0),
     heartbeat_service_seconds(5),
+    heartbeat_status_enabled(false),
     block_service_enabled(true),
+    compact_block_service_enabled(false),
+    block_chunk_kilobytes(0),
+    block_compression_enabled(false),
     transaction_service_enabled(true),
 
     // [websockets]
@@ -54,11 +86,15 @@ settings::settings()
     zeromq_secure_heartbeat_endpoint("tcp://*:9082"),
     zeromq_secure_block_endpoint("tcp://*:9083"),
     zeromq_secure_transaction_endpoint("tcp://*:9084"),
+    zeromq_secure_compact_block_endpoint("tcp://*:9085"),
+    zeromq_secure_query_instances_endpoint("tcp://*:9101"),
 
     zeromq_public_query_endpoint("tcp://*:9091"),
     zeromq_public_heartbeat_endpoint("tcp://*:9092"),
     zeromq_public_block_endpoint("tcp://*:9093"),
-    zeromq_public_transaction_endpoint("tcp://*:9094")
+    zeromq_public_transaction_endpoint("tcp://*:9094"),
+    zeromq_public_compact_block_endpoint("tcp://*:9095"),
+    zeromq_public_query_instances_endpoint("tcp://*:9201")
 {
 }
 
@@ -78,6 +114,30 @@ duration settings::subscription_expiration() const
     return minutes(subscription_expiration_minutes);
 }
 
+// The ipc endpoint of a public service is a socket file in the ipc directory.
+config::endpoint settings::zeromq_ipc_endpoint(const std::string& name) const
+{
+    return { "ipc", (ipc_directory / (name + ".ipc")).string(), 0 };
+}
+
+// static
+// Services of different traffic profiles may each override the common
+// high water levels, their other socket settings are common.
+bc::protocol::settings settings::zeromq_tuned(
+    const bc::protocol::settings& common, uint32_t send_high_water,
+    uint32_t receive_high_water)
+{
+    auto tuned = common;
+
+    if (send_high_water != 0)
+        tuned.send_high_water = send_high_water;
+
+    if (receive_high_water != 0)
+        tuned.receive_high_water = receive_high_water;
+
+    return tuned;
+}
+
 const config::endpoint& settings::websockets_query_endpoint(bool secure) const
 {
     return secure ? websockets_secure_query_endpoint :
@@ -103,12 +163,40 @@ const config::endpoint& settings::websockets_transaction_endpoint(
         websockets_public_transaction_endpoint;
 }
 
+const config::endpoint& settings::websockets_compact_block_endpoint(
+    bool secure) const
+{
+    return secure ? websockets_secure_compact_block_endpoint :
+        websockets_public_compact_block_endpoint;
+}
+
+const config::endpoint& settings::websockets_compact_transaction_endpoint(
+    bool secure) const
+{
+    return secure ? websockets_secure_compact_transaction_endpoint :
+        websockets_public_compact_transaction_endpoint;
+}
+
 const config::endpoint& settings::zeromq_query_endpoint(bool secure) const
 {
     return secure ? zeromq_secure_query_endpoint :
         zeromq_public_query_endpoint;
 }
 
+// Instances after the first are bound to successive instances endpoint ports.
+config::endpoint settings::zeromq_query_endpoint(bool secure,
+    uint16_t instance) const
+{
+    if (instance == 0)
+        return zeromq_query_endpoint(secure);
+
+    const auto& base = secure ? zeromq_secure_query_instances_endpoint :
+        zeromq_public_query_instances_endpoint;
+
+    return config::endpoint(base.scheme(), base.host(),
+        static_cast<uint16_t>(base.port() + instance - 1));
+}
+
 const config::endpoint& settings::zeromq_heartbeat_endpoint(bool secure) const
 {
     return secure ? zeromq_secure_heartbeat_endpoint :
@@ -121,6 +209,13 @@ const config::endpoint& settings::zeromq_block_endpoint(bool secure) const
         zeromq_public_block_endpoint;
 }
 
+const config::endpoint& settings::zeromq_compact_block_endpoint(
+    bool secure) const
+{
+    return secure ? zeromq_secure_compact_block_endpoint :
+        zeromq_public_compact_block_endpoint;
+}
+
 const config::endpoint& settings::zeromq_transaction_endpoint(bool secure) const
 {
     return secure ? zeromq_secure_transaction_endpoint :
@@ -0,0 +1,84 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/batch_response.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/message.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::system;
+
+static constexpr size_t code_size = sizeof(uint32_t);
+static constexpr size_t length_size = sizeof(uint32_t);
+
+batch_response::batch_response(size_t count, const message& request,
+    send_handler handler)
+  : request_(request, data_chunk{}),
+    handler_(handler),
+    remaining_(count),
+    codes_(count),
+    results_(count)
+{
+    BITCOIN_ASSERT(count != 0);
+}
+
+void batch_response::set(size_t index, const code& ec, data_chunk&& data)
+{
+    codes_[index] = ec;
+    results_[index] = std::move(data);
+
+    if (--remaining_ == 0)
+        send();
+}
+
+void batch_response::send()
+{
+    size_t size = code_size + length_size;
+
+    for (const auto& result: results_)
+        size += code_size + length_size + result.size();
+
+    // [ code:4 ]
+    // [ count:4 ]
+    // [[ code:4 ][ size:4 ][ result... ]...]
+    data_chunk response(size);
+    auto serial = make_unsafe_serializer(response.begin());
+    serial.write_error_code(error::success);
+    serial.write_4_bytes_little_endian(static_cast<uint32_t>(results_.size()));
+
+    for (size_t index = 0; index < results_.size(); ++index)
+    {
+        const auto& result = results_[index];
+        const auto length = static_cast<uint32_t>(result.size());
+        serial.write_error_code(codes_[index]);
+        serial.write_4_bytes_little_endian(length);
+        serial.write_bytes(result);
+    }
+
+    handler_(message(request_, std::move(response)));
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,98 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/cached_socket.hpp>
+
+#include <memory>
+#include <bitcoin/protocol.hpp>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::protocol;
+using namespace bc::system;
+
+cached_socket::cached_socket(zmq::context& context, socket::role role,
+    const config::endpoint& endpoint, const protocol::settings& settings)
+  : role_(role),
+    endpoint_(endpoint),
+    settings_(settings),
+    context_(context),
+    stopped_(false)
+{
+}
+
+code cached_socket::send(handler handler)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    if (stopped_)
+        return error::service_stopped;
+
+    if (!socket_)
+    {
+        // Using shared pointer because sockets cannot be copied.
+        auto connection = std::make_shared<socket>(context_, role_, settings_);
+        const auto ec = connection->connect(endpoint_);
+
+        if (ec)
+        {
+            if (ec != error::service_stopped)
+                LOG_WARNING(LOG_SERVER)
+                    << "Failed to connect cached socket to " << endpoint_
+                    << " : " << ec.message();
+
+            return ec;
+        }
+
+        socket_ = connection;
+    }
+
+    const auto ec = handler(*socket_);
+
+    // Drop the socket on failure so that the next call reconnects.
+    if (ec)
+        socket_.reset();
+
+    return ec;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool cached_socket::stop()
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    stopped_ = true;
+
+    if (!socket_)
+        return true;
+
+    const auto result = socket_->stop();
+    socket_.reset();
+    return result;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,135 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/chain_tip.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <utility>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/message.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::system;
+using namespace bc::system::chain;
+
+static constexpr auto canonical = system::message::version::level::canonical;
+
+chain_tip::chain_tip()
+  : stamped_(),
+    height_(0),
+    hash_(null_hash)
+{
+}
+
+size_t chain_tip::height() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    return height_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+hash_digest chain_tip::hash() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    return hash_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool chain_tip::find(data_chunk& out, size_t height) const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    if (response_.empty() || height != height_)
+        return false;
+
+    out = response_;
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool chain_tip::find(data_chunk& out, const hash_digest& hash) const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    if (response_.empty() || hash != hash_)
+        return false;
+
+    out = response_;
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void chain_tip::set(size_t height, const hash_digest& hash)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    height_ = height;
+    hash_ = hash;
+    response_.clear();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void chain_tip::set(size_t height, const header& header)
+{
+    // Hashing and serialization are performed outside of the lock.
+    const auto hash = header.hash();
+    auto response = message::to_bytes(header, canonical);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    height_ = height;
+    hash_ = hash;
+    response_ = std::move(response);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// The first call is stale, as the tip is constructed unstamped.
+bool chain_tip::stale(clock::time_point now, clock::duration interval)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    if (stamped_ != clock::time_point() && now - stamped_ < interval)
+        return false;
+
+    stamped_ = now;
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,259 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/compressor.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/message.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::system;
+
+// These are defined by the lz4 block format.
+static constexpr size_t min_match = 4;
+static constexpr size_t last_literals = 5;
+static constexpr size_t match_limit = 12;
+static constexpr size_t max_offset = 65535;
+static constexpr uint8_t length_mask = 0x0f;
+
+static constexpr size_t size_prefix = sizeof(uint32_t);
+static constexpr size_t code_size = sizeof(uint32_t);
+static constexpr size_t hash_bits = 12;
+static const std::string compressed_suffix(".lz4");
+
+static inline uint32_t read_sequence(const uint8_t* data, size_t position)
+{
+    return from_little_endian_unsafe<uint32_t>(data + position);
+}
+
+static inline size_t to_slot(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - hash_bits);
+}
+
+// A length of at least 15 continues in bytes of 255 and a final remainder.
+static void write_length(data_chunk& out, size_t length)
+{
+    for (; length >= max_uint8; length -= max_uint8)
+        out.push_back(max_uint8);
+
+    out.push_back(static_cast<uint8_t>(length));
+}
+
+static bool read_length(size_t& out, const data_chunk& data, size_t& position)
+{
+    uint8_t byte;
+
+    do
+    {
+        if (position >= data.size())
+            return false;
+
+        byte = data[position++];
+        out += byte;
+    } while (byte == max_uint8);
+
+    return true;
+}
+
+// [ token:1 ][ literal length... ][ literals... ][ offset:2 ][ match... ]
+static void write_sequence(data_chunk& out, const uint8_t* data,
+    size_t anchor, size_t literals, size_t offset, size_t match)
+{
+    const auto extra = match - min_match;
+    const auto token = static_cast<uint8_t>(
+        (std::min(literals, size_t(length_mask)) << 4) |
+        std::min(extra, size_t(length_mask)));
+
+    out.push_back(token);
+
+    if (literals >= length_mask)
+        write_length(out, literals - length_mask);
+
+    out.insert(out.end(), data + anchor, data + anchor + literals);
+    out.push_back(static_cast<uint8_t>(offset));
+    out.push_back(static_cast<uint8_t>(offset >> 8));
+
+    if (extra >= length_mask)
+        write_length(out, extra - length_mask);
+}
+
+// The last sequence is literals only, without offset.
+static void write_literals(data_chunk& out, const uint8_t* data,
+    size_t size, size_t anchor)
+{
+    const auto literals = size - anchor;
+    out.push_back(static_cast<uint8_t>(
+        std::min(literals, size_t(length_mask)) << 4));
+
+    if (literals >= length_mask)
+        write_length(out, literals - length_mask);
+
+    out.insert(out.end(), data + anchor, data + size);
+}
+
+// Greedy single pass, each position is matched against the last position
+// of the same four byte hash.
+static void compress_to(data_chunk& out, const uint8_t* data, size_t size)
+{
+    BITCOIN_ASSERT(size <= max_uint32);
+    out.reserve(out.size() + size_prefix + size + size / max_uint8 + 16);
+    extend_data(out, to_little_endian(static_cast<uint32_t>(size)));
+
+    // Positions are offset by one, so that zero is an empty slot.
+    std::vector<uint32_t> table(size_t(1) << hash_bits, 0);
+    size_t anchor = 0;
+    size_t position = 0;
+
+    // A match may not start within the last 12 bytes, or end within the
+    // last 5, which are always literals.
+    while (size >= match_limit && position <= size - match_limit)
+    {
+        const auto sequence = read_sequence(data, position);
+        auto& slot = table[to_slot(sequence)];
+        const size_t candidate = slot;
+        slot = static_cast<uint32_t>(position + 1);
+
+        if (candidate == 0 || position - (candidate - 1) > max_offset ||
+            read_sequence(data, candidate - 1) != sequence)
+        {
+            ++position;
+            continue;
+        }
+
+        const auto match = candidate - 1;
+        auto length = min_match;
+
+        while (position + length < size - last_literals &&
+            data[match + length] == data[position + length])
+            ++length;
+
+        write_sequence(out, data, anchor, position - anchor,
+            position - match, length);
+
+        position += length;
+        anchor = position;
+    }
+
+    write_literals(out, data, size, anchor);
+}
+
+data_chunk compressor::compress(const data_chunk& data)
+{
+    data_chunk out;
+    compress_to(out, data.data(), data.size());
+    return out;
+}
+
+bool compressor::decompress(data_chunk& out, const data_chunk& data)
+{
+    if (data.size() < size_prefix)
+        return false;
+
+    const size_t size = from_little_endian_unsafe<uint32_t>(data.begin());
+    auto position = size_prefix;
+    out.clear();
+    out.reserve(size);
+
+    while (position < data.size())
+    {
+        const auto token = data[position++];
+        size_t literals = token >> 4;
+
+        if (literals == length_mask && !read_length(literals, data, position))
+            return false;
+
+        if (literals > data.size() - position ||
+            literals > size - out.size())
+            return false;
+
+        const auto begin = data.begin() + position;
+        out.insert(out.end(), begin, begin + literals);
+        position += literals;
+
+        // The last sequence has no match.
+        if (position == data.size())
+            break;
+
+        if (data.size() - position < sizeof(uint16_t))
+            return false;
+
+        const size_t offset = data[position] | (data[position + 1] << 8);
+        position += sizeof(uint16_t);
+        size_t match = token & length_mask;
+
+        if (match == length_mask && !read_length(match, data, position))
+            return false;
+
+        match += min_match;
+
+        if (offset == 0 || offset > out.size() || match > size - out.size())
+            return false;
+
+        // The match may overlap its own output, so it is copied bytewise.
+        const auto from = out.size() - offset;
+        for (size_t index = 0; index < match; ++index)
+        {
+            const auto byte = out[from + index];
+            out.push_back(byte);
+        }
+    }
+
+    return out.size() == size;
+}
+
+data_chunk compressor::compress_response(const data_chunk& payload)
+{
+    // An error response is only its code, which is not compressed.
+    if (payload.size() <= code_size)
+        return payload;
+
+    data_chunk out(payload.begin(), payload.begin() + code_size);
+    compress_to(out, payload.data() + code_size, payload.size() - code_size);
+    return out;
+}
+
+bool compressor::is_compressed(const std::string& command)
+{
+    return command.size() > compressed_suffix.size() &&
+        command.compare(command.size() - compressed_suffix.size(),
+            compressed_suffix.size(), compressed_suffix) == 0;
+}
+
+// The response command is that of its request, so this is the compressed
+// version of the command if its response is to be compressed.
+message compressor::compress_response(message&& response)
+{
+    if (response.compressed() || !is_compressed(response.command()))
+        return std::move(response);
+
+    message outgoing(response, compress_response(response.data()));
+    outgoing.set_compressed();
+    return outgoing;
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,218 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/filter_cache.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::system;
+
+const uint8_t filter_cache::filter_type = 0;
+const size_t filter_cache::checkpoint_interval = 1000;
+
+filter_cache::filter_cache(bool enabled)
+  : enabled_(enabled),
+    generation_(0)
+{
+}
+
+size_t filter_cache::generation() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    return generation_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+size_t filter_cache::size() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    return entries_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool filter_cache::read(system::message::compact_filter_headers& out,
+    uint8_t type, size_t start_height, size_t stop_height) const
+{
+    if (type != filter_type || start_height > stop_height)
+        return false;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    if (stop_height >= entries_.size())
+        return false;
+
+    read(out, start_height, stop_height);
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool filter_cache::read(system::message::compact_filter_headers& out,
+    uint8_t type, size_t start_height, const hash_digest& stop_hash) const
+{
+    if (type != filter_type)
+        return false;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    size_t stop_height;
+
+    if (!find(stop_height, stop_hash) || start_height > stop_height)
+        return false;
+
+    read(out, start_height, stop_height);
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// The checkpoint headers are at each full interval up to the stop height.
+bool filter_cache::read(system::message::compact_filter_checkpoint& out,
+    uint8_t type, const hash_digest& stop_hash) const
+{
+    if (type != filter_type)
+        return false;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    size_t stop_height;
+
+    if (!find(stop_height, stop_hash))
+        return false;
+
+    hash_list headers;
+    headers.reserve(stop_height / checkpoint_interval);
+
+    for (auto height = checkpoint_interval; height <= stop_height;
+        height += checkpoint_interval)
+        headers.push_back(entries_[height].filter_header);
+
+    out = system::message::compact_filter_checkpoint(filter_type, stop_hash,
+        headers);
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+bool filter_cache::find(size_t& out, const hash_digest& block_hash) const
+{
+    const auto it = heights_.find(block_hash);
+
+    if (it == heights_.end())
+        return false;
+
+    out = it->second;
+    return true;
+}
+
+// private
+void filter_cache::read(system::message::compact_filter_headers& out,
+    size_t start_height, size_t stop_height) const
+{
+    hash_list hashes;
+    hashes.reserve(stop_height - start_height + 1);
+
+    for (auto height = start_height; height <= stop_height; ++height)
+        hashes.push_back(entries_[height].filter_hash);
+
+    const auto& previous = start_height == 0 ? null_hash :
+        entries_[start_height - 1].filter_header;
+
+    out = system::message::compact_filter_headers(filter_type,
+        entries_[stop_height].block_hash, previous, hashes);
+}
+
+void filter_cache::write(size_t height, const filters& filters,
+    size_t generation)
+{
+    if (!enabled_ || filters.empty() ||
+        filters.front()->filter_type() != filter_type)
+        return;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    // The filters may predate a reorganization, and must be contiguous.
+    if (generation != generation_ || height > entries_.size())
+        return;
+
+    // Each filter header commits to the filter and to the previous header.
+    for (auto it = filters.begin() + std::min(entries_.size() - height,
+        filters.size()); it != filters.end(); ++it)
+    {
+        const auto& filter = *it;
+        const auto& previous = entries_.empty() ? null_hash :
+            entries_.back().filter_header;
+        const auto filter_hash = bitcoin_hash(filter->filter());
+        const auto filter_header = bitcoin_hash(build_chunk(
+        {
+            filter_hash,
+            previous
+        }));
+
+        heights_[filter->block_hash()] = entries_.size();
+        entries_.push_back({ filter->block_hash(), filter_hash,
+            filter_header });
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void filter_cache::reorganize(size_t fork_height, bool popped)
+{
+    if (!enabled_)
+        return;
+
+    const auto first = fork_height + 1;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    if (popped)
+        ++generation_;
+
+    // Filters above the fork point are dropped, incoming blocks are not
+    // appended as their filters are not yet read.
+    while (entries_.size() > first)
+    {
+        heights_.erase(entries_.back().block_hash);
+        entries_.pop_back();
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,117 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/filter_range.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/message.hpp>
+#include <bitcoin/server/utility/filter_cache.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::system;
+
+static constexpr size_t code_size = sizeof(uint32_t);
+static constexpr auto canonical = system::message::version::level::canonical;
+
+// Filters are streamed in bounded responses.
+static constexpr size_t filters_chunk = 100;
+
+filter_range::filter_range(filter_cache& cache, size_t generation,
+    size_t height, size_t count, const message& request,
+    send_handler handler)
+  : cache_(cache),
+    generation_(generation),
+    height_(height),
+    request_(request, data_chunk{}),
+    handler_(handler),
+    remaining_(count),
+    filters_(count),
+    codes_(count)
+{
+    BITCOIN_ASSERT(count != 0);
+}
+
+void filter_range::set(size_t index, const code& ec,
+    compact_filter_ptr filter)
+{
+    codes_[index] = ec;
+
+    // Filters are written to disjoint slots of the preallocated list.
+    if (!ec)
+        filters_[index] = filter;
+
+    if (--remaining_ == 0)
+        send();
+}
+
+void filter_range::send()
+{
+    // The range ends at the first failed lookup (generally the top).
+    const auto failed = std::find_if(codes_.begin(), codes_.end(),
+        [](const code& ec) { return bool(ec); });
+    const auto fetched = static_cast<size_t>(
+        std::distance(codes_.begin(), failed));
+
+    // An empty range returns the error of its first lookup.
+    if (fetched == 0)
+    {
+        handler_(message(request_, codes_.front()));
+        return;
+    }
+
+    filters_.resize(fetched);
+    cache_.write(height_, filters_, generation_);
+
+    size_t index = 0;
+
+    do
+    {
+        const auto count = std::min(filters_chunk, fetched - index);
+        const auto last = (index + count == fetched);
+        const auto end = filters_.begin() + index + count;
+        size_t size = code_size + sizeof(uint8_t);
+
+        for (auto it = filters_.begin() + index; it != end; ++it)
+            size += (*it)->serialized_size(canonical);
+
+        // [ code:4 ]
+        // [ last:1 ] (of this range)
+        // [ compact filter... ]
+        data_chunk result(size);
+        auto serial = make_unsafe_serializer(result.begin());
+        serial.write_error_code(error::success);
+        serial.write_byte(last ? 1 : 0);
+
+        for (auto it = filters_.begin() + index; it != end; ++it)
+            (*it)->to_data(canonical, serial);
+
+        handler_(message(request_, std::move(result)));
+        index += count;
+    } while (index < fetched);
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,128 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/header_cache.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::system;
+
+static constexpr auto canonical = system::message::version::level::canonical;
+
+const size_t header_cache::header_size = chain::header::satoshi_fixed_size();
+
+header_cache::header_cache(bool enabled)
+  : enabled_(enabled),
+    generation_(0)
+{
+}
+
+size_t header_cache::generation() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    return generation_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+size_t header_cache::size() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    return headers_.size() / header_size;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+size_t header_cache::read(data_chunk& out, size_t height, size_t count) const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    const auto top = headers_.size() / header_size;
+
+    if (height >= top)
+        return 0;
+
+    const auto available = std::min(count, top - height);
+    const auto begin = headers_.begin() + height * header_size;
+    out.insert(out.end(), begin, begin + available * header_size);
+    return available;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void header_cache::write(size_t height, const data_chunk& headers,
+    size_t generation)
+{
+    if (!enabled_ || headers.empty())
+        return;
+
+    BITCOIN_ASSERT(headers.size() % header_size == 0);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    // The headers may predate a reorganization, and must be contiguous.
+    if (generation != generation_ || height != headers_.size() / header_size)
+        return;
+
+    extend_data(headers_, headers);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void header_cache::reorganize(size_t fork_height,
+    const block_const_ptr_list& incoming, bool popped)
+{
+    if (!enabled_)
+        return;
+
+    const auto first = fork_height + 1;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    if (popped)
+        ++generation_;
+
+    // Headers above the fork point are replaced by the incoming blocks.
+    if (headers_.size() > first * header_size)
+        headers_.resize(first * header_size);
+
+    // Incoming blocks are only appended if they extend the array.
+    if (headers_.size() != first * header_size)
+        return;
+
+    for (const auto block: incoming)
+        extend_data(headers_, block->header().to_data(canonical));
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace server
+} // namespace libbitcoin
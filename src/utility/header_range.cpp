@@ -0,0 +1,97 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/header_range.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/message.hpp>
+#include <bitcoin/server/utility/header_cache.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::system;
+
+static constexpr size_t code_size = sizeof(uint32_t);
+static constexpr auto canonical = system::message::version::level::canonical;
+
+header_range::header_range(header_cache& cache, size_t generation,
+    size_t height, size_t count, data_chunk&& prefix, const message& request,
+    send_handler handler)
+  : cache_(cache),
+    generation_(generation),
+    height_(height),
+    request_(request, data_chunk{}),
+    handler_(handler),
+    remaining_(count),
+    prefix_(std::move(prefix)),
+    headers_(count * header_cache::header_size),
+    codes_(count)
+{
+    BITCOIN_ASSERT(count != 0);
+    BITCOIN_ASSERT(prefix_.size() >= code_size);
+}
+
+void header_range::set(size_t index, const code& ec,
+    header_const_ptr header)
+{
+    codes_[index] = ec;
+
+    // Headers are written to disjoint slots of the preallocated buffer.
+    if (!ec)
+    {
+        auto serial = make_unsafe_serializer(headers_.begin() +
+            index * header_cache::header_size);
+        header->to_data(canonical, serial);
+    }
+
+    if (--remaining_ == 0)
+        send();
+}
+
+void header_range::send()
+{
+    // The range ends at the first failed lookup (generally the top).
+    const auto failed = std::find_if(codes_.begin(), codes_.end(),
+        [](const code& ec) { return bool(ec); });
+    const auto fetched = static_cast<size_t>(
+        std::distance(codes_.begin(), failed));
+
+    // An empty range returns the error of its first lookup.
+    if (fetched == 0 && prefix_.size() == code_size)
+    {
+        handler_(message(request_, codes_.front()));
+        return;
+    }
+
+    headers_.resize(fetched * header_cache::header_size);
+    cache_.write(height_, headers_, generation_);
+
+    // [ code:4 ]
+    // [[ header:80 ]...]
+    extend_data(prefix_, headers_);
+    handler_(message(request_, std::move(prefix_)));
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,171 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/history_cache.hpp>
+
+#include <cstddef>
+#include <cstring>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::system;
+using namespace bc::system::chain;
+
+history_cache::history_cache(size_t capacity)
+  : capacity_(capacity),
+    size_(0),
+    sequence_(0)
+{
+    dropped_.fill(0);
+}
+
+// Keys are script hashes, so any bytes select a uniform slot.
+size_t history_cache::slot(const hash_digest& key)
+{
+    uint32_t value;
+    std::memcpy(&value, key.data(), sizeof(value));
+    return value % slot_count;
+}
+
+size_t history_cache::size(const payment_record::list& records)
+{
+    static const auto record_size = payment_record::satoshi_fixed_size(true);
+    return records.size() * record_size;
+}
+
+bool history_cache::enabled() const
+{
+    return capacity_ != 0;
+}
+
+size_t history_cache::sequence() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    return sequence_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool history_cache::find(payment_record::list& out, const hash_digest& key,
+    size_t from_height)
+{
+    if (capacity_ == 0)
+        return false;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    const auto it = index_.find(key);
+
+    if (it == index_.end())
+        return false;
+
+    // Move the hit to the front, the least recently used is at the back.
+    entries_.splice(entries_.begin(), entries_, it->second);
+
+    // Unconfirmed records have the height sentinel of max_uint32.
+    for (const auto& record: it->second->records)
+        if (record.height() >= from_height)
+            out.push_back(record);
+
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void history_cache::store(const hash_digest& key, size_t sequence,
+    const payment_record::list& records)
+{
+    const auto bytes = size(records);
+
+    // A history larger than the cache would evict all others, so skip it.
+    if (capacity_ == 0 || bytes > capacity_)
+        return;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    // The history may predate a drop of its key, so it must be discarded.
+    if (dropped_[slot(key)] > sequence || index_.count(key) != 0)
+        return;
+
+    entries_.push_front({ key, records });
+    index_.emplace(key, entries_.begin());
+    size_ += bytes;
+
+    while (size_ > capacity_)
+    {
+        const auto& last = entries_.back();
+        size_ -= size(last.records);
+        index_.erase(last.key);
+        entries_.pop_back();
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void history_cache::drop(const hash_list& keys)
+{
+    if (capacity_ == 0 || keys.empty())
+        return;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    ++sequence_;
+
+    for (const auto& key: keys)
+    {
+        dropped_[slot(key)] = sequence_;
+        const auto it = index_.find(key);
+
+        if (it == index_.end())
+            continue;
+
+        size_ -= size(it->second->records);
+        entries_.erase(it->second);
+        index_.erase(it);
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+hash_list history_cache::keys() const
+{
+    hash_list out;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    out.reserve(entries_.size());
+
+    for (const auto& entry: entries_)
+        out.push_back(entry.key);
+
+    return out;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace server
+} // namespace libbitcoin
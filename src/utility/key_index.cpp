@@ -0,0 +1,328 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/key_index.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/route.hpp>
+#include <bitcoin/server/messages/subscription.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::system;
+
+static constexpr uint64_t max_address_size = 255;
+
+key_index::key_index(size_t limit)
+  : limit_(limit),
+    size_(0)
+{
+}
+
+bool key_index::empty() const
+{
+    return size_ == 0;
+}
+
+size_t key_index::size() const
+{
+    return size_;
+}
+
+time_t key_index::bucket(time_t time)
+{
+    return time / bucket_seconds;
+}
+
+key_index::shard& key_index::select(const hash_digest& key)
+{
+    return shards_[key.front() % shard_count];
+}
+
+const key_index::shard& key_index::select(const hash_digest& key) const
+{
+    return shards_[key.front() % shard_count];
+}
+
+code key_index::subscribe(const hash_digest& key, const route& route,
+    uint32_t id, time_t now, bool batched, bool transactions)
+{
+    auto& shard = select(key);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(shard.mutex);
+
+    auto& list = shard.subscriptions[key];
+
+    // A change to the id is not considered (caller should not change).
+    const auto it = subscription::find(list, route);
+
+    if (it != list.end())
+    {
+        (*it)->set_updated(now);
+    }
+    else
+    {
+        // Reserve a slot across shards, the limit is not exceeded.
+        if (++size_ > limit_)
+        {
+            --size_;
+
+            if (list.empty())
+                shard.subscriptions.erase(key);
+
+            return error::oversubscribed;
+        }
+
+        list.push_back(std::make_shared<const subscription>(route, id, now,
+            batched, transactions));
+    }
+
+    // The key may also remain in prior buckets, which purge skips.
+    shard.wheel[bucket(now)].insert(key);
+    return error::success;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void key_index::unsubscribe(const hash_digest& key, const route& route)
+{
+    auto& shard = select(key);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(shard.mutex);
+
+    // The key is removed from the wheel lazily, by purge.
+    const auto entry = shard.subscriptions.find(key);
+
+    if (entry == shard.subscriptions.end())
+        return;
+
+    auto& list = entry->second;
+    const auto it = subscription::find(list, route);
+
+    if (it == list.end())
+        return;
+
+    list.erase(it);
+    --size_;
+
+    if (list.empty())
+        shard.subscriptions.erase(entry);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void key_index::match(list& out, const hash_digest& key) const
+{
+    const auto& shard = select(key);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(shard.mutex);
+
+    const auto entry = shard.subscriptions.find(key);
+
+    if (entry == shard.subscriptions.end())
+        return;
+
+    out.insert(out.end(), entry->second.begin(), entry->second.end());
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+std::chrono::microseconds key_index::purge(list& out, time_t cutoff,
+    size_t batch)
+{
+    typedef std::chrono::steady_clock clock;
+    std::chrono::microseconds longest(0);
+    const auto start = out.size();
+
+    for (auto& shard: shards_)
+    {
+        auto complete = false;
+
+        while (!complete)
+        {
+            ///////////////////////////////////////////////////////////////////
+            // Critical Section
+            unique_lock lock(shard.mutex);
+            const auto locked = clock::now();
+
+            complete = purge(shard, out, cutoff, batch);
+
+            const auto held = clock::now() - locked;
+            lock.unlock();
+            ///////////////////////////////////////////////////////////////////
+
+            longest = std::max(longest,
+                std::chrono::duration_cast<std::chrono::microseconds>(held));
+        }
+    }
+
+    size_ -= (out.size() - start);
+    return longest;
+}
+
+// Purge up to batch keys from expired buckets, true if none remain.
+// Every subscription in an expired bucket was updated before cutoff, unless
+// since renewed (and therefore also in a later bucket).
+bool key_index::purge(shard& shard, list& out, time_t cutoff, size_t batch)
+{
+    const auto expired = bucket(cutoff);
+    auto& wheel = shard.wheel;
+    size_t visited = 0;
+
+    while (!wheel.empty() && wheel.begin()->first < expired)
+    {
+        auto& keys = wheel.begin()->second;
+
+        while (!keys.empty())
+        {
+            if (batch != 0 && visited == batch)
+                return false;
+
+            ++visited;
+
+            const auto key = keys.begin();
+            const auto entry = shard.subscriptions.find(*key);
+            keys.erase(key);
+
+            if (entry == shard.subscriptions.end())
+                continue;
+
+            auto& list = entry->second;
+            auto end = list.end();
+
+            for (auto it = list.begin(); it != end;)
+            {
+                if ((*it)->updated() < cutoff)
+                {
+                    out.push_back(*it);
+                    *it = std::move(*(--end));
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+
+            list.erase(end, list.end());
+
+            if (list.empty())
+                shard.subscriptions.erase(entry);
+        }
+
+        wheel.erase(wheel.begin());
+    }
+
+    return true;
+}
+
+// [ count:4 ]
+// [[ key:32 ][ delimited:1 ][ instance:2 ][ address:var ][ id:4 ]
+//  [ updated:8 ][ batched:1 ][ transactions:1 ]...]
+size_t key_index::save(writer& sink) const
+{
+    std::vector<std::pair<hash_digest, list>> entries;
+
+    for (const auto& shard: shards_)
+    {
+        ///////////////////////////////////////////////////////////////////////
+        // Critical Section
+        shared_lock lock(shard.mutex);
+
+        for (const auto& subscribed: shard.subscriptions)
+            entries.push_back(subscribed);
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    size_t count = 0;
+    for (const auto& entry: entries)
+        count += entry.second.size();
+
+    sink.write_4_bytes_little_endian(static_cast<uint32_t>(count));
+
+    for (const auto& entry: entries)
+    {
+        for (const auto& item: entry.second)
+        {
+            const auto& address = item->address();
+            sink.write_hash(entry.first);
+            sink.write_byte(item->delimited() ? 1 : 0);
+            sink.write_2_bytes_little_endian(item->instance());
+            sink.write_variable_little_endian(address.size());
+            sink.write_bytes(address);
+            sink.write_4_bytes_little_endian(item->id());
+            sink.write_8_bytes_little_endian(
+                static_cast<uint64_t>(item->updated()));
+            sink.write_byte(item->batched() ? 1 : 0);
+            sink.write_byte(item->transactions() ? 1 : 0);
+        }
+    }
+
+    return count;
+}
+
+size_t key_index::load(reader& source, time_t cutoff)
+{
+    size_t loaded = 0;
+    const size_t count = source.read_4_bytes_little_endian();
+
+    for (size_t index = 0; index < count && source; ++index)
+    {
+        route saved;
+        const auto key = source.read_hash();
+        saved.set_delimited(source.read_byte() != 0);
+        saved.set_instance(source.read_2_bytes_little_endian());
+        const auto size = source.read_variable_little_endian();
+
+        // A corrupt size must not allocate, zeromq limits routing ids.
+        if (size > max_address_size)
+            break;
+
+        saved.set_address(source.read_bytes(size));
+        const auto id = source.read_4_bytes_little_endian();
+        const auto updated = static_cast<time_t>(
+            source.read_8_bytes_little_endian());
+        const auto batched = source.read_byte() != 0;
+        const auto transactions = source.read_byte() != 0;
+
+        // A truncated snapshot loads only its complete subscriptions.
+        if (!source || updated < cutoff)
+            continue;
+
+        if (subscribe(key, saved, id, updated, batched, transactions))
+            break;
+
+        ++loaded;
+    }
+
+    return loaded;
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/payment_keys.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::system;
+using namespace bc::system::chain;
+
+hash_list payment_keys::extract(const transaction& tx)
+{
+    const auto& inputs = tx.inputs();
+    const auto& outputs = tx.outputs();
+
+    // The end offset of each script within the buffer.
+    std::vector<size_t> ends;
+    ends.reserve(inputs.size() + outputs.size());
+    size_t size = 0;
+
+    for (const auto& input: inputs)
+        ends.push_back(size += input.script().serialized_size(false));
+
+    for (const auto& output: outputs)
+        ends.push_back(size += output.script().serialized_size(false));
+
+    data_chunk buffer;
+    buffer.reserve(size);
+
+    // The stream is flushed on destruct, before the scripts are hashed.
+    {
+        data_sink ostream(buffer);
+
+        for (const auto& input: inputs)
+            input.script().to_data(ostream, false);
+
+        for (const auto& output: outputs)
+            output.script().to_data(ostream, false);
+    }
+
+    hash_list out;
+    out.reserve(ends.size());
+    size_t begin = 0;
+
+    for (const auto end: ends)
+    {
+        out.push_back(sha256_hash(data_slice(buffer.data() + begin,
+            buffer.data() + end)));
+        begin = end;
+    }
+
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return out;
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,190 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/publication.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <bitcoin/protocol.hpp>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/utility/compressor.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::protocol;
+using namespace bc::system;
+
+static constexpr auto canonical = message::version::level::canonical;
+
+// A rendering for each of the secure and public sockets, in each encoding.
+static constexpr size_t renderings = 4;
+
+publication::publication(block_const_ptr block, size_t height)
+  : block_(block),
+    transaction_(nullptr),
+    height_(height),
+    hash_(block->hash()),
+    data_(block->to_data(canonical)),
+    compressed_(nullptr)
+{
+}
+
+publication::publication(transaction_const_ptr tx)
+  : block_(nullptr),
+    transaction_(tx),
+    height_(0),
+    hash_(tx->hash()),
+    data_(tx->to_data(canonical)),
+    compressed_(nullptr)
+{
+}
+
+size_t publication::height() const
+{
+    return height_;
+}
+
+const hash_digest& publication::hash() const
+{
+    return hash_;
+}
+
+const data_chunk& publication::data() const
+{
+    return data_;
+}
+
+// The compression is retained until destruction, so the reference is safe.
+const data_chunk& publication::compressed() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    mutex_.lock_upgrade();
+
+    if (compressed_)
+    {
+        const auto& compressed = *compressed_;
+        mutex_.unlock_upgrade();
+        //---------------------------------------------------------------------
+        return compressed;
+    }
+
+    mutex_.unlock_upgrade_and_lock();
+    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+    // Another service may have compressed it while this awaited the lock.
+    if (!compressed_)
+        compressed_ = std::make_shared<const data_chunk>(
+            compressor::compress(data_));
+
+    const auto& compressed = *compressed_;
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    return compressed;
+}
+
+transaction_const_ptr publication::transaction() const
+{
+    return transaction_;
+}
+
+// [ header:80 ]
+// [[ tx hash:32 ]...]
+// Transaction hashes are cached on the block, so this does not rehash.
+data_chunk publication::compact() const
+{
+    if (!block_)
+        return {};
+
+    const auto& txs = block_->transactions();
+    data_chunk out;
+    out.reserve(chain::header::satoshi_fixed_size() + txs.size() * hash_size);
+    extend_data(out, block_->header().to_data(true));
+
+    for (const auto& tx: txs)
+        extend_data(out, tx.hash());
+
+    return out;
+}
+
+bool publication::matches(const data_chunk& data) const
+{
+    return data.size() == data_.size() &&
+        std::equal(data.begin(), data.end(), data_.begin());
+}
+
+// {"height":H,"sequence":S,"block":"base16"}
+// {"sequence":S,"transaction":"base16"}
+std::string publication::to_compact_json(uint16_t sequence) const
+{
+    const auto prefix = block_ ?
+        "{\"height\":" + std::to_string(height_) + ",\"sequence\":" +
+            std::to_string(sequence) + ",\"block\":\"" :
+        "{\"sequence\":" + std::to_string(sequence) +
+            ",\"transaction\":\"";
+
+    return prefix + encode_base16(data_) + "\"}";
+}
+
+publication::json_ptr publication::json(uint16_t sequence, bool compact) const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    mutex_.lock_upgrade();
+
+    for (const auto& item: renderings_)
+    {
+        if (item.sequence == sequence && item.compact == compact)
+        {
+            const auto json = item.json;
+            mutex_.unlock_upgrade();
+            //-----------------------------------------------------------------
+            return json;
+        }
+    }
+
+    mutex_.unlock_upgrade_and_lock();
+    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+    // Rendering is from the native object, so there is no parse of the data.
+    // The compact rendering is of the canonical serialization.
+    const auto json = std::make_shared<const std::string>(compact ?
+        to_compact_json(sequence) : block_ ?
+        http::to_json(*block_, static_cast<uint32_t>(height_), sequence) :
+        http::to_json(*transaction_, sequence));
+
+    // The oldest rendering is replaced, as each socket uses one sequence.
+    if (renderings_.size() == renderings)
+        renderings_.erase(renderings_.begin());
+
+    renderings_.push_back({ sequence, compact, json });
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    return json;
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,323 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/publisher.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <utility>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/server_node.hpp>
+#include <bitcoin/server/utility/publication.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace std::placeholders;
+using namespace bc::system;
+
+// Websockets subscribe to the local public services and so receive each
+// publication immediately, only the most recent need to be retained.
+static constexpr size_t retained_blocks = 4;
+static constexpr size_t retained_transactions = 64;
+
+publisher::publisher(server_node& node)
+  : node_(node),
+    published_blocks_(0),
+    published_transactions_(0)
+{
+}
+
+// Services may be stopped once the pipeline has stopped.
+void publisher::stop()
+{
+    queue_.stop();
+}
+
+// Subscription.
+// ----------------------------------------------------------------------------
+
+// There is no unsubscribe, handlers are registered by services on start.
+void publisher::subscribe_blocks(block_handler&& handler)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    if (block_handlers_.empty())
+    {
+        queue_.start();
+        node_.subscribe_blocks(
+            std::bind(&publisher::handle_reorganization,
+                this, _1, _2, _3, _4));
+    }
+
+    block_handlers_.push_back(std::move(handler));
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// There is no unsubscribe, handlers are registered by services on start.
+void publisher::subscribe_transactions(transaction_handler&& handler)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    if (transaction_handlers_.empty())
+        node_.subscribe_transactions(
+            std::bind(&publisher::handle_transaction,
+                this, _1, _2));
+
+    transaction_handlers_.push_back(std::move(handler));
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Retrieval.
+// ----------------------------------------------------------------------------
+
+uint64_t publisher::published_blocks() const
+{
+    return published_blocks_;
+}
+
+uint64_t publisher::published_transactions() const
+{
+    return published_transactions_;
+}
+
+publication::ptr publisher::find_block(const data_chunk& data) const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    return find(blocks_, data);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+publication::ptr publisher::find_transaction(const data_chunk& data) const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    return find(transactions_, data);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// A publication evicted before all websockets have rendered it is parsed once
+// and retained again, so that the remaining websockets share its rendering.
+publication::ptr publisher::restore_block(const data_chunk& data,
+    size_t height)
+{
+    const auto found = find_block(data);
+
+    if (found)
+        return found;
+
+    const auto block = std::make_shared<const system::message::block>(
+        chain::block::factory(data, true));
+
+    if (!block->is_valid())
+        return nullptr;
+
+    return restore(blocks_, std::make_shared<const publication>(block,
+        height), retained_blocks);
+}
+
+publication::ptr publisher::restore_transaction(const data_chunk& data)
+{
+    const auto found = find_transaction(data);
+
+    if (found)
+        return found;
+
+    const auto tx = std::make_shared<const system::message::transaction>(
+        chain::transaction::factory(data, true, true));
+
+    if (!tx->is_valid())
+        return nullptr;
+
+    return restore(transactions_, std::make_shared<const publication>(tx),
+        retained_transactions);
+}
+
+// Another websocket may have restored the same publication while parsing.
+publication::ptr publisher::restore(publications& recent,
+    publication::ptr item, size_t limit)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    const auto found = find(recent, item->data());
+
+    if (found)
+        return found;
+
+    retain(recent, item, limit);
+    return item;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Search from the most recent, which is the expected match.
+publication::ptr publisher::find(const publications& recent,
+    const data_chunk& data)
+{
+    for (auto it = recent.rbegin(); it != recent.rend(); ++it)
+        if ((*it)->matches(data))
+            return *it;
+
+    return nullptr;
+}
+
+void publisher::retain(publications& recent, publication::ptr item,
+    size_t limit)
+{
+    recent.push_back(item);
+
+    while (recent.size() > limit)
+        recent.pop_front();
+}
+
+// Publication (via blockchain).
+// ----------------------------------------------------------------------------
+
+bool publisher::handle_reorganization(const code& ec, size_t fork_height,
+    block_const_ptr_list_const_ptr incoming, block_const_ptr_list_const_ptr)
+{
+    if (ec == error::service_stopped)
+        return false;
+
+    if (ec)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failure handling new block: " << ec.message();
+
+        // Don't let a failure here prevent future notifications.
+        return true;
+    }
+
+    // Nothing to do here, a channel is stopping.
+    if (!incoming || incoming->empty())
+        return true;
+
+    // Do not announce blocks to clients if too far behind.
+    if (node_.chain().is_blocks_stale())
+        return true;
+
+    // Publication is pipelined off the reorganization thread, in order.
+    queue_.push(std::bind(&publisher::publish_blocks,
+        this, fork_height, incoming));
+
+    return true;
+}
+
+// Serialize each block once for all services, serializing the next block
+// while the services send the current one. A reorganization is published
+// block by block, so that sending begins with the first serialization.
+void publisher::publish_blocks(size_t fork_height,
+    block_const_ptr_list_const_ptr incoming)
+{
+    const auto& blocks = *incoming;
+    const auto serialize = [](block_const_ptr block, size_t height)
+    {
+        return std::make_shared<const publication>(block, height);
+    };
+
+    auto height = fork_height;
+    auto next = std::async(std::launch::deferred, serialize,
+        blocks.front(), ++height);
+
+    for (size_t index = 0; index < blocks.size(); ++index)
+    {
+        const publication::list current{ next.get() };
+
+        if (index + 1 < blocks.size())
+            next = std::async(std::launch::async, serialize,
+                blocks[index + 1], ++height);
+
+        ///////////////////////////////////////////////////////////////////////
+        // Critical Section
+        mutex_.lock();
+
+        retain(blocks_, current.front(), retained_blocks);
+        const auto handlers = block_handlers_;
+
+        mutex_.unlock();
+        ///////////////////////////////////////////////////////////////////////
+
+        // Services are notified in order of registration.
+        for (const auto& handler: handlers)
+            handler(current);
+
+        ++published_blocks_;
+    }
+}
+
+// Publication (via transaction pool).
+// ----------------------------------------------------------------------------
+
+bool publisher::handle_transaction(const code& ec, transaction_const_ptr tx)
+{
+    if (ec == error::service_stopped)
+        return false;
+
+    if (ec)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failure handling new transaction: " << ec.message();
+
+        // Don't let a failure here prevent future notifications.
+        return true;
+    }
+
+    // Nothing to do here, a channel is stopping.
+    if (!tx)
+        return true;
+
+    // Do not announce txs to clients if too far behind.
+    if (node_.chain().is_blocks_stale())
+        return true;
+
+    // Serialize the transaction once for all services.
+    const auto transaction = std::make_shared<const publication>(tx);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    mutex_.lock();
+
+    retain(transactions_, transaction, retained_transactions);
+    const auto handlers = transaction_handlers_;
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Services are notified in order of registration.
+    for (const auto& handler: handlers)
+        handler(transaction);
+
+    ++published_transactions_;
+    return true;
+}
+
+} // namespace server
+} // namespace libbitcoin
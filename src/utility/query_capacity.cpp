@@ -0,0 +1,54 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/query_capacity.hpp>
+
+#include <cstddef>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+query_capacity::query_capacity()
+  : outstanding_(0)
+{
+}
+
+void query_capacity::dispatched()
+{
+    ++outstanding_;
+}
+
+void query_capacity::completed()
+{
+    --outstanding_;
+}
+
+size_t query_capacity::outstanding() const
+{
+    return outstanding_;
+}
+
+bool query_capacity::available(size_t limit) const
+{
+    return outstanding_ < limit;
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,225 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/query_metrics.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/message.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::system;
+
+static constexpr size_t code_size = sizeof(uint32_t);
+
+query_metrics::counters::counters()
+  : requests(0),
+    responses(0),
+    errors(0),
+    in_flight(0),
+    latency_sum(0)
+{
+    for (auto& bucket: latencies)
+        bucket = 0;
+}
+
+query_metrics::query_metrics()
+  : requested_(0),
+    responded_(0),
+    dropped_(0),
+    rejected_(0)
+{
+}
+
+void query_metrics::attach(const std::string& command)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    // Each worker attaches the same interface, so this is idempotent.
+    commands_.emplace(std::piecewise_construct, std::forward_as_tuple(command),
+        std::forward_as_tuple());
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Commands are not removed, so a found element remains valid.
+query_metrics::counters* query_metrics::find(const std::string& command)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    const auto it = commands_.find(command);
+    return it == commands_.end() ? nullptr : &it->second;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void query_metrics::dispatch(const std::string& command)
+{
+    const auto counter = find(command);
+
+    if (counter == nullptr)
+        return;
+
+    ++counter->requests;
+    ++counter->in_flight;
+}
+
+void query_metrics::complete(const std::string& command)
+{
+    const auto counter = find(command);
+
+    if (counter != nullptr)
+        --counter->in_flight;
+}
+
+void query_metrics::respond(const message& response)
+{
+    const auto counter = find(response.command());
+
+    if (counter == nullptr)
+        return;
+
+    const auto& data = response.data();
+    const auto failed = data.size() < code_size ||
+        from_little_endian_unsafe<uint32_t>(data.begin()) != 0;
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - response.received()).count();
+    const auto microseconds = static_cast<uint64_t>(std::max(
+        elapsed, decltype(elapsed)(0)));
+
+    // The bucket is the bit length of the latency, saturating at the last.
+    size_t bucket = 0;
+    for (auto value = microseconds; value != 0 && bucket < buckets - 1;
+        value >>= 1)
+        ++bucket;
+
+    ++counter->responses;
+    ++counter->latencies[bucket];
+    counter->latency_sum += microseconds;
+
+    if (failed)
+        ++counter->errors;
+}
+
+void query_metrics::requested()
+{
+    ++requested_;
+}
+
+void query_metrics::responded()
+{
+    ++responded_;
+}
+
+void query_metrics::dropped()
+{
+    ++dropped_;
+}
+
+void query_metrics::rejected()
+{
+    ++rejected_;
+}
+
+query_metrics::summary query_metrics::summarize() const
+{
+    summary out
+    {
+        requested_.load(),
+        responded_.load(),
+        dropped_.load(),
+        rejected_.load(),
+        0
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    for (const auto& command: commands_)
+        out.in_flight += command.second.in_flight.load();
+
+    return out;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+std::string query_metrics::report() const
+{
+    std::ostringstream out;
+    out << "query_relayed_requests_total " << requested_.load() << "\n"
+        << "query_relayed_responses_total " << responded_.load() << "\n"
+        << "query_dropped_total " << dropped_.load() << "\n"
+        << "query_rejected_total " << rejected_.load() << "\n";
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    for (const auto& entry: commands_)
+    {
+        const auto label = "{command=\"" + entry.first + "\"";
+        const auto& counter = entry.second;
+
+        out << "query_requests_total" << label << "} "
+            << counter.requests.load() << "\n"
+            << "query_responses_total" << label << "} "
+            << counter.responses.load() << "\n"
+            << "query_errors_total" << label << "} "
+            << counter.errors.load() << "\n"
+            << "query_in_flight" << label << "} "
+            << counter.in_flight.load() << "\n";
+
+        // Histogram buckets are cumulative, bounded by 2^n - 1 microseconds.
+        uint64_t cumulative = 0;
+        for (size_t bucket = 0; bucket < buckets; ++bucket)
+        {
+            cumulative += counter.latencies[bucket];
+            out << "query_latency_microseconds_bucket" << label << ",le=\"";
+
+            if (bucket == buckets - 1)
+                out << "+Inf";
+            else
+                out << ((uint64_t(1) << bucket) - 1);
+
+            out << "\"} " << cumulative << "\n";
+        }
+
+        out << "query_latency_microseconds_sum" << label << "} "
+            << counter.latency_sum.load() << "\n"
+            << "query_latency_microseconds_count" << label << "} "
+            << counter.responses.load() << "\n";
+    }
+
+    return out.str();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace server
+} // namespace libbitcoin
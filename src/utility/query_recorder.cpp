@@ -0,0 +1,187 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/query_recorder.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <boost/filesystem.hpp>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/message.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::system;
+
+// The capture file begins with this magic, which includes its version.
+static const data_chunk magic{ 'b', 's', 'q', 1 };
+
+// Buffered records are written to the file beyond this size.
+static constexpr size_t buffer_limit = 1u << 16;
+
+query_recorder::query_recorder(const boost::filesystem::path& file)
+  : enabled_(false),
+    started_(false)
+{
+    if (file.empty())
+        return;
+
+    stream_ = std::make_shared<ofstream>(file.string(),
+        std::ios::binary | std::ios::trunc);
+
+    if (!stream_->good())
+    {
+        LOG_ERROR(LOG_SERVER)
+            << "Failed to open query capture file " << file.string();
+        stream_.reset();
+        return;
+    }
+
+    buffer_.reserve(buffer_limit + 1024);
+    extend_data(buffer_, magic);
+    enabled_ = true;
+}
+
+query_recorder::~query_recorder()
+{
+    flush();
+}
+
+bool query_recorder::enabled() const
+{
+    return enabled_;
+}
+
+// [ offset:varint ]
+// [ command_length:varint ][ command... ]
+// [ data_length:varint ][ data... ]
+void query_recorder::serialize(data_chunk& out, uint64_t offset,
+    const std::string& command, const data_chunk& data)
+{
+    data_sink sink(out);
+    ostream_writer writer(sink);
+    writer.write_variable_little_endian(offset);
+    writer.write_string(command);
+    writer.write_variable_little_endian(data.size());
+    writer.write_bytes(data);
+    sink.flush();
+}
+
+bool query_recorder::deserialize(entries& out, const data_chunk& data)
+{
+    auto source = make_safe_deserializer(data.begin(), data.end());
+
+    if (source.read_bytes(magic.size()) != magic)
+        return false;
+
+    while (!source.is_exhausted())
+    {
+        entry record;
+        record.offset = source.read_variable_little_endian();
+        record.command = source.read_string();
+        record.data = source.read_bytes(source.read_size_little_endian());
+
+        if (!source)
+            return false;
+
+        out.push_back(std::move(record));
+    }
+
+    return true;
+}
+
+bool query_recorder::load(entries& out, const boost::filesystem::path& file)
+{
+    ifstream stream(file.string(), std::ios::binary);
+
+    if (!stream.good())
+        return false;
+
+    const data_chunk data((std::istreambuf_iterator<char>(stream)),
+        std::istreambuf_iterator<char>());
+
+    return deserialize(out, data);
+}
+
+// Each record is serialized under the lock, so records are in receipt order
+// within each worker, though interleaved across workers.
+void query_recorder::capture(const message& request)
+{
+    // The lock is not taken unless capturing.
+    if (!enabled_)
+        return;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    if (!stream_)
+        return;
+
+    if (!started_)
+    {
+        start_ = request.received();
+        started_ = true;
+    }
+
+    const auto offset = request.received() < start_ ? 0 :
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            request.received() - start_).count();
+
+    serialize(buffer_, offset, request.command(), request.data());
+
+    if (buffer_.size() >= buffer_limit)
+        write();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void query_recorder::flush()
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    if (stream_)
+        write();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private, called under the lock.
+void query_recorder::write()
+{
+    stream_->write(reinterpret_cast<const char*>(buffer_.data()),
+        buffer_.size());
+    stream_->flush();
+    buffer_.clear();
+
+    if (!stream_->good())
+    {
+        LOG_ERROR(LOG_SERVER)
+            << "Failed to write query capture, capture stopped.";
+        stream_.reset();
+        enabled_ = false;
+    }
+}
+
+} // namespace server
+} // namespace libbitcoin
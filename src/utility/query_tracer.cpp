@@ -0,0 +1,107 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/query_tracer.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/message.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace std::chrono;
+
+static int64_t elapsed(message::time_point start, message::time_point end)
+{
+    return duration_cast<microseconds>(end - start).count();
+}
+
+query_tracer::query_tracer(uint32_t sampling, uint32_t slow_milliseconds)
+  : sampling_(sampling),
+    slow_microseconds_(int64_t(slow_milliseconds) * 1000),
+    counter_(0)
+{
+}
+
+// The clock is not read unless sampled or slow query logging is enabled.
+void query_tracer::sample(message& request)
+{
+    if (sampling_ != 0 && (++counter_ % sampling_) == 0)
+        request.sample();
+}
+
+bool query_tracer::slow(const message& query, time_point now) const
+{
+    return slow_microseconds_ != 0 &&
+        elapsed(query.received(), now) > slow_microseconds_;
+}
+
+void query_tracer::relay(const message& request)
+{
+    if (slow_microseconds_ == 0)
+        return;
+
+    const auto now = steady_clock::now();
+
+    if (slow(request, now))
+        LOG_WARNING(LOG_SERVER_SLOW)
+            << "Slow relay " << request.command() << " "
+            << request.route().display() << "[" << request.id() << "] "
+            << elapsed(request.received(), now) << "us in backlog";
+}
+
+void query_tracer::respond(const message& response)
+{
+    if (slow_microseconds_ == 0 && !response.traced())
+        return;
+
+    const auto now = steady_clock::now();
+
+    if (slow(response, now))
+        LOG_WARNING(LOG_SERVER_SLOW)
+            << "Slow query " << describe(response, now);
+    else if (response.traced())
+        LOG_INFO(LOG_SERVER_SLOW)
+            << "Traced query " << describe(response, now);
+}
+
+// fetch_history4 [0a1b2c][][7] 2013us (wait 5us, execute 1990us, send 18us)
+std::string query_tracer::describe(const message& response, time_point sent)
+{
+    std::ostringstream out;
+    out << response.command() << " " << response.route().display() << "["
+        << response.id() << "] " << elapsed(response.received(), sent) << "us";
+
+    if (response.traced())
+        out << " (wait "
+            << elapsed(response.received(), response.executed())
+            << "us, execute "
+            << elapsed(response.executed(), response.created())
+            << "us, send "
+            << elapsed(response.created(), sent) << "us)";
+
+    return out.str();
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/rate_limiter.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/protocol.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+rate_limiter::rate_limiter(uint32_t rate)
+  : rate_(rate)
+{
+}
+
+size_t rate_limiter::size() const
+{
+    return buckets_.size();
+}
+
+// The burst is one second of tokens.
+double rate_limiter::refill(const bucket& bucket, clock::time_point now) const
+{
+    typedef std::chrono::duration<double> seconds;
+    const auto elapsed = std::max(seconds(now - bucket.updated).count(), 0.0);
+    return std::min(bucket.tokens + elapsed * rate_, rate_);
+}
+
+bool rate_limiter::admit(const identity& client, clock::time_point now)
+{
+    if (rate_ == 0)
+        return true;
+
+    const auto it = buckets_.find(client);
+
+    // A new client starts with a full bucket.
+    if (it == buckets_.end())
+    {
+        buckets_.emplace(client, bucket{ rate_ - 1.0, now });
+        return true;
+    }
+
+    auto& bucket = it->second;
+    bucket.tokens = refill(bucket, now);
+    bucket.updated = now;
+
+    if (bucket.tokens < 1.0)
+        return false;
+
+    bucket.tokens -= 1.0;
+    return true;
+}
+
+void rate_limiter::prune(clock::time_point now)
+{
+    for (auto it = buckets_.begin(); it != buckets_.end();)
+    {
+        if (refill(it->second, now) >= rate_)
+            it = buckets_.erase(it);
+        else
+            ++it;
+    }
+}
+
+} // namespace server
+} // namespace libbitcoin
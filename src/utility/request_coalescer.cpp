@@ -0,0 +1,122 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/request_coalescer.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <utility>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/message.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace std::placeholders;
+using namespace bc::system;
+
+request_coalescer::request_coalescer(bool enabled)
+  : enabled_(enabled)
+{
+}
+
+// [ command ][ 0x00 ][ arguments... ]
+std::string request_coalescer::to_key(const message& request)
+{
+    const auto& data = request.data();
+    std::string key(request.command());
+    key.reserve(key.size() + 1 + data.size());
+    key.push_back('\0');
+    key.append(data.begin(), data.end());
+    return key;
+}
+
+size_t request_coalescer::pending() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    return pending_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool request_coalescer::join(send_handler& handler, const message& request)
+{
+    if (!enabled_)
+        return false;
+
+    auto key = to_key(request);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    mutex_.lock();
+
+    const auto it = pending_.find(key);
+
+    // A duplicate awaits the response of the lookup in flight.
+    if (it != pending_.end())
+    {
+        it->second.push_back({ request, std::move(handler) });
+        mutex_.unlock();
+        return true;
+    }
+
+    pending_.emplace(key, waiters{});
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    handler = std::bind(&request_coalescer::complete,
+        this, _1, std::move(key), std::move(handler));
+
+    return false;
+}
+
+void request_coalescer::complete(message&& response, const std::string& key,
+    send_handler handler)
+{
+    waiters joined;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    mutex_.lock();
+
+    const auto it = pending_.find(key);
+
+    if (it != pending_.end())
+    {
+        joined = std::move(it->second);
+        pending_.erase(it);
+    }
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Each response retains its own request id and route, and the payload is
+    // copied as each is moved into its frame on send.
+    for (const auto& waiter: joined)
+        waiter.handler(message(waiter.request, data_chunk(response.data())));
+
+    handler(std::move(response));
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,143 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/response_cache.hpp>
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/message.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::system;
+
+response_cache::response_cache(size_t capacity)
+  : capacity_(capacity),
+    size_(0),
+    generation_(0)
+{
+}
+
+// [ command ][ 0x00 ][ witness:1 ][ arguments... ]
+std::string response_cache::to_key(const message& request, bool witness)
+{
+    const auto& data = request.data();
+    std::string key(request.command());
+    key.reserve(key.size() + 2 + data.size());
+    key.push_back('\0');
+    key.push_back(witness ? '\1' : '\0');
+    key.append(data.begin(), data.end());
+    return key;
+}
+
+size_t response_cache::generation() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    return generation_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool response_cache::find(data_chunk& out, const message& request,
+    bool witness)
+{
+    if (capacity_ == 0)
+        return false;
+
+    const auto key = to_key(request, witness);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    const auto it = index_.find(key);
+
+    if (it == index_.end())
+        return false;
+
+    // Move the hit to the front, the least recently used is at the back.
+    entries_.splice(entries_.begin(), entries_, it->second);
+    out = it->second->payload;
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool response_cache::respond(const message& request, bool witness,
+    send_handler handler)
+{
+    data_chunk payload;
+
+    if (!find(payload, request, witness))
+        return false;
+
+    handler(message(request, std::move(payload)));
+    return true;
+}
+
+void response_cache::store(const message& request, bool witness,
+    size_t generation, const data_chunk& payload)
+{
+    // A payload larger than the cache would evict all others, so skip it.
+    if (payload.size() > capacity_)
+        return;
+
+    auto key = to_key(request, witness);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    // The payload may predate a reorganization, so it must be discarded.
+    if (generation != generation_ || index_.count(key) != 0)
+        return;
+
+    entries_.push_front({ std::move(key), payload });
+    index_.emplace(entries_.front().key, entries_.begin());
+    size_ += payload.size();
+
+    while (size_ > capacity_)
+    {
+        const auto& last = entries_.back();
+        size_ -= last.payload.size();
+        index_.erase(last.key);
+        entries_.pop_back();
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void response_cache::clear()
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    ++generation_;
+    index_.clear();
+    entries_.clear();
+    size_ = 0;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace server
+} // namespace libbitcoin
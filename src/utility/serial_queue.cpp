@@ -0,0 +1,121 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/serial_queue.hpp>
+
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace libbitcoin {
+namespace server {
+
+serial_queue::serial_queue()
+  : running_(false)
+{
+}
+
+serial_queue::~serial_queue()
+{
+    stop();
+}
+
+void serial_queue::start()
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (running_ || thread_.joinable())
+        return;
+
+    running_ = true;
+    thread_ = std::thread(&serial_queue::run, this);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void serial_queue::stop()
+{
+    std::thread thread;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+        jobs_.clear();
+        thread = std::move(thread_);
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    condition_.notify_one();
+
+    // A job may not stop its own queue.
+    if (thread.joinable() && thread.get_id() != std::this_thread::get_id())
+        thread.join();
+    else if (thread.joinable())
+        thread.detach();
+}
+
+bool serial_queue::push(job&& item)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (!running_)
+            return false;
+
+        jobs_.push_back(std::move(item));
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    condition_.notify_one();
+    return true;
+}
+
+void serial_queue::run()
+{
+    while (true)
+    {
+        job item;
+
+        ///////////////////////////////////////////////////////////////////////
+        // Critical Section
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait(lock, [this]()
+            {
+                return !running_ || !jobs_.empty();
+            });
+
+            if (!running_)
+                return;
+
+            item = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+        ///////////////////////////////////////////////////////////////////////
+
+        item();
+    }
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -0,0 +1,299 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/stealth_index.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/messages/route.hpp>
+#include <bitcoin/server/messages/subscription.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::system;
+using namespace bc::system::wallet;
+
+stealth_index::stealth_index(size_t limit)
+  : limit_(limit),
+    size_(0),
+    occupied_(0)
+{
+}
+
+bool stealth_index::empty() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    return size_ == 0;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+size_t stealth_index::size() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    return size_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+time_t stealth_index::bucket(time_t time)
+{
+    return time / bucket_seconds;
+}
+
+// A prefix is matched against filters by its little-endian byte stream, as
+// in binary{ bits, prefix }, with the first bit the high bit of the stream.
+uint32_t stealth_index::to_stream(uint32_t prefix)
+{
+    return
+        ((prefix & 0x000000ff) << 24) |
+        ((prefix & 0x0000ff00) << 8) |
+        ((prefix & 0x00ff0000) >> 8) |
+        ((prefix & 0xff000000) >> 24);
+}
+
+uint32_t stealth_index::to_stream(const binary& filter)
+{
+    uint32_t stream = 0;
+    const auto& blocks = filter.blocks();
+    const auto size = std::min(blocks.size(), sizeof(uint32_t));
+
+    for (size_t index = 0; index < size; ++index)
+        stream |= uint32_t(blocks[index]) << (byte_bits * (3 - index));
+
+    return stream;
+}
+
+// The leading bits of the stream, where bits is in [1..32].
+uint32_t stealth_index::leading(uint32_t stream, size_t bits)
+{
+    return bits == lengths ? stream : stream >> (lengths - bits);
+}
+
+code stealth_index::subscribe(const binary& filter, const route& route,
+    uint32_t id, time_t now)
+{
+    const auto bits = filter.size();
+
+    if (bits < stealth_address::min_filter_bits ||
+        bits > stealth_address::max_filter_bits)
+        return error::bad_stream;
+
+    const auto value = leading(to_stream(filter), bits);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    auto& list = filters_[bits - 1][value];
+    const auto it = subscription::find(list, route);
+
+    if (it != list.end())
+    {
+        (*it)->set_updated(now);
+    }
+    else
+    {
+        if (size_ >= limit_)
+        {
+            if (list.empty())
+                filters_[bits - 1].erase(value);
+
+            return error::oversubscribed;
+        }
+
+        list.push_back(std::make_shared<const subscription>(route, id,
+            now));
+        occupied_ |= (uint32_t(1) << (bits - 1));
+        ++size_;
+    }
+
+    // The filter may also remain in prior buckets, which purge skips.
+    wheel_[bucket(now)].insert((entry(bits) << lengths) | value);
+    return error::success;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void stealth_index::unsubscribe(const binary& filter, const route& route)
+{
+    const auto bits = filter.size();
+
+    if (bits < stealth_address::min_filter_bits ||
+        bits > stealth_address::max_filter_bits)
+        return;
+
+    const auto value = leading(to_stream(filter), bits);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    // The filter is removed from the wheel lazily, by purge.
+    auto& table = filters_[bits - 1];
+    const auto found = table.find(value);
+
+    if (found == table.end())
+        return;
+
+    auto& list = found->second;
+    const auto it = subscription::find(list, route);
+
+    if (it == list.end())
+        return;
+
+    list.erase(it);
+    --size_;
+
+    if (list.empty())
+        erase(bits, value);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Remove an empty filter, clearing its length from the bitmap if unused.
+void stealth_index::erase(size_t bits, uint32_t value)
+{
+    auto& table = filters_[bits - 1];
+    table.erase(value);
+
+    if (table.empty())
+        occupied_ &= ~(uint32_t(1) << (bits - 1));
+}
+
+void stealth_index::match(list& out, uint32_t prefix) const
+{
+    const auto stream = to_stream(prefix);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    // Probe only lengths with subscriptions, one hash lookup for each.
+    for (auto bitmap = occupied_; bitmap != 0; bitmap &= (bitmap - 1))
+    {
+        size_t bits = 1;
+        for (auto low = bitmap & (~bitmap + 1); low != 1; low >>= 1)
+            ++bits;
+
+        const auto& table = filters_[bits - 1];
+        const auto found = table.find(leading(stream, bits));
+
+        if (found == table.end())
+            continue;
+
+        out.insert(out.end(), found->second.begin(), found->second.end());
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+std::chrono::microseconds stealth_index::purge(list& out, time_t cutoff,
+    size_t batch)
+{
+    typedef std::chrono::steady_clock clock;
+    std::chrono::microseconds longest(0);
+    auto complete = false;
+
+    while (!complete)
+    {
+        ///////////////////////////////////////////////////////////////////////
+        // Critical Section
+        unique_lock lock(mutex_);
+        const auto locked = clock::now();
+
+        complete = purge(out, cutoff, batch);
+
+        const auto held = clock::now() - locked;
+        lock.unlock();
+        ///////////////////////////////////////////////////////////////////////
+
+        longest = std::max(longest,
+            std::chrono::duration_cast<std::chrono::microseconds>(held));
+    }
+
+    return longest;
+}
+
+// Purge up to batch filters from expired buckets, true if none remain.
+bool stealth_index::purge(list& out, time_t cutoff, size_t batch)
+{
+    static const entry mask = (entry(1) << lengths) - 1;
+    const auto expired = bucket(cutoff);
+    size_t visited = 0;
+
+    while (!wheel_.empty() && wheel_.begin()->first < expired)
+    {
+        auto& due = wheel_.begin()->second;
+
+        while (!due.empty())
+        {
+            if (batch != 0 && visited == batch)
+                return false;
+
+            ++visited;
+            const auto it = due.begin();
+            const auto bits = static_cast<size_t>(*it >> lengths);
+            const auto value = static_cast<uint32_t>(*it & mask);
+            due.erase(it);
+
+            auto& table = filters_[bits - 1];
+            const auto found = table.find(value);
+
+            if (found == table.end())
+                continue;
+
+            auto& list = found->second;
+            auto end = list.end();
+
+            for (auto sub = list.begin(); sub != end;)
+            {
+                if ((*sub)->updated() < cutoff)
+                {
+                    out.push_back(*sub);
+                    *sub = std::move(*(--end));
+                    --size_;
+                }
+                else
+                {
+                    ++sub;
+                }
+            }
+
+            list.erase(end, list.end());
+
+            if (list.empty())
+                erase(bits, value);
+        }
+
+        wheel_.erase(wheel_.begin());
+    }
+
+    return true;
+}
+
+} // namespace server
+} // namespace libbitcoin
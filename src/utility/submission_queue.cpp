@@ -0,0 +1,112 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/submission_queue.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace std::placeholders;
+using namespace bc::system;
+
+submission_queue::submission_queue(organizer&& organize, size_t limit)
+  : organize_(std::move(organize)),
+    limit_(limit)
+{
+}
+
+size_t submission_queue::pending() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    return pending_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+code submission_queue::submit(transaction_const_ptr tx,
+    result_handler&& handler)
+{
+    // Hashing is performed outside of the lock.
+    const auto hash = tx->hash();
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    mutex_.lock();
+
+    const auto it = pending_.find(hash);
+
+    // A duplicate awaits the result of the pending organization.
+    if (it != pending_.end())
+    {
+        it->second.push_back(std::move(handler));
+        mutex_.unlock();
+        return error::success;
+    }
+
+    if (limit_ != 0 && pending_.size() >= limit_)
+    {
+        mutex_.unlock();
+        return error::oversubscribed;
+    }
+
+    pending_[hash].push_back(std::move(handler));
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // The organizer may complete on this thread, so it is called unlocked.
+    organize_(tx,
+        std::bind(&submission_queue::complete,
+            this, _1, hash));
+
+    return error::success;
+}
+
+void submission_queue::complete(const code& ec, const hash_digest& hash)
+{
+    handlers waiting;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    mutex_.lock();
+
+    const auto it = pending_.find(hash);
+
+    if (it != pending_.end())
+    {
+        waiting = std::move(it->second);
+        pending_.erase(it);
+    }
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    for (const auto& handler: waiting)
+        handler(ec);
+}
+
+} // namespace server
+} // namespace libbitcoin
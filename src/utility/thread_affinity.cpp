@@ -0,0 +1,169 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/thread_affinity.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <boost/algorithm/string.hpp>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+
+#ifdef __linux__
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::system;
+
+// A pool thread waits at most this long for the others to be pinned.
+static const auto pool_wait = std::chrono::seconds(1);
+
+// The pool threads arriving at the pin barrier.
+struct arrivals
+{
+    std::mutex mutex;
+    std::condition_variable arrived;
+    size_t count;
+};
+
+// A core number or range limit, digits only.
+static bool parse_core(size_t& out, const std::string& text)
+{
+    if (text.empty() || text.size() > 5 ||
+        text.find_first_not_of("0123456789") != std::string::npos)
+        return false;
+
+    out = std::stoul(text);
+    return true;
+}
+
+bool thread_affinity::parse(std::vector<size_t>& out,
+    const std::string& cores)
+{
+    out.clear();
+
+    if (cores.empty())
+        return true;
+
+    std::vector<std::string> tokens;
+    boost::split(tokens, cores, boost::is_any_of(","));
+
+    for (auto token: tokens)
+    {
+        boost::trim(token);
+        const auto dash = token.find('-');
+        size_t first;
+        size_t last;
+
+        if (dash == std::string::npos)
+        {
+            if (!parse_core(first, token))
+                return false;
+
+            last = first;
+        }
+        else if (!parse_core(first, token.substr(0, dash)) ||
+            !parse_core(last, token.substr(dash + 1)) || last < first)
+        {
+            return false;
+        }
+
+        for (auto core = first; core <= last; ++core)
+            out.push_back(core);
+    }
+
+    return true;
+}
+
+bool thread_affinity::pin(const std::string& cores, const std::string& name)
+{
+    std::vector<size_t> list;
+
+    if (!parse(list, cores))
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Invalid cores [" << cores << "] for " << name << " thread.";
+        return false;
+    }
+
+    if (list.empty())
+        return true;
+
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+
+    for (const auto core: list)
+        if (core < CPU_SETSIZE)
+            CPU_SET(core, &set);
+
+    const auto result = pthread_setaffinity_np(pthread_self(), sizeof(set),
+        &set);
+
+    if (result == 0)
+    {
+        LOG_DEBUG(LOG_SERVER)
+            << "Pinned " << name << " thread to cores [" << cores << "]";
+        return true;
+    }
+#endif
+
+    LOG_WARNING(LOG_SERVER)
+        << "Failed to pin " << name << " thread to cores [" << cores << "]";
+    return false;
+}
+
+// Pool threads allocate as they run work, so this is posted once the pool
+// is running, before it is given queries.
+void thread_affinity::pin(threadpool& pool, const std::string& cores,
+    const std::string& name)
+{
+    if (cores.empty())
+        return;
+
+    const auto threads = pool.size();
+    const auto state = std::make_shared<arrivals>();
+    state->count = 0;
+
+    for (size_t thread = 0; thread < threads; ++thread)
+    {
+        pool.service().post([=]()
+        {
+            pin(cores, name);
+
+            std::unique_lock<std::mutex> lock(state->mutex);
+            if (++state->count == threads)
+                state->arrived.notify_all();
+            else
+                state->arrived.wait_for(lock, pool_wait,
+                    [=]() { return state->count == threads; });
+        });
+    }
+}
+
+} // namespace server
+} // namespace libbitcoin
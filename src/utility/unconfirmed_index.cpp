@@ -0,0 +1,159 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/utility/unconfirmed_index.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <bitcoin/system.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/utility/payment_keys.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::system;
+using namespace bc::system::chain;
+
+unconfirmed_index::unconfirmed_index(size_t limit)
+  : limit_(limit)
+{
+}
+
+size_t unconfirmed_index::size() const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    return keys_by_transaction_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Keys are derived as for notification (and the database payment index).
+void unconfirmed_index::add(const transaction& tx)
+{
+    if (limit_ == 0)
+        return;
+
+    add(tx, payment_keys::extract(tx));
+}
+
+void unconfirmed_index::add(const transaction& tx, hash_list&& tx_keys)
+{
+    if (limit_ == 0)
+        return;
+
+    // Hashing is performed outside of the lock.
+    const auto tx_hash = tx.hash();
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    if (keys_by_transaction_.find(tx_hash) != keys_by_transaction_.end())
+        return;
+
+    // Confirmed transactions remain in order until popped.
+    while (keys_by_transaction_.size() >= limit_ && !order_.empty())
+    {
+        remove(order_.front());
+        order_.pop_front();
+    }
+
+    for (const auto& key: tx_keys)
+        transactions_by_key_[key].push_back(tx_hash);
+
+    keys_by_transaction_.emplace(tx_hash, std::move(tx_keys));
+    order_.push_back(tx_hash);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void unconfirmed_index::confirm(const block_const_ptr_list& blocks)
+{
+    if (limit_ == 0)
+        return;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    if (keys_by_transaction_.empty())
+    {
+        order_.clear();
+        return;
+    }
+
+    for (const auto block: blocks)
+        for (const auto& tx: block->transactions())
+            remove(tx.hash());
+
+    const auto removed = [this](const hash_digest& hash)
+    {
+        return keys_by_transaction_.find(hash) == keys_by_transaction_.end();
+    };
+
+    // Drop hashes of confirmed transactions once most of the queue.
+    if (order_.size() > 2 * keys_by_transaction_.size())
+        order_.erase(std::remove_if(order_.begin(), order_.end(), removed),
+            order_.end());
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void unconfirmed_index::read(hash_list& out, const hash_digest& key) const
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    const auto it = transactions_by_key_.find(key);
+
+    if (it != transactions_by_key_.end())
+        out.insert(out.end(), it->second.begin(), it->second.end());
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+// Called under the unique lock.
+void unconfirmed_index::remove(const hash_digest& tx_hash)
+{
+    const auto tx = keys_by_transaction_.find(tx_hash);
+
+    if (tx == keys_by_transaction_.end())
+        return;
+
+    for (const auto& key: tx->second)
+    {
+        const auto it = transactions_by_key_.find(key);
+
+        if (it == transactions_by_key_.end())
+            continue;
+
+        auto& hashes = it->second;
+        hashes.erase(std::remove(hashes.begin(), hashes.end(), tx_hash),
+            hashes.end());
+
+        if (hashes.empty())
+            transactions_by_key_.erase(it);
+    }
+
+    keys_by_transaction_.erase(tx);
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -21,11 +21,13 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <utility>
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/configuration.hpp>
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/server_node.hpp>
 #include <bitcoin/server/settings.hpp>
+#include <bitcoin/server/utility/compressor.hpp>
 #include <bitcoin/server/web/default_page_data.hpp>
 
 namespace libbitcoin {
@@ -40,10 +42,13 @@ using role = zmq::socket::role;
 static constexpr auto poll_interval_milliseconds = 100u;
 
 block_socket::block_socket(zmq::context& context, server_node& node,
-    bool secure)
+    bool secure, bool compact)
   : http::socket(context, node.protocol_settings(), secure),
+    compact_(compact),
     settings_(node.server_settings()),
-    protocol_settings_(node.protocol_settings())
+    protocol_settings_(node.protocol_settings()),
+    node_(node),
+    chunk_sequence_(0)
 {
 }
 
@@ -51,7 +56,9 @@ void block_socket::work()
 {
     zmq::socket sub(context_, role::subscriber, protocol_settings_);
 
-    const auto endpoint = zeromq_endpoint().to_local();
+    // The local ipc endpoint avoids the tcp loopback, if enabled.
+    const auto endpoint = settings_.ipc_directory.empty() ?
+        zeromq_endpoint().to_local() : settings_.zeromq_ipc_endpoint("block");
     const auto ec = sub.connect(endpoint);
 
     if (ec)
@@ -91,8 +98,13 @@ void block_socket::work()
 
     while (!poller.terminated() && !stopped())
     {
-        if (poller.wait(poll_interval_milliseconds).contains(sub.id()) &&
-            !handle_block(sub))
+        if (!poller.wait(poll_interval_milliseconds).contains(sub.id()))
+            continue;
+
+        zmq::message notification;
+        sub.receive(notification);
+
+        if (!handle_block(notification))
             break;
     }
 
@@ -113,16 +125,31 @@ void block_socket::work()
 
 // Called by this thread's work() method.
 // Returns true to continue future notifications.
-bool block_socket::handle_block(zmq::socket& subscriber)
+bool block_socket::handle_block(zmq::message& notification)
 {
     if (stopped())
         return false;
 
-    zmq::message response;
-    subscriber.receive(response);
-
     static constexpr size_t block_message_size = 3;
-    if (response.empty() || response.size() != block_message_size)
+    static constexpr size_t chunk_message_size = 5;
+
+    uint16_t sequence{};
+    uint32_t height;
+    data_chunk block_data;
+
+    if (notification.size() == chunk_message_size)
+    {
+        // Chunks are assembled until the block is complete.
+        if (!handle_chunk(notification, sequence, height, block_data))
+            return true;
+    }
+    else if (notification.size() == block_message_size)
+    {
+        notification.dequeue<uint16_t>(sequence);
+        notification.dequeue<uint32_t>(height);
+        notification.dequeue(block_data);
+    }
+    else
     {
         LOG_WARNING(LOG_SERVER)
             << "Failure handling block notification: invalid data";
@@ -131,16 +158,36 @@ bool block_socket::handle_block(zmq::socket& subscriber)
         return true;
     }
 
-    uint16_t sequence{};
-    uint32_t height;
-    data_chunk block_data;
-    response.dequeue<uint16_t>(sequence);
-    response.dequeue<uint32_t>(height);
-    response.dequeue(block_data);
+    // A compressed block is restored to its canonical serialization.
+    if (settings_.block_compression_enabled)
+    {
+        data_chunk compressed;
+        std::swap(compressed, block_data);
+
+        if (!compressor::decompress(block_data, compressed))
+        {
+            LOG_WARNING(LOG_SERVER)
+                << "Failure handling block notification: invalid compression";
+
+            // Don't let a failure here prevent future notifications.
+            return true;
+        }
+    }
+
+    // Reuse the publication and its rendering, shared by all websockets.
+    const auto publication = node_.publications().restore_block(block_data,
+        height);
 
-    // Format and send transaction to websocket subscribers.
-    const auto block = system::chain::block::factory(block_data, true);
-    broadcast(http::to_json(block, height, sequence));
+    if (!publication)
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failure handling block notification: invalid data";
+
+        // Don't let a failure here prevent future notifications.
+        return true;
+    }
+
+    broadcast(*publication->json(sequence, compact_));
 
     LOG_VERBOSE(LOG_SERVER)
         << "Broadcasted " << security_ << " socket block ["
@@ -148,6 +195,54 @@ bool block_socket::handle_block(zmq::socket& subscriber)
     return true;
 }
 
+// Returns true with the block once its last chunk is appended. A chunk out
+// of order (such as after a subscriber high water drop) drops the partial
+// block, and each remaining chunk of that block, as none can follow in order.
+bool block_socket::handle_chunk(zmq::message& notification,
+    uint16_t& sequence, uint32_t& height, data_chunk& block)
+{
+    uint32_t offset{};
+    uint32_t total{};
+    data_chunk chunk;
+    notification.dequeue<uint16_t>(sequence);
+    notification.dequeue<uint32_t>(height);
+    notification.dequeue<uint32_t>(offset);
+    notification.dequeue<uint32_t>(total);
+    notification.dequeue(chunk);
+
+    if (offset == 0)
+    {
+        chunks_.clear();
+        chunks_.reserve(total);
+        chunk_sequence_ = sequence;
+    }
+    else if (sequence != chunk_sequence_ || offset != chunks_.size())
+    {
+        LOG_DEBUG(LOG_SERVER)
+            << "Discarded partial " << security_ << " websocket block ["
+            << height << "]";
+        chunks_.clear();
+        return false;
+    }
+
+    if (chunk.size() > total - chunks_.size())
+    {
+        LOG_WARNING(LOG_SERVER)
+            << "Failure handling block notification: invalid chunk";
+        chunks_.clear();
+        return false;
+    }
+
+    extend_data(chunks_, chunk);
+
+    if (chunks_.size() < total)
+        return false;
+
+    block = std::move(chunks_);
+    chunks_.clear();
+    return true;
+}
+
 const endpoint& block_socket::zeromq_endpoint() const
 {
     // The Websocket to zeromq backend internally always uses the
@@ -159,7 +254,8 @@ const endpoint& block_socket::zeromq_endpoint() const
 
 const endpoint& block_socket::websocket_endpoint() const
 {
-    return settings_.websockets_block_endpoint(secure_);
+    return compact_ ? settings_.websockets_compact_block_endpoint(secure_) :
+        settings_.websockets_block_endpoint(secure_);
 }
 
 } // namespace server
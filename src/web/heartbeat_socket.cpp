@@ -87,8 +87,13 @@ void heartbeat_socket::work()
 
     while (!poller.terminated() && !stopped())
     {
-        if (poller.wait(poll_interval_milliseconds).contains(sub.id()) &&
-            !handle_heartbeat(sub))
+        if (!poller.wait(poll_interval_milliseconds).contains(sub.id()))
+            continue;
+
+        zmq::message notification;
+        sub.receive(notification);
+
+        if (!handle_heartbeat(notification))
             break;
     }
 
@@ -110,16 +115,13 @@ void heartbeat_socket::work()
 
 // Called by this thread's work() method.
 // Returns true to continue future notifications.
-bool heartbeat_socket::handle_heartbeat(zmq::socket& subscriber)
+bool heartbeat_socket::handle_heartbeat(zmq::message& notification)
 {
     if (stopped())
         return false;
 
-    zmq::message response;
-    subscriber.receive(response);
-
     static constexpr size_t heartbeat_message_size = 2;
-    if (response.empty() || response.size() != heartbeat_message_size)
+    if (notification.empty() || notification.size() != heartbeat_message_size)
     {
         LOG_WARNING(LOG_SERVER)
             << "Failure handling heartbeat notification: invalid data.";
@@ -130,8 +132,8 @@ bool heartbeat_socket::handle_heartbeat(zmq::socket& subscriber)
 
     uint16_t sequence{};
     uint64_t height;
-    response.dequeue<uint16_t>(sequence);
-    response.dequeue<uint64_t>(height);
+    notification.dequeue<uint16_t>(sequence);
+    notification.dequeue<uint64_t>(height);
 
     broadcast(http::to_json(height, sequence));
 
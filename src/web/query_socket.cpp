@@ -18,9 +18,19 @@
  */
 #include <bitcoin/server/web/query_socket.hpp>
 
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_set>
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/server_node.hpp>
+#include <bitcoin/server/services/query_service.hpp>
 #include <bitcoin/server/web/default_page_data.hpp>
 
 namespace libbitcoin {
@@ -35,6 +45,76 @@ using role = zmq::socket::role;
 using connection_ptr = http::connection_ptr;
 
 static constexpr auto poll_interval_milliseconds = 100u;
+static constexpr uint32_t default_header_count = 2000;
+
+// The method suffix requesting the compact encoding of a response.
+static const std::string compact_suffix = ".compact";
+
+// The reply header template is regenerated at this interval.
+static const auto reply_lifetime = std::chrono::seconds(1);
+
+// Parse the decimal digits of text[begin, end) in place, without a stream.
+static bool parse_number(uint32_t& out, const std::string& text,
+    size_t begin, size_t end)
+{
+    if (begin >= end || end > text.size())
+        return false;
+
+    uint64_t value = 0;
+
+    for (auto position = begin; position < end; ++position)
+    {
+        const auto digit = text[position] - '0';
+
+        if (digit < 0 || digit > 9)
+            return false;
+
+        value = value * 10 + digit;
+
+        if (value > max_uint32)
+            return false;
+    }
+
+    out = static_cast<uint32_t>(value);
+    return true;
+}
+
+// The JSON-RPC reply header differs by content length only, so it is split
+// around the length and only the length is rendered for each reply. It is
+// regenerated periodically in case the header carries a date. If the length
+// cannot be located the header is generated for each reply.
+struct reply_template
+{
+    bool generate(std::chrono::steady_clock::time_point now)
+    {
+        static const std::string key("content-length: ");
+
+        http::http_reply reply;
+        const auto header = reply.generate(http::protocol_status::ok, {}, 0,
+            false);
+
+        const auto found = std::search(header.begin(), header.end(),
+            key.begin(), key.end(), [](char left, char right)
+            {
+                return std::tolower(static_cast<unsigned char>(left)) ==
+                    right;
+            });
+
+        const auto digit = found == header.end() ? header.size() :
+            static_cast<size_t>(found - header.begin()) + key.size();
+
+        valid = digit < header.size() && header[digit] == '0';
+        prefix.assign(header, 0, valid ? digit : 0);
+        suffix.assign(header, valid ? digit + 1 : 0, std::string::npos);
+        generated = now;
+        return valid;
+    }
+
+    bool valid = false;
+    std::string prefix;
+    std::string suffix;
+    std::chrono::steady_clock::time_point generated;
+};
 
 query_socket::query_socket(zmq::context& context, server_node& node,
     bool secure)
@@ -59,7 +139,7 @@ query_socket::query_socket(zmq::context& context, server_node& node,
         const std::string& command, const std::string& arguments, uint32_t id)
     {
         uint32_t value;
-        if (!deserialize(value, arguments, false))
+        if (!parse_number(value, arguments, 0, arguments.size()))
             return false;
 
         request.enqueue(command);
@@ -81,17 +161,71 @@ query_socket::query_socket(zmq::context& context, server_node& node,
         return true;
     };
 
-    const auto encode_hash_or_height = [&](zmq::message& request,
+    // Arguments are "height" or "height,count".
+    const auto encode_height_range = [](zmq::message& request,
         const std::string& command, const std::string& arguments, uint32_t id)
     {
-        return encode_hash(request, command, arguments, id) ||
+        const auto separator = std::min(arguments.find(','),
+            arguments.size());
+        uint32_t height;
+        uint32_t count = default_header_count;
+
+        if (!parse_number(height, arguments, 0, separator))
+            return false;
+
+        if (separator != arguments.size() &&
+            !parse_number(count, arguments, separator + 1, arguments.size()))
+            return false;
+
+        data_chunk range(2 * sizeof(uint32_t));
+        auto serial = make_unsafe_serializer(range.begin());
+        serial.write_4_bytes_little_endian(height);
+        serial.write_4_bytes_little_endian(count);
+
+        request.enqueue(command);
+        request.enqueue_little_endian(id);
+        request.enqueue(std::move(range));
+        return true;
+    };
+
+    // A hash is exactly its base16 length, so the argument is decoded once.
+    const auto encode_hash_or_height = [encode_hash, encode_height](
+        zmq::message& request, const std::string& command,
+        const std::string& arguments, uint32_t id)
+    {
+        return arguments.size() == 2 * hash_size ?
+            encode_hash(request, command, arguments, id) :
             encode_height(request, command, arguments, id);
     };
 
+    // The compact variant relays its native command, and the sequence is
+    // retained so that the response is restored to the compact variant.
+    const auto encode_hash_compact = [this, encode_hash](
+        zmq::message& request, const std::string& command,
+        const std::string& arguments, uint32_t id)
+    {
+        return encode_hash(request, native_command(command), arguments, id) &&
+            set_compact(id);
+    };
+
+    const auto encode_hash_or_height_compact = [this, encode_hash_or_height](
+        zmq::message& request, const std::string& command,
+        const std::string& arguments, uint32_t id)
+    {
+        return encode_hash_or_height(request, native_command(command),
+            arguments, id) && set_compact(id);
+    };
+
+    // The reply header template and buffer are reused by every reply, as
+    // the decoders are only run on the web thread.
+    const auto header = std::make_shared<reply_template>();
+    const auto buffer = std::make_shared<std::string>();
+
     // A local clone of the task_sender send logic, for the decoders
     // below that don't need to use that mechanism since they're
     // already guaranteed to be run on the web thread.
-    auto decode_send = [](connection_ptr connection, const std::string& json)
+    auto decode_send = [header, buffer](connection_ptr connection,
+        const std::string& json)
     {
         if (!connection || connection->closed())
             return false;
@@ -108,26 +242,63 @@ query_socket::query_socket(zmq::context& context, server_node& node,
         if (!connection->json_rpc())
             return connection->write(json) == json_size;
 
-        http::http_reply reply;
-        const auto response = reply.generate(http::protocol_status::ok, {},
-            json_size, false) + json;
+        const auto now = std::chrono::steady_clock::now();
+
+        if (now - header->generated >= reply_lifetime)
+            header->generate(now);
+
+        auto& response = *buffer;
+
+        if (header->valid)
+        {
+            response.assign(header->prefix);
+            response.append(std::to_string(json_size));
+            response.append(header->suffix);
+        }
+        else
+        {
+            http::http_reply reply;
+            response.assign(reply.generate(http::protocol_status::ok, {},
+                json_size, false));
+        }
+
+        response.append(json);
 
         LOG_VERBOSE(LOG_SERVER_HTTP)
             << "Writing JSON-RPC response: " << response;
 
-        return connection->write(response) == json_size;
+        return connection->write(response) ==
+            static_cast<int32_t>(response.size());
     };
 
     // JSON to ZMQ response decoders.
     // -------------------------------------------------------------------------
     // These all run on the websocket thread, so can write on the
     // connection directly.
+
+    // The compact encoding renders blocks, headers and transactions as the
+    // base16 serialization, so there is neither parse nor object rendering.
+    // It is requested by the ".compact" variant of each method.
+    const auto decode_compact = [decode_send](const std::string& name,
+        const data_chunk& data, uint32_t id, connection_ptr connection,
+        bool rpc)
+    {
+        std::string json;
+        json.reserve(2 * data.size() + name.size() + 48);
+        json.append(rpc ? "{\"jsonrpc\":\"2.0\",\"id\":" : "{\"id\":");
+        json.append(std::to_string(id));
+        json.append(rpc ? ",\"result\":\"" : ",\"" + name + "\":\"");
+        json.append(encode_base16(data));
+        json.append("\"}");
+        decode_send(connection, json);
+    };
+
     const auto decode_height_raw = [decode_send](const data_chunk& data,
         const uint32_t id, connection_ptr connection, bool rpc)
     {
-        data_source istream(data);
-        istream_reader source(istream);
-        const auto height = source.read_4_bytes_little_endian();
+        // A truncated response is rendered as zero, as by a stream reader.
+        const auto height = data.size() < sizeof(uint32_t) ? 0u :
+            from_little_endian_unsafe<uint32_t>(data.begin());
         const auto json = rpc ? http::rpc::to_json(height, id) : http::to_json(
             height, id);
         decode_send(connection, json);
@@ -137,6 +308,17 @@ query_socket::query_socket(zmq::context& context, server_node& node,
         const data_chunk& data, const uint32_t id, connection_ptr connection,
         bool rpc)
     {
+        // A recently published transaction is rendered without a parse.
+        const auto found = node.publications().find_transaction(data);
+
+        if (found)
+        {
+            const auto& transaction = *found->transaction();
+            decode_send(connection, rpc ? http::rpc::to_json(transaction, id) :
+                http::to_json(transaction, id));
+            return;
+        }
+
         const auto witness = chain::script::is_enabled(
             node.blockchain_settings().enabled_forks(), rule_fork::bip141_rule);
         const auto transaction = chain::transaction::factory(data, true,
@@ -176,17 +358,65 @@ query_socket::query_socket(zmq::context& context, server_node& node,
         decode_send(connection, json);
     };
 
+    // Headers are returned as an array of base16 serializations.
+    const auto decode_block_headers_raw = [decode_send](const data_chunk& data,
+        uint32_t id, connection_ptr connection, bool rpc)
+    {
+        const auto size = chain::header::satoshi_fixed_size();
+        std::string headers;
+
+        for (size_t offset = 0; offset + size <= data.size(); offset += size)
+        {
+            const auto begin = data.begin() + offset;
+            headers += (offset == 0 ? "\"" : ",\"") +
+                encode_base16(data_chunk{ begin, begin + size }) + "\"";
+        }
+
+        const auto json = rpc ?
+            "{\"jsonrpc\":\"2.0\",\"id\":" + std::to_string(id) +
+                ",\"result\":[" + headers + "]}" :
+            "{\"id\":" + std::to_string(id) + ",\"headers\":[" + headers +
+                "]}";
+
+        decode_send(connection, json);
+    };
+
 // Defines both handler variants based on the raw method, one for
 // native and one for rpc.
 #define BUILD_DECODER(name) \
     const auto name = std::bind(name##_raw, _1, _2, _3, false); \
     const auto name##_rpc = std::bind(name##_raw, _1, _2, _3, true)
 
+    const auto decode_transaction_compact_raw = [decode_compact](
+        const data_chunk& data, uint32_t id, connection_ptr connection,
+        bool rpc)
+    {
+        decode_compact("transaction", data, id, connection, rpc);
+    };
+
+    const auto decode_block_compact_raw = [decode_compact](
+        const data_chunk& data, uint32_t id, connection_ptr connection,
+        bool rpc)
+    {
+        decode_compact("block", data, id, connection, rpc);
+    };
+
+    const auto decode_block_header_compact_raw = [decode_compact](
+        const data_chunk& data, uint32_t id, connection_ptr connection,
+        bool rpc)
+    {
+        decode_compact("header", data, id, connection, rpc);
+    };
+
     BUILD_DECODER(decode_height);
     BUILD_DECODER(decode_transaction);
     BUILD_DECODER(decode_block);
     BUILD_DECODER(decode_block_header);
+    BUILD_DECODER(decode_block_headers);
     BUILD_DECODER(decode_block_hash_from_header);
+    BUILD_DECODER(decode_transaction_compact);
+    BUILD_DECODER(decode_block_compact);
+    BUILD_DECODER(decode_block_header_compact);
 
 #undef BUILD_DECODER
 
@@ -204,12 +434,35 @@ query_socket::query_socket(zmq::context& context, server_node& node,
         encode_hash_or_height, decode_block);
     REGISTER_HANDLER("blockchain.fetch_block_header", "getblockheader",
         encode_hash_or_height, decode_block_header);
+    REGISTER_HANDLER("blockchain.fetch_block_headers", "getblockheaders",
+        encode_height_range, decode_block_headers);
     REGISTER_HANDLER("blockchain.fetch_block_header", "getblockhash",
         encode_height, decode_block_hash_from_header);
     REGISTER_HANDLER("blockchain.fetch_block_height", "getblockheight",
         encode_hash, decode_height);
 
 #undef REGISTER_HANDLER
+
+// Defines the compact variant of the native method and its core name, which
+// relay the native command and render its response in the compact encoding.
+#define REGISTER_COMPACT(native, core, encoder, decoder) \
+    handlers_[core ".compact"] = handlers{ native ".compact", encoder, \
+        decoder }; \
+    handlers_[native ".compact"] = handlers{ native ".compact", encoder, \
+        decoder }; \
+    rpc_handlers_[core ".compact"] = handlers{ native ".compact", encoder, \
+        decoder##_rpc }; \
+    rpc_handlers_[native ".compact"] = handlers{ native ".compact", encoder, \
+        decoder##_rpc }
+
+    REGISTER_COMPACT("transaction_pool.fetch_transaction", "getrawtransaction",
+        encode_hash_compact, decode_transaction_compact);
+    REGISTER_COMPACT("blockchain.fetch_block", "getblock",
+        encode_hash_or_height_compact, decode_block_compact);
+    REGISTER_COMPACT("blockchain.fetch_block_header", "getblockheader",
+        encode_hash_or_height_compact, decode_block_header_compact);
+
+#undef REGISTER_COMPACT
 }
 
 void query_socket::work()
@@ -227,7 +480,9 @@ void query_socket::work()
         return;
     }
 
-    const auto endpoint = zeromq_endpoint().to_local();
+    // Connect in process to the public query service router, bypassing the
+    // loopback tcp connection to its zeromq endpoint.
+    const auto& endpoint = query_service::local_endpoint();
     ec = dealer.connect(endpoint);
 
     if (ec)
@@ -335,8 +590,36 @@ bool query_socket::handle_query(zmq::socket& dealer)
         return true;
     }
 
-    socket::queue_response(sequence, data, command);
+    socket::queue_response(sequence, data,
+        clear_compact(sequence) ? command + compact_suffix : command);
+    return true;
+}
+
+// static
+std::string query_socket::native_command(const std::string& command)
+{
+    return command.substr(0, command.size() - compact_suffix.size());
+}
+
+// Called by the websocket thread as a compact variant is encoded.
+bool query_socket::set_compact(uint32_t sequence)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(compact_mutex_);
+    compact_sequences_.insert(sequence);
     return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Called by the zmq thread as each response is received.
+bool query_socket::clear_compact(uint32_t sequence)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(compact_mutex_);
+    return compact_sequences_.erase(sequence) != 0;
+    ///////////////////////////////////////////////////////////////////////////
 }
 
 const endpoint& query_socket::zeromq_endpoint() const
@@ -38,10 +38,12 @@ using role = zmq::socket::role;
 static constexpr auto poll_interval_milliseconds = 100u;
 
 transaction_socket::transaction_socket(zmq::context& context,
-    server_node& node, bool secure)
+    server_node& node, bool secure, bool compact)
   : http::socket(context, node.protocol_settings(), secure),
+    compact_(compact),
     settings_(node.server_settings()),
-    protocol_settings_(node.protocol_settings())
+    protocol_settings_(node.protocol_settings()),
+    node_(node)
 {
 }
 
@@ -49,7 +51,10 @@ void transaction_socket::work()
 {
     zmq::socket sub(context_, role::subscriber, protocol_settings_);
 
-    const auto endpoint = zeromq_endpoint().to_local();
+    // The local ipc endpoint avoids the tcp loopback, if enabled.
+    const auto endpoint = settings_.ipc_directory.empty() ?
+        zeromq_endpoint().to_local() :
+        settings_.zeromq_ipc_endpoint("transaction");
     const auto ec = sub.connect(endpoint);
 
     if (ec)
@@ -90,8 +95,13 @@ void transaction_socket::work()
 
     while (!poller.terminated() && !stopped())
     {
-        if (poller.wait(poll_interval_milliseconds).contains(sub.id()) &&
-            !handle_transaction(sub))
+        if (!poller.wait(poll_interval_milliseconds).contains(sub.id()))
+            continue;
+
+        zmq::message notification;
+        sub.receive(notification);
+
+        if (!handle_transaction(notification))
             break;
     }
 
@@ -113,16 +123,13 @@ void transaction_socket::work()
 
 // Called by this thread's work() method.
 // Returns true to continue future notifications.
-bool transaction_socket::handle_transaction(zmq::socket& subscriber)
+bool transaction_socket::handle_transaction(zmq::message& notification)
 {
     if (stopped())
         return false;
 
-    zmq::message response;
-    subscriber.receive(response);
-
     static constexpr size_t transaction_message_size = 2;
-    if (response.empty() || response.size() != transaction_message_size)
+    if (notification.empty() || notification.size() != transaction_message_size)
     {
         LOG_WARNING(LOG_SERVER)
             << "Failure handling transaction notification: invalid data";
@@ -133,11 +140,14 @@ bool transaction_socket::handle_transaction(zmq::socket& subscriber)
 
     uint16_t sequence{};
     data_chunk transaction_data;
-    response.dequeue<uint16_t>(sequence);
-    response.dequeue(transaction_data);
+    notification.dequeue<uint16_t>(sequence);
+    notification.dequeue(transaction_data);
+
+    // Reuse the publication and its rendering, shared by all websockets.
+    const auto publication = node_.publications().restore_transaction(
+        transaction_data);
 
-    chain::transaction tx;
-    if (!tx.from_data(transaction_data, true, true))
+    if (!publication)
     {
         LOG_WARNING(LOG_SERVER)
             << "Failure handling transaction notification: invalid data";
@@ -146,11 +156,11 @@ bool transaction_socket::handle_transaction(zmq::socket& subscriber)
         return true;
     }
 
-    broadcast(http::to_json(tx, sequence));
+    broadcast(*publication->json(sequence, compact_));
 
     LOG_VERBOSE(LOG_SERVER)
         << "Broadcasted " << security_ << " socket tx ["
-        << encode_hash(tx.hash()) << "]";
+        << encode_hash(publication->hash()) << "]";
     return true;
 }
 
@@ -165,7 +175,9 @@ const endpoint& transaction_socket::zeromq_endpoint() const
 
 const endpoint& transaction_socket::websocket_endpoint() const
 {
-    return settings_.websockets_transaction_endpoint(secure_);
+    return compact_ ?
+        settings_.websockets_compact_transaction_endpoint(secure_) :
+        settings_.websockets_transaction_endpoint(secure_);
 }
 
 } // namespace server
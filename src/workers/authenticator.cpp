@@ -19,6 +19,7 @@
 #include <bitcoin/server/workers/authenticator.hpp>
 
 #include <string>
+#include <unordered_set>
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/configuration.hpp>
 #include <bitcoin/server/server_node.hpp>
@@ -36,9 +37,19 @@ authenticator::authenticator(server_node& node)
 
     set_private_key(settings.zeromq_server_private_key);
 
+    // The lists are compiled once into hashed sets, leaving the handshake
+    // with one hashed lookup per address and key. Duplicates are applied
+    // once, so that large lists do not repeat work or logging.
+    std::unordered_set<hash_digest> keys;
+    std::unordered_set<std::string> allowed;
+    std::unordered_set<std::string> denied;
+
     // Secure clients are also affected by address restrictions.
     for (const auto& public_key: settings.zeromq_client_public_keys)
     {
+        if (!keys.insert(public_key.data()).second)
+            continue;
+
         LOG_DEBUG(LOG_SERVER)
             << "Allow client public key [" << public_key << "]";
 
@@ -48,22 +59,40 @@ authenticator::authenticator(server_node& node)
     // Allow wins in case of conflict with deny (first writer).
     for (const auto& address: settings.client_addresses)
     {
-        LOG_DEBUG(LOG_SERVER)
-            << "Allow client address [" << address.to_hostname() << "]";
-
         // The port is ignored.
+        const auto host = address.to_hostname();
+
+        if (!allowed.insert(host).second)
+            continue;
+
+        LOG_DEBUG(LOG_SERVER) << "Allow client address [" << host << "]";
         allow(address);
     }
 
-    // Allow wins in case of conflict with deny (first writer).
+    // Allow wins in case of conflict with deny, so the conflict is reported.
     for (const auto& address: settings.blacklists)
     {
-        LOG_DEBUG(LOG_SERVER)
-            << "Block client address [" << address.to_hostname() << "]";
-
         // The port is ignored.
+        const auto host = address.to_hostname();
+
+        if (allowed.count(host) != 0)
+        {
+            LOG_WARNING(LOG_SERVER)
+                << "Blocked client address [" << host << "] is also allowed.";
+            continue;
+        }
+
+        if (!denied.insert(host).second)
+            continue;
+
+        LOG_DEBUG(LOG_SERVER) << "Block client address [" << host << "]";
         deny(address);
     }
+
+    LOG_INFO(LOG_SERVER)
+        << "Authenticating (" << keys.size() << ") client keys, ("
+        << allowed.size() << ") allowed and (" << denied.size()
+        << ") blocked client addresses.";
 }
 
 bool authenticator::apply(zmq::socket& socket, const std::string& domain,
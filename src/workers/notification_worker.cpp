@@ -19,11 +19,17 @@
 #include <bitcoin/server/workers/notification_worker.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstddef>
 #include <cstdint>
+#include <cstdio>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <utility>
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/define.hpp>
@@ -32,14 +38,11 @@
 #include <bitcoin/server/server_node.hpp>
 #include <bitcoin/server/services/query_service.hpp>
 #include <bitcoin/server/settings.hpp>
+#include <bitcoin/server/utility/thread_affinity.hpp>
 
 namespace libbitcoin {
 namespace server {
 
-// This causes addresses to match each subscription and stealth prefixes
-// to match each subscription 24 times [minimum_filter..maximum_filter].
-////#define HIGH_VOLUME_NOTIFICATION_TESTING
-
 using namespace std::chrono;
 using namespace std::placeholders;
 using namespace bc::protocol;
@@ -50,6 +53,32 @@ using role = zmq::socket::role;
 
 static const auto notification_key = "notification.key";
 static const auto notification_stealth = "notification.stealth";
+static const auto notification_key2 = "notification.key2";
+static const auto notification_key_transaction =
+    "notification.key_transaction";
+
+// Blocks are partitioned into ranges of at least this many transactions.
+static constexpr size_t minimum_partition = 64;
+
+// The partitions of a block claimed and extracted, by any thread.
+struct claims
+{
+    std::atomic<size_t> claimed;
+    std::mutex mutex;
+    std::condition_variable done;
+    size_t completed;
+};
+
+// Purge runs on this tick and releases locks after each batch of entries.
+static constexpr int64_t purge_tick_milliseconds = 60 * 1000;
+static constexpr size_t purge_batch = 1000;
+
+// Zero configures one thread per core, as with the network threadpool.
+static size_t thread_count(uint16_t configured)
+{
+    const size_t cores = std::thread::hardware_concurrency();
+    return configured == 0 ? std::max(cores, size_t(1)) : configured;
+}
 
 notification_worker::notification_worker(zmq::authenticator& authenticator,
     server_node& node, bool secure)
@@ -59,9 +88,17 @@ notification_worker::notification_worker(zmq::authenticator& authenticator,
     settings_(node.server_settings()),
     external_(node.protocol_settings()),
     internal_(external_.send_high_water, external_.receive_high_water),
-    worker_(query_service::worker_endpoint(secure)),
+    // Notifications pass through the first instance to that of the client.
+    worker_(query_service::notify_endpoint(secure, 0)),
+    threads_(thread_count(settings_.notification_threads)),
     authenticator_(authenticator),
-    node_(node)
+    node_(node),
+    block_dealer_(authenticator, role::dealer, worker_, internal_),
+    transaction_dealer_(authenticator, role::dealer, worker_, internal_),
+    purge_dealer_(authenticator, role::dealer, worker_, internal_),
+    key_subscriptions_(settings_.key_subscription_limit),
+    maximum_pause_(0),
+    stealth_subscriptions_(settings_.subscription_limit)
 {
 }
 
@@ -70,6 +107,10 @@ notification_worker::notification_worker(zmq::authenticator& authenticator,
 // required so that purge can run on a separate time thread.
 bool notification_worker::start()
 {
+    // Subscriptions saved by the last run are restored before notification.
+    load_subscriptions();
+    reorganizations_.start();
+
     // Subscribe to blockchain reorganizations.
     node_.subscribe_blocks(
         std::bind(&notification_worker::handle_reorganization,
@@ -86,6 +127,9 @@ bool notification_worker::start()
 // Implement worker as a dummy socket, for uniform stop implementation.
 void notification_worker::work()
 {
+    thread_affinity::pin(settings_.notification_cores,
+        security_ + " notification worker");
+
     zmq::socket dummy(authenticator_, role::pair);
 
     if (!started(dummy))
@@ -96,66 +140,91 @@ void notification_worker::work()
     poller.add(dummy);
 
     // We do not send/receive on poller, we use it for purge and context stop.
-    // Other threads connect dynamically to query service to send notifcation.
+    // Other threads use cached dealers to the query service to notify.
     // BUGBUG: stop is insufficient to stop worker, because of long period.
     while (!poller.terminated() && !stopped())
     {
         poller.wait(period);
         purge();
+        save_subscriptions();
     }
 
-    finished(dummy.stop());
+    // Pending block notifications are discarded.
+    reorganizations_.stop();
+
+    // The cached dealers must be closed for the context to terminate.
+    const auto block_stop = block_dealer_.stop();
+    const auto transaction_stop = transaction_dealer_.stop();
+    const auto purge_stop = purge_dealer_.stop();
+
+    finished(dummy.stop() && block_stop && transaction_stop && purge_stop);
 }
 
 // Sending.
 // The dealer blocks until the query service dealer is available.
+// Dealers are cached by notification source, and reconnect after failure.
 // ----------------------------------------------------------------------------
 
-zmq::socket::ptr notification_worker::connect()
+code notification_worker::send(zmq::socket& dealer,
+    const subscription& routing, uint16_t sequence,
+    const std::string& command, const code& status, size_t height,
+    const hash_digest& tx_hash)
 {
-    auto dealer = std::make_shared<zmq::socket>(authenticator_, role::dealer);
+    // [ code:4 ]
+    // [ sequence:2 ]
+    // [ height:4 ]
+    // [ tx hash:32 ]
+    // Notifications are formatted as query response messages.
+    ///////////////////////////////////////////////////////////////////////////
+    message reply(routing, command, build_chunk(
+    {
+        message::to_bytes(status),
+        to_little_endian(sequence),
+        to_little_endian(static_cast<uint32_t>(height)),
+        tx_hash
+    }));
+    ///////////////////////////////////////////////////////////////////////////
 
-    // Connect to the query service worker endpoint.
-    // This must be a dealer, since the response is asynchronous.
-    auto ec = dealer->connect(worker_);
+    const auto ec = reply.notify(dealer);
 
     if (ec && ec != error::service_stopped)
         LOG_WARNING(LOG_SERVER)
-            << "Failed to connect " << security_ << " notification worker to "
-            << worker_ << " : " << ec.message();
+            << "Failed to send notification to "
+            << reply.route().display() << " " << ec.message();
 
-    // Using shared pointer because sockets cannot be copied.
-    return dealer;
+    // Failure could create large number of warnings so return it to stop.
+    return ec;
 }
 
-bool notification_worker::send(zmq::socket& dealer,
-    const subscription& routing, const std::string& command,
-    const code& status, size_t height, const hash_digest& tx_hash)
+code notification_worker::send(zmq::socket& dealer,
+    const subscription& routing, uint16_t sequence, size_t height,
+    const data_chunk& tx)
 {
+    static const code ok = error::success;
+
     // [ code:4 ]
     // [ sequence:2 ]
     // [ height:4 ]
-    // [ tx hash:32 ]
+    // [ tx:... ]
     // Notifications are formatted as query response messages.
     ///////////////////////////////////////////////////////////////////////////
-    message reply(routing, command, build_chunk(
+    message reply(routing, notification_key_transaction, build_chunk(
     {
-        message::to_bytes(status),
-        to_little_endian(routing.sequence()),
+        message::to_bytes(ok),
+        to_little_endian(sequence),
         to_little_endian(static_cast<uint32_t>(height)),
-        tx_hash
+        tx
     }));
     ///////////////////////////////////////////////////////////////////////////
 
-    const auto ec = reply.send(dealer);
+    const auto ec = reply.notify(dealer);
 
     if (ec && ec != error::service_stopped)
         LOG_WARNING(LOG_SERVER)
             << "Failed to send notification to "
             << reply.route().display() << " " << ec.message();
 
-    // Failure could create large number of warnings so return false to stop.
-    return ec == error::success;
+    return ec;
 }
 
 // Notification (via blockchain).
@@ -188,26 +257,87 @@ bool notification_worker::handle_reorganization(const code& ec,
     if (key_subscriptions_empty() && stealth_subscriptions_empty())
         return true;
 
-    // Connect failure is logged in connect, nothing else to do on fail.
-    auto dealer = connect();
+    // Failures are logged in cached socket and send, nothing else to do.
+    // Matching and sending are queued so that this handler returns at once.
+    reorganizations_.push([this, fork_height, incoming]()
+    {
+        block_dealer_.send(std::bind(&notification_worker::notify_blocks,
+            this, _1, fork_height, incoming));
+    });
 
-    if (!dealer)
-        return true;
+    return true;
+}
 
-    for (const auto block: *incoming)
-        notify_block(*dealer, safe_add(fork_height, size_t(1)), block);
+code notification_worker::notify_blocks(zmq::socket& dealer,
+    size_t fork_height, block_const_ptr_list_const_ptr blocks)
+{
+    auto height = fork_height;
+    batches batched;
 
-    return true;
+    for (const auto block: *blocks)
+    {
+        const auto ec = notify_block(dealer, safe_add(height, size_t(1)),
+            block, batched);
+
+        if (ec)
+            return ec;
+
+        ++height;
+    }
+
+    // Batched notifications span all blocks of the reorganization.
+    return notify_batches(dealer, batched);
 }
 
-void notification_worker::notify_block(zmq::socket& dealer, size_t height,
-    block_const_ptr block)
+code notification_worker::notify_block(zmq::socket& dealer, size_t height,
+    block_const_ptr block, batches& batched)
 {
     if (stopped())
-        return;
+        return error::service_stopped;
 
-    for (const auto& tx: block->transactions())
-        notify_transaction(dealer, height, tx);
+    const auto keys = !key_subscriptions_empty();
+    const auto stealth = !stealth_subscriptions_empty();
+    const auto& txs = block->transactions();
+    const auto count = partitions(txs.size());
+    const auto size = (txs.size() + count - 1) / count;
+    extractions items(txs.size());
+    const auto out = &items;
+    const auto list = &txs;
+    const auto state = std::make_shared<claims>();
+    state->claimed = 0;
+    state->completed = 0;
+
+    // Partitions write disjoint items and are joined before matching. Items
+    // are referenced only by a claim, and all claims complete before return.
+    const auto extract = [=]()
+    {
+        for (auto part = state->claimed++; part < count;
+            part = state->claimed++)
+        {
+            const auto begin = std::min(part * size, list->size());
+            const auto end = std::min(begin + size, list->size());
+            extract_partition(*out, *list, begin, end, keys, stealth);
+
+            std::unique_lock<std::mutex> lock(state->mutex);
+            if (++state->completed == count)
+                state->done.notify_all();
+        }
+    };
+
+    // Partitions are claimed by the node threadpool and by this thread, so
+    // all are extracted even if a posted claim does not run (on stop).
+    for (size_t part = 1; part < count; ++part)
+        node_.thread_pool().service().post(extract);
+
+    extract();
+
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->done.wait(lock, [=]() { return state->completed == count; });
+    }
+
+    // Match and send in block order, locking each subscription map once.
+    return notify(dealer, items, height, batched);
 }
 
 // Notification (via mempool and blockchain).
@@ -239,44 +369,66 @@ bool notification_worker::handle_transaction_pool(const code& ec,
     if (key_subscriptions_empty() && stealth_subscriptions_empty())
         return true;
 
-    // Connect failure is logged in connect, nothing else to do on fail.
-    auto dealer = connect();
-
-    if (!dealer)
-        return true;
-
+    // Failures are logged in cached socket and send, nothing else to do.
     // Use zero height as sentinel for unconfirmed transaction.
-    notify_transaction(*dealer, 0, *tx);
+    transaction_dealer_.send(std::bind(
+        &notification_worker::notify_transaction,
+            this, _1, 0, std::cref(*tx)));
+
     return true;
 }
 
-// All payment keys are cached on the transaction.
-// This parsing is duplicated by bc::database::data_base.
-void notification_worker::notify_transaction(zmq::socket& dealer,
+code notification_worker::notify_transaction(zmq::socket& dealer,
     size_t height, const transaction& tx)
 {
     if (stopped())
-        return;
+        return error::service_stopped;
+
+    batches batched;
+    extractions items(1);
+    extract(items.front(), tx, !key_subscriptions_empty(),
+        !stealth_subscriptions_empty());
+
+    // Send both sets of notifications on the same worker connection.
+    const auto ec = notify(dealer, items, height, batched);
+    return ec ? ec : notify_batches(dealer, batched);
+}
+
+// Extraction.
+// ----------------------------------------------------------------------------
+
+// Small blocks are not partitioned, as hashing is cheaper than a post.
+size_t notification_worker::partitions(size_t transactions) const
+{
+    const auto partitions = transactions / minimum_partition;
+    return std::max(std::min(partitions, threads_), size_t(1));
+}
 
+void notification_worker::extract_partition(extractions& out,
+    const transaction::list& txs, size_t begin, size_t end, bool keys,
+    bool stealth) const
+{
+    for (auto index = begin; index < end && !stopped(); ++index)
+        extract(out[index], txs[index], keys, stealth);
+}
+
+// All payment keys are cached on the transaction.
+// This parsing is duplicated by bc::database::data_base.
+void notification_worker::extract(extraction& out, const transaction& tx,
+    bool keys, bool stealth)
+{
     const auto& outputs = tx.outputs();
+    out.tx_hash = tx.hash();
+    out.tx = &tx;
 
     if (outputs.empty())
         return;
 
     // Gather unique values, eliminating duplicate notifications per tx.
-    stealth_set prefixes;
-    key_set keys;
-
-    if (!key_subscriptions_empty())
-    {
-        for (const auto& input: tx.inputs())
-            keys.insert(bc::system::sha256_hash(input.script().to_data(false)));
-
-        for (const auto& output: outputs)
-            keys.insert(bc::system::sha256_hash(output.script().to_data(false)));
-    }
+    if (keys)
+        out.keys = payment_keys::extract(tx);
 
-    if (!stealth_subscriptions_empty())
+    if (stealth)
     {
         for (size_t index = 0; index < (outputs.size() - 1); ++index)
         {
@@ -285,91 +437,194 @@ void notification_worker::notify_transaction(zmq::socket& dealer,
             const auto& odd_output = outputs[index + 1];
 
             if (odd_output.address() && to_stealth_prefix(prefix, even_script))
-                prefixes.insert(prefix);
+                out.prefixes.insert(prefix);
         }
     }
-
-    // Send both sets of notifications on the same worker connection.
-    notify(dealer, keys, prefixes, height, tx.hash());
 }
 
-void notification_worker::notify(zmq::socket& dealer,
-    const key_set& keys, const stealth_set& prefixes, size_t height,
-    const hash_digest& tx_hash)
-{
-    static const code ok = error::success;
+// Matching.
+// ----------------------------------------------------------------------------
 
+code notification_worker::notify(zmq::socket& dealer,
+    const extractions& items, size_t height, batches& batched)
+{
     if (stopped())
-        return;
+        return error::service_stopped;
 
-    // Accumulate updates, send notifications outside locks.
-    std::vector<subscription> notifies;
+    // Accumulate updates in item order, send notifications outside locks.
+    matches notifies;
 
-    // Notify address subscribers, O(N + M).
-    if (!keys.empty())
+    // Notify address subscribers, O(N), each key locks only its shard.
+    if (!key_subscriptions_empty())
     {
-        ///////////////////////////////////////////////////////////////////////
-        // Critical Section
-        shared_lock lock(key_mutex_);
+        key_index::list found;
 
-        const auto& left = key_subscriptions_.left;
-
-        for (const auto& key: keys)
+        for (size_t index = 0; index < items.size(); ++index)
         {
-#ifdef HIGH_VOLUME_NOTIFICATION_TESTING
-            for (auto it = left.begin(); it != left.end(); ++it)
-#else
-            auto range = left.equal_range(key);
-            for (auto it = range.first; it != range.second; ++it)
-#endif
+            for (const auto& key: items[index].keys)
             {
-                it->second.increment();
-                notifies.push_back(it->second);
+                key_subscriptions_.match(found, key);
+
+                for (const auto& subscription: found)
+                    notifies.push_back(
+                    {
+                        subscription, index, subscription->increment()
+                    });
+
+                found.clear();
             }
         }
-        ///////////////////////////////////////////////////////////////////////
     }
 
-    // Send failure is logged in send.
-    for (auto& notify: notifies)
-        if (!send(dealer, notify, notification_key, ok, height, tx_hash))
-            break;
+    const auto ec = notify(dealer, notifies, items, notification_key,
+        height, batched);
+
+    if (ec)
+        return ec;
 
     notifies.clear();
 
-    // Notify stealth subscribers, O(24 * (N + M)).
-    if (!prefixes.empty())
+    // Notify stealth subscribers, O(N * L) for L filter lengths in use.
+    if (!stealth_subscriptions_empty())
     {
-        ///////////////////////////////////////////////////////////////////////
-        // Critical Section
-        shared_lock lock(stealth_mutex_);
+        stealth_index::list found;
+
+        for (size_t index = 0; index < items.size(); ++index)
+        {
+            for (const auto& prefix: items[index].prefixes)
+            {
+                stealth_subscriptions_.match(found, prefix);
+
+                for (const auto& subscription: found)
+                    notifies.push_back(
+                    {
+                        subscription, index, subscription->increment()
+                    });
+
+                found.clear();
+            }
+        }
+    }
 
-        const auto& left = stealth_subscriptions_.left;
+    return notify(dealer, notifies, items, notification_stealth, height,
+        batched);
+}
 
-        for (const auto& prefix: prefixes)
+code notification_worker::notify(zmq::socket& dealer, const matches& items,
+    const extractions& sources, const std::string& command, size_t height,
+    batches& batched)
+{
+    static const code ok = error::success;
+
+    // Matches are in source order, so each transaction is serialized once.
+    auto serialized = sources.size();
+    data_chunk tx;
+
+    // Send failure is logged in send.
+    for (const auto& item: items)
+    {
+        const auto& routing = *item.routing;
+        const auto& tx_hash = sources[item.index].tx_hash;
+
+        if (routing.transactions())
         {
-            for (auto bits = stealth_address::min_filter_bits;
-                bits <= stealth_address::max_filter_bits; ++bits)
+            if (serialized != item.index)
             {
-#ifdef HIGH_VOLUME_NOTIFICATION_TESTING
-                for (auto it = left.begin(); it != left.end(); ++it)
-#else
-                auto range = left.equal_range(binary{ bits, prefix });
-                for (auto it = range.first; it != range.second; ++it)
-#endif
-                {
-                    it->second.increment();
-                    notifies.push_back(it->second);
-                }
+                tx = sources[item.index].tx->to_data(true, true);
+                serialized = item.index;
             }
+
+            const auto ec = send(dealer, routing, item.sequence, height, tx);
+
+            if (ec)
+                return ec;
+
+            continue;
+        }
+
+        if (!routing.batched())
+        {
+            const auto ec = send(dealer, routing, item.sequence, command, ok,
+                height, tx_hash);
+
+            if (ec)
+                return ec;
+
+            continue;
         }
+
+        // The route identifies the client, across its keys.
+        const auto key = std::make_pair(routing.instance(), routing.address());
+        auto it = batched.find(key);
+
+        if (it == batched.end())
+            it = batched.emplace(key, batch{ item.routing, 0, {} }).first;
+
+        // [ sequence:2 ]
+        // [ height:4 ]
+        // [ tx hash:32 ]
+        auto& entry = it->second;
+        extend_data(entry.tuples, to_little_endian(item.sequence));
+        extend_data(entry.tuples,
+            to_little_endian(static_cast<uint32_t>(height)));
+        extend_data(entry.tuples, tx_hash);
+        ++entry.count;
+    }
+
+    return error::success;
+}
+
+code notification_worker::notify_batches(zmq::socket& dealer,
+    const batches& batched)
+{
+    static const code ok = error::success;
+
+    for (const auto& item: batched)
+    {
+        const auto& entry = item.second;
+
+        // [ code:4 ]
+        // [ count:4 ]
+        // [[ sequence:2 ][ height:4 ][ tx hash:32 ]...]
+        ///////////////////////////////////////////////////////////////////////
+        message reply(*entry.routing, notification_key2, build_chunk(
+        {
+            message::to_bytes(ok),
+            to_little_endian(entry.count),
+            entry.tuples
+        }));
         ///////////////////////////////////////////////////////////////////////
+
+        const auto ec = reply.notify(dealer);
+
+        if (ec && ec != error::service_stopped)
+            LOG_WARNING(LOG_SERVER)
+                << "Failed to send batched notification to "
+                << reply.route().display() << " " << ec.message();
+
+        if (ec)
+            return ec;
     }
 
+    return error::success;
+}
+
+code notification_worker::notify_expirations(zmq::socket& dealer,
+    const subscription::list& expires, const std::string& command)
+{
+    static const code to = error::channel_timeout;
+
     // Send failure is logged in send.
-    for (auto& notify: notifies)
-        if (!send(dealer, notify, notification_stealth, ok, height, tx_hash))
-            break;
+    for (const auto& expire: expires)
+    {
+        const auto ec = send(dealer, *expire, expire->increment(), command,
+            to, 0, null_hash);
+
+        if (ec)
+            return ec;
+    }
+
+    return error::success;
 }
 
 // Subscription.
@@ -399,144 +654,163 @@ int32_t notification_worker::purge_milliseconds() const
     if (settings_.subscription_expiration_minutes == 0)
         return -1;
 
+    // Purge on a short tick so that each expired backlog remains small.
     const int64_t minutes = settings_.subscription_expiration_minutes;
     const int64_t milliseconds = minutes * 60 * 1000;
-    auto capped = std::min(milliseconds, static_cast<int64_t>(max_int32));
+    auto capped = std::min(milliseconds, purge_tick_milliseconds);
     return static_cast<int32_t>(capped);
 }
 
 void notification_worker::purge()
 {
-    static const code to = error::channel_timeout;
-
-    // Connect failure is logged in connect (purge regardless).
-    auto dealer = connect();
-
     // Purge any subscription with an update time earlier than this.
     const auto cutoff = cutoff_time();
 
     // Accumulate removals, send expiration notifications outside locks.
-    std::vector<subscription> expires;
+    subscription::list expires;
 
-    ///////////////////////////////////////////////////////////////////////////
-    // Critical Section
-    key_mutex_.lock();
+    // Each key shard is locked in turn, for up to one batch at a time.
+    record_pause(key_subscriptions_.purge(expires, cutoff, purge_batch));
 
-    auto& address = key_subscriptions_.right;
+    // Failures are logged in cached socket and send (purge regardless).
+    if (!expires.empty())
+        purge_dealer_.send(std::bind(&notification_worker::notify_expirations,
+            this, _1, std::cref(expires), notification_key));
 
-    for (auto it = address.begin(); it != address.end() &&
-        it->first.updated() < cutoff; it = address.erase(it))
-    {
-        it->first.increment();
-        expires.push_back(it->first);
-    }
+    expires.clear();
 
-    key_mutex_.unlock();
-    ///////////////////////////////////////////////////////////////////////////
+    // The stealth index is locked for up to one batch at a time.
+    record_pause(stealth_subscriptions_.purge(expires, cutoff, purge_batch));
 
-    // Send failure is logged in send.
-    if (dealer)
-        for (auto& expire: expires)
-            if (!send(*dealer, expire, notification_key, to, 0, null_hash))
-                break;
+    // Failures are logged in cached socket and send (purge regardless).
+    if (!expires.empty())
+        purge_dealer_.send(std::bind(&notification_worker::notify_expirations,
+            this, _1, std::cref(expires), notification_stealth));
+}
 
-    expires.clear();
+// The longest purge pause is retained as a metric, and checked against the
+// configured budget, since notifiers wait on the purge for this period.
+void notification_worker::record_pause(microseconds pause)
+{
+    auto longest = maximum_pause_.load();
+    const auto count = pause.count();
 
-    ///////////////////////////////////////////////////////////////////////////
-    // Critical Section
-    stealth_mutex_.lock();
+    while (count > longest &&
+        !maximum_pause_.compare_exchange_weak(longest, count));
+
+    if (settings_.purge_pause_budget_microseconds > 0 &&
+        count > settings_.purge_pause_budget_microseconds)
+        LOG_WARNING(LOG_SERVER)
+            << "Subscription purge paused notifications for " << count
+            << " microseconds, exceeding budget of "
+            << settings_.purge_pause_budget_microseconds << ".";
+}
+
+// Snapshot.
+// Key subscriptions are saved on each purge tick and restored on start, so
+// that a client resubscribe after restart is a renewal. A saved route is
+// valid only for a client that sets its own routing id.
+// ----------------------------------------------------------------------------
+
+boost::filesystem::path notification_worker::snapshot_file() const
+{
+    return settings_.subscription_directory / (security_ + "_keys.dat");
+}
+
+void notification_worker::load_subscriptions()
+{
+    if (settings_.subscription_directory.empty())
+        return;
+
+    const auto file = snapshot_file();
+    bc::system::ifstream stream(file.string(), std::ios::binary);
+
+    if (!stream.good())
+        return;
 
-    auto& stealth = stealth_subscriptions_.right;
+    // Expired subscriptions are not restored, even if never expiring.
+    const auto cutoff = settings_.subscription_expiration_minutes == 0 ? 0 :
+        cutoff_time();
+
+    istream_reader source(stream);
+    const auto loaded = key_subscriptions_.load(source, cutoff);
+
+    LOG_INFO(LOG_SERVER)
+        << "Restored (" << loaded << ") " << security_
+        << " key subscriptions.";
+}
+
+// The snapshot is written to a temporary file and renamed over the prior,
+// so that a failure leaves the prior snapshot intact.
+void notification_worker::save_subscriptions() const
+{
+    if (settings_.subscription_directory.empty())
+        return;
+
+    const auto file = snapshot_file();
+    const auto temporary = file.string() + ".tmp";
 
-    for (auto it = stealth.begin(); it != stealth.end() &&
-        it->first.updated() < cutoff; it = stealth.erase(it))
     {
-        it->first.increment();
-        expires.push_back(it->first);
+        bc::system::ofstream stream(temporary, std::ios::binary);
+        ostream_writer sink(stream);
+        key_subscriptions_.save(sink);
+        stream.flush();
+
+        if (!stream.good())
+        {
+            LOG_WARNING(LOG_SERVER)
+                << "Failed to save " << security_ << " key subscriptions to "
+                << temporary;
+            return;
+        }
     }
 
-    stealth_mutex_.unlock();
-    ///////////////////////////////////////////////////////////////////////////
+    if (std::rename(temporary.c_str(), file.string().c_str()) != 0)
+        LOG_WARNING(LOG_SERVER)
+            << "Failed to replace " << security_ << " key subscriptions at "
+            << file.string();
+}
 
-    // Send failure is logged in send.
-    if (dealer)
-        for (auto& expire: expires)
-            if (!send(*dealer, expire, notification_stealth, to, 0, null_hash))
-                break;
+microseconds notification_worker::maximum_purge_pause() const
+{
+    return microseconds(maximum_pause_.load());
 }
 
-bool notification_worker::key_subscriptions_empty() const
+size_t notification_worker::key_subscriptions() const
 {
-    ///////////////////////////////////////////////////////////////////////////
-    // Critical Section
-    shared_lock lock(key_mutex_);
+    return key_subscriptions_.size();
+}
+
+size_t notification_worker::stealth_subscriptions() const
+{
+    return stealth_subscriptions_.size();
+}
 
+bool notification_worker::key_subscriptions_empty() const
+{
     return key_subscriptions_.empty();
-    ///////////////////////////////////////////////////////////////////////////
 }
 
 bool notification_worker::stealth_subscriptions_empty() const
 {
-    ///////////////////////////////////////////////////////////////////////////
-    // Critical Section
-    shared_lock lock(stealth_mutex_);
-
     return stealth_subscriptions_.empty();
-    ///////////////////////////////////////////////////////////////////////////
 }
 
 code notification_worker::subscribe_key(const message& request,
-    hash_digest&& key, bool unsubscribe)
+    hash_digest&& key, bool unsubscribe, bool batched, bool transactions)
 {
     if (stopped())
         return error::service_stopped;
 
-    ///////////////////////////////////////////////////////////////////////////
-    // Critical Section
-    key_mutex_.lock_upgrade();
-
-    auto& left = key_subscriptions_.left;
-    auto range = left.equal_range(key);
-
-    // Check each subscription for the given key.
-    // A change to the id is not considered (caller should not change).
-    for (auto it = range.first; it != range.second; ++it)
-    {
-        if (it->second == request.route())
-        {
-            key_mutex_.unlock_upgrade_and_lock();
-            //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-
-            if (unsubscribe)
-                left.erase(it);
-            else
-                it->second.set_updated(current_time());
-
-            //-----------------------------------------------------------------
-            key_mutex_.unlock();
-            return error::success;
-        }
-    }
-
-    // TODO: add independent limits for stealth and key.
-    if (key_subscriptions_.size() >= settings_.subscription_limit)
+    if (unsubscribe)
     {
-        key_mutex_.unlock_upgrade();
-        //---------------------------------------------------------------------
-        return error::oversubscribed;
+        key_subscriptions_.unsubscribe(key, request.route());
+        return error::success;
     }
 
-    key_mutex_.unlock_upgrade_and_lock();
-    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-    key_subscriptions_.insert(
-    {
-        std::move(key),
-        { request.route(), request.id(), current_time() }
-    });
-
-    key_mutex_.unlock();
-    ///////////////////////////////////////////////////////////////////////////
-    return error::success;
+    // A change to the id is not considered (caller should not change).
+    return key_subscriptions_.subscribe(key, request.route(), request.id(),
+        current_time(), batched, transactions);
 }
 
 code notification_worker::subscribe_stealth(const message& request,
@@ -545,51 +819,15 @@ code notification_worker::subscribe_stealth(const message& request,
     if (stopped())
         return error::service_stopped;
 
-    ///////////////////////////////////////////////////////////////////////////
-    // Critical Section
-    stealth_mutex_.lock_upgrade();
-
-    auto& left = stealth_subscriptions_.left;
-    auto range = left.equal_range(prefix_filter);
-
-    // Check each subscription for the given prefix filter.
-    for (auto it = range.first; it != range.second; ++it)
+    if (unsubscribe)
     {
-        if (it->second == request.route())
-        {
-            stealth_mutex_.unlock_upgrade_and_lock();
-            //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-
-            if (unsubscribe)
-                left.erase(it);
-            else
-                it->second.set_updated(current_time());
-
-            //-----------------------------------------------------------------
-            stealth_mutex_.unlock();
-            return error::success;
-        }
+        stealth_subscriptions_.unsubscribe(prefix_filter, request.route());
+        return error::success;
     }
 
-    // TODO: add independent limits for stealth and keys.
-    if (stealth_subscriptions_.size() >= settings_.subscription_limit)
-    {
-        stealth_mutex_.unlock_upgrade();
-        //---------------------------------------------------------------------
-        return error::oversubscribed;
-    }
-
-    stealth_mutex_.unlock_upgrade_and_lock();
-    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-    stealth_subscriptions_.insert(
-    {
-        std::move(prefix_filter),
-        { request.route(), request.id(), current_time() }
-    });
-
-    stealth_mutex_.unlock();
-    ///////////////////////////////////////////////////////////////////////////
-    return error::success;
+    // A change to the id is not considered (caller should not change).
+    return stealth_subscriptions_.subscribe(prefix_filter, request.route(),
+        request.id(), current_time());
 }
 
 } // namespace server
@@ -0,0 +1,254 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/server/workers/query_pool.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <bitcoin/protocol.hpp>
+#include <bitcoin/server/define.hpp>
+#include <bitcoin/server/server_node.hpp>
+#include <bitcoin/server/services/query_service.hpp>
+#include <bitcoin/server/workers/query_worker.hpp>
+
+namespace libbitcoin {
+namespace server {
+
+using namespace bc::protocol;
+using namespace bc::system;
+
+// A worker is added when the oldest query in the backlog has waited this long.
+static const auto grow_wait = std::chrono::milliseconds(10);
+
+// A worker is retired when there has been no backlog for this long.
+static const auto retire_idle = std::chrono::seconds(60);
+
+query_pool::query_pool(zmq::authenticator& authenticator, server_node& node,
+    bool secure, uint16_t instance, size_t limit)
+  : secure_(secure),
+    instance_(instance),
+    authenticator_(authenticator),
+    node_(node),
+    adjusting_(false),
+    stopped_(false),
+    busy_(clock::now())
+{
+    for (size_t index = 0; index < limit; ++index)
+    {
+        const auto empty = std::make_shared<slot>();
+        empty->active = false;
+        empty->retiring = false;
+        slots_.push_back(empty);
+    }
+}
+
+size_t query_pool::slots() const
+{
+    return slots_.size();
+}
+
+query_capacity& query_pool::capacity(size_t slot)
+{
+    return slots_[slot]->capacity;
+}
+
+bool query_pool::dispatchable(size_t slot) const
+{
+    return slots_[slot]->active;
+}
+
+// This is invoked on the service thread.
+void query_pool::adjust(size_t depth, clock::duration wait,
+    clock::time_point now)
+{
+    if (slots_.empty() || stopped_)
+        return;
+
+    if (depth > 0)
+        busy_ = now;
+
+    // A retired worker is reaped before its slot is reused.
+    reap();
+
+    // Only one worker is added or retired at a time.
+    if (adjusting_)
+        return;
+
+    size_t free = slots_.size();
+    size_t active = slots_.size();
+
+    for (size_t index = 0; index < slots_.size(); ++index)
+    {
+        if (slots_[index]->active)
+            active = index;
+        else if (free == slots_.size() && !slots_[index]->retiring)
+            free = index;
+    }
+
+    if (depth > 0 && wait >= grow_wait && free != slots_.size())
+    {
+        adjusting_ = true;
+        node_.thread_pool().service().post(
+            std::bind(&query_pool::grow, this, free));
+    }
+    else if (active != slots_.size() && now - busy_ >= retire_idle)
+    {
+        // Each further retirement requires another idle period.
+        busy_ = now;
+        shrink();
+    }
+}
+
+// This is invoked on a node thread, as a worker start blocks until started.
+void query_pool::grow(size_t index)
+{
+    auto& target = *slots_[index];
+    const auto worker = std::make_shared<query_worker>(authenticator_, node_,
+        target.capacity, query_service::elastic_endpoint(secure_, instance_,
+            index), secure_, instance_);
+
+    if (stopped_ || !worker->start())
+    {
+        adjusting_ = false;
+        return;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    mutex_.lock();
+
+    // The pool may have stopped while the worker was starting.
+    const bool stopped = stopped_;
+
+    if (!stopped)
+        target.worker = worker;
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (stopped)
+    {
+        worker->stop();
+    }
+    else
+    {
+        target.active = true;
+        LOG_DEBUG(LOG_SERVER)
+            << "Added " << (secure_ ? "secure" : "public")
+            << " query worker to slot " << index << " of instance "
+            << instance_;
+    }
+
+    adjusting_ = false;
+}
+
+// This is invoked on the service thread, which dispatches the slots, so the
+// last active slot is no longer dispatched once it is deactivated here. The
+// worker then drains on its own thread, and is reaped once it has retired.
+void query_pool::shrink()
+{
+    for (auto it = slots_.rbegin(); it != slots_.rend(); ++it)
+    {
+        auto& target = **it;
+
+        if (!target.active)
+            continue;
+
+        target.active = false;
+        target.retiring = true;
+        adjusting_ = true;
+
+        ///////////////////////////////////////////////////////////////////////
+        // Critical Section
+        shared_lock lock(mutex_);
+
+        if (target.worker)
+            target.worker->retire();
+        ///////////////////////////////////////////////////////////////////////
+
+        return;
+    }
+}
+
+// This is invoked on the service thread, the retired worker thread has
+// exited, so its stop does not wait.
+void query_pool::reap()
+{
+    for (const auto& target: slots_)
+    {
+        if (!target->retiring)
+            continue;
+
+        query_worker::ptr worker;
+
+        ///////////////////////////////////////////////////////////////////////
+        // Critical Section
+        mutex_.lock();
+
+        if (target->worker && target->worker->retired())
+            worker.swap(target->worker);
+
+        mutex_.unlock();
+        ///////////////////////////////////////////////////////////////////////
+
+        if (!worker)
+            continue;
+
+        worker->stop();
+        target->retiring = false;
+        adjusting_ = false;
+
+        LOG_DEBUG(LOG_SERVER)
+            << "Retired " << (secure_ ? "secure" : "public")
+            << " query worker from instance " << instance_;
+    }
+}
+
+// This is invoked on the service thread as it exits, so no adjustment is
+// posted after stop, though one may be in progress.
+void query_pool::stop()
+{
+    std::vector<query_worker::ptr> workers;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    mutex_.lock();
+    stopped_ = true;
+
+    for (const auto& target: slots_)
+    {
+        target->active = false;
+
+        if (target->worker)
+            workers.push_back(target->worker);
+
+        target->worker.reset();
+    }
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    for (const auto worker: workers)
+        worker->stop();
+}
+
+} // namespace server
+} // namespace libbitcoin
@@ -18,8 +18,12 @@
  */
 #include <bitcoin/server/workers/query_worker.hpp>
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <string>
+#include <utility>
 #include <bitcoin/protocol.hpp>
 #include <bitcoin/server/define.hpp>
 #include <bitcoin/server/interface/blockchain.hpp>
@@ -29,6 +33,8 @@
 #include <bitcoin/server/interface/unsubscribe.hpp>
 #include <bitcoin/server/messages/message.hpp>
 #include <bitcoin/server/server_node.hpp>
+#include <bitcoin/server/utility/compressor.hpp>
+#include <bitcoin/server/utility/thread_affinity.hpp>
 
 namespace libbitcoin {
 namespace server {
@@ -38,17 +44,38 @@ using namespace bc::protocol;
 using namespace bc::system;
 using role = zmq::socket::role;
 
+// The period at which a saturated worker rechecks its in flight queries.
+static constexpr int32_t saturated_wait = 1;
+
+// The period at which a retiring worker rechecks its outstanding queries.
+static constexpr int32_t retire_wait = 100;
+
+// Each command is also attached with this suffix, answered compressed.
+static const std::string compressed_suffix(".lz4");
+
 query_worker::query_worker(zmq::authenticator& authenticator,
-    server_node& node, bool secure)
+    server_node& node, query_capacity& capacity,
+    const config::endpoint& endpoint, bool secure, uint16_t instance)
   : worker(priority(node.server_settings().priority)),
     secure_(secure),
+    instance_(instance),
     security_(secure ? "secure" : "public"),
     settings_(node.server_settings()),
     external_(node.protocol_settings()),
     internal_(external_.send_high_water, external_.receive_high_water),
-    worker_(query_service::worker_endpoint(secure)),
+    worker_(endpoint),
+    responses_(responses_endpoint(secure)),
     authenticator_(authenticator),
-    node_(node)
+    node_(node),
+    metrics_(node.metrics()),
+    tracer_(node.tracer()),
+    recorder_(node.recorder()),
+    capacity_(capacity),
+    pusher_(authenticator, role::pusher, responses_, internal_),
+    in_flight_(0),
+    outstanding_(0),
+    retiring_(false),
+    retired_(false)
 {
     // The same interface is attached to the secure and public interfaces.
     attach_interface();
@@ -59,27 +86,88 @@ query_worker::query_worker(zmq::authenticator& authenticator,
 // The dealer drops messages for lost peers (query service) and high water.
 void query_worker::work()
 {
+    thread_affinity::pin(settings_.query_worker_cores,
+        security_ + " query worker");
+
     // Use a dealer for this synchronous response because notifications are
     // sent asynchronously to the same identity via the same dealer. Using a
     // router is okay but it adds an additional address to the envelope that
     // would have to be stripped by the notification dealer so this is simpler.
     zmq::socket dealer(authenticator_, role::dealer, internal_);
+    zmq::socket puller(authenticator_, role::puller, internal_);
 
-    // Connect socket to the service endpoint.
-    if (!started(connect(dealer)))
+    // Connect socket to the service endpoint, bind the response queue.
+    if (!started(connect(dealer) && bind(puller)))
         return;
 
-    zmq::poller poller;
-    poller.add(dealer);
+    // Queries are accepted only while below the configured concurrency.
+    zmq::poller all;
+    all.add(dealer);
+    all.add(puller);
+
+    zmq::poller responses;
+    responses.add(puller);
 
-    while (!poller.terminated() && !stopped())
+    // A retiring worker is no longer dispatched, but continues to read and
+    // answer the queries dispatched to its lane before it disconnects.
+    while (!stopped() && !(retiring_ && drained()))
     {
-        if (poller.wait().contains(dealer.id()))
+        // While saturated, poll responses briefly to recheck concurrency.
+        const auto accept = accepting();
+        auto& poller = accept ? all : responses;
+        const auto signaled = poller.wait(!accept ? saturated_wait :
+            (retiring_ ? retire_wait : -1));
+
+        if (poller.terminated())
+            break;
+
+        if (signaled.contains(puller.id()))
+            respond(puller, dealer);
+
+        if (signaled.contains(dealer.id()))
             query(dealer);
     }
 
-    // Disconnect the socket and exit this thread.
-    finished(disconnect(dealer));
+    // Every response is queued before its send handler is released.
+    if (retiring_)
+        flush(dealer);
+
+    // The cached pusher must be closed for the context to terminate.
+    const auto pusher_stop = pusher_.stop();
+
+    // Disconnect the sockets and exit this thread.
+    const auto puller_stop = unbind(puller);
+    const auto dealer_stop = disconnect(dealer);
+    retired_ = retiring_.load();
+    finished(dealer_stop && puller_stop && pusher_stop);
+}
+
+// The retiring worker is signaled through its own response queue, so that it
+// observes retirement while polling without a timeout.
+void query_worker::retire()
+{
+    retiring_ = true;
+    const auto ec = pusher_.send(
+        std::bind(&query_worker::signal,
+            _1));
+
+    if (ec && ec != error::service_stopped)
+        LOG_WARNING(LOG_SERVER)
+            << "Failed to signal " << security_ << " query worker retirement: "
+            << ec.message();
+}
+
+bool query_worker::retired() const
+{
+    return retired_;
+}
+
+// A unique inproc endpoint for the responses of each worker.
+std::string query_worker::responses_endpoint(bool secure)
+{
+    static std::atomic<size_t> instance(0);
+    return std::string("inproc://query_responses_") +
+        (secure ? "secure_" : "public_") + std::to_string(instance++);
 }
 
 // Connect/Disconnect.
@@ -102,6 +190,32 @@ bool query_worker::connect(zmq::socket& dealer)
     return true;
 }
 
+bool query_worker::bind(zmq::socket& puller)
+{
+    const auto ec = puller.bind(responses_);
+
+    if (ec)
+    {
+        LOG_ERROR(LOG_SERVER)
+            << "Failed to bind " << security_ << " query worker to "
+            << responses_ << " : " << ec.message();
+        return false;
+    }
+
+    return true;
+}
+
+bool query_worker::unbind(zmq::socket& puller)
+{
+    // Don't log stop success.
+    if (puller.stop())
+        return true;
+
+    LOG_ERROR(LOG_SERVER)
+        << "Failed to unbind " << security_ << " query worker.";
+    return false;
+}
+
 bool query_worker::disconnect(zmq::socket& dealer)
 {
     // Don't log stop success.
@@ -117,15 +231,26 @@ bool query_worker::disconnect(zmq::socket& dealer)
 // The dealer send blocks until the query service dealer is available.
 //-----------------------------------------------------------------------------
 
-// private/static
-void query_worker::send(const message& response, zmq::socket& dealer)
+// Compress and send a response produced on the worker thread.
+void query_worker::send(message&& response, zmq::socket& dealer)
+{
+    deliver(compressor::compress_response(std::move(response)), dealer);
+}
+
+// The response is compressed by its producer, this only sends it.
+void query_worker::deliver(message&& outgoing, zmq::socket& dealer)
 {
-    const auto ec = response.send(dealer);
+    metrics_.respond(outgoing);
+    tracer_.respond(outgoing);
+    const auto ec = outgoing.transfer(dealer);
+
+    if (ec)
+        metrics_.dropped();
 
     if (ec && ec != error::service_stopped)
         LOG_WARNING(LOG_SERVER)
             << "Failed to send query response to "
-            << response.route().display() << " " << ec.message();
+            << outgoing.route().display() << " " << ec.message();
 }
 
 // Because the socket is a router we may simply drop invalid queries.
@@ -136,7 +261,7 @@ void query_worker::query(zmq::socket& dealer)
     if (stopped())
         return;
 
-    message request(secure_);
+    message request(secure_, instance_);
     const auto ec = request.receive(dealer);
 
     if (ec == error::service_stopped)
@@ -149,6 +274,7 @@ void query_worker::query(zmq::socket& dealer)
             << " " << ec.message();
 
         send(message(request, ec), dealer);
+        capacity_.completed();
         return;
     }
 
@@ -161,6 +287,7 @@ void query_worker::query(zmq::socket& dealer)
             << "Invalid query command from " << request.route().display();
 
         send(message(request, error::not_found), dealer);
+        capacity_.completed();
         return;
     }
 
@@ -168,30 +295,155 @@ void query_worker::query(zmq::socket& dealer)
         << "Query " << request.command() << " from "
         << request.route().display();
 
-    // The query executor is the delegate bound by the attach method.
+    // The query executor is the interface method registered by attach.
     const auto& query_execute = handler->second;
 
-    // Execute the request and send the result.
-    // Example: address.renew(node_, request, sender);
-    // Example: blockchain.fetch_history4(node_, request, sender);
-    query_execute(request,
-        std::bind(&query_worker::send,
-            _1, std::ref(dealer)));
+    metrics_.dispatch(request.command());
+    tracer_.sample(request);
+    recorder_.capture(request);
+
+    // Zero concurrency executes each query on this thread, in order.
+    if (settings_.query_concurrency == 0)
+    {
+        // Execute the request and send the result.
+        // Example: address.renew(node_, request, sender);
+        // Example: blockchain.fetch_history4(node_, request, sender);
+        request.executing();
+        query_execute(node_, request,
+            std::bind(&query_worker::send,
+                outstanding(), _1, std::ref(dealer)));
+
+        metrics_.complete(request.command());
+        capacity_.completed();
+        return;
+    }
+
+    // Execute the request on the node threadpool, the response is relayed.
+    // The request is moved to a shared handle, so that the posted handler
+    // (which must be copyable) does not copy its command, route or payload.
+    ++in_flight_;
+    const auto shared = std::make_shared<const message>(std::move(request));
+    node_.thread_pool().service().post(
+        std::bind(&query_worker::execute,
+            this, query_execute, shared));
+}
+
+bool query_worker::accepting() const
+{
+    const auto limit = settings_.query_concurrency;
+    return limit == 0 || in_flight_ < limit;
+}
+
+// The lane is drained once every query dispatched to it has completed (this
+// includes those not yet read), and no send handler of a query is retained.
+bool query_worker::drained() const
+{
+    return capacity_.outstanding() == 0 && outstanding_ == 0;
+}
+
+// The send handler of a query binds this ticket, which is released with the
+// last copy of the handler, so the query remains outstanding until then.
+std::shared_ptr<query_worker> query_worker::outstanding()
+{
+    ++outstanding_;
+    return std::shared_ptr<query_worker>(this, [](query_worker* worker)
+    {
+        --worker->outstanding_;
+    });
+}
+
+// This is invoked on a node thread.
+// A query is in flight until its handler returns, as a query may produce
+// any number of responses (including asynchronously or not at all).
+void query_worker::execute(command_handler handler,
+    std::shared_ptr<const message> request)
+{
+    request->executing();
+    handler(node_, *request,
+        std::bind(&query_worker::enqueue,
+            outstanding(), _1));
+
+    metrics_.complete(request->command());
+    capacity_.completed();
+    --in_flight_;
+}
+
+// private/static
+code query_worker::signal(zmq::socket& pusher)
+{
+    zmq::message signal;
+    signal.enqueue();
+    return pusher.send(signal);
+}
+
+// This may be invoked on any thread, the cached pusher is serialized.
+// Compression is performed on the calling thread, outside of the lock.
+void query_worker::enqueue(message&& response)
+{
+    auto outgoing = compressor::compress_response(std::move(response));
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    pending_mutex_.lock();
+    pending_.push_back(std::move(outgoing));
+    pending_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // A signal may drain any number of responses, including none.
+    const auto ec = pusher_.send(
+        std::bind(&query_worker::signal,
+            _1));
+
+    if (ec && ec != error::service_stopped)
+        LOG_WARNING(LOG_SERVER)
+            << "Failed to signal " << security_ << " query response: "
+            << ec.message();
+}
+
+// Receive a response signal and send all queued responses.
+void query_worker::respond(zmq::socket& puller, zmq::socket& dealer)
+{
+    zmq::message signal;
+    const auto ec = puller.receive(signal);
+
+    if (ec && ec != error::service_stopped)
+        LOG_WARNING(LOG_SERVER)
+            << "Failed to receive query response signal: " << ec.message();
+
+    flush(dealer);
+}
+
+// Send all queued responses to the dealer, moving each payload.
+void query_worker::flush(zmq::socket& dealer)
+{
+    std::deque<message> responses;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    pending_mutex_.lock();
+    responses.swap(pending_);
+    pending_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    for (auto& response: responses)
+        deliver(std::move(response), dealer);
 }
 
 // Query Interface.
 // ----------------------------------------------------------------------------
 
 // Class and method names must match protocol expectations (do not change).
-#define ATTACH(class_name, method_name, node) \
+#define ATTACH(class_name, method_name) \
     attach(#class_name "." #method_name, \
-        std::bind(&bc::server::class_name::method_name, \
-            std::ref(node), _1, _2));
+        &bc::server::class_name::method_name)
 
 void query_worker::attach(const std::string& command,
     command_handler handler)
 {
     command_handlers_[command] = handler;
+    command_handlers_[command + compressed_suffix] = handler;
+    metrics_.attach(command);
+    metrics_.attach(command + compressed_suffix);
 }
 
 //=============================================================================
@@ -212,17 +464,26 @@ void query_worker::attach(const std::string& command,
 // blockchain.fetch_history2 is obsoleted in v3.1 (version byte unused)
 // blockchain.fetch_history3 is new in v3.1 (no version byte)
 // blockchain.fetch_history4 is new in v4.0.
+// blockchain.fetch_history5 is new in v4.0 (paged, streamed in chunks).
+// blockchain.fetch_history_batch is new in v4.0 (many keys).
 // blockchain.fetch_stealth is obsoleted in v3 (hash reversal).
 // blockchain.fetch_stealth2 is new in v3.
 // blockchain.fetch_stealth2 is obsoleted in v4.
 // blockchain.fetch_stealth_transaction_hashes is new in v3 (safe version).
 // blockchain.fetch_stealth_transaction_hashes is obsoleted in v4.
 // blockchain.fetch_block (full) is new in v4.
+// blockchain.fetch_block_chunks (streamed in chunks) is new in v4.
+// Each command suffixed with .lz4 (compressed response) is new in v4.
+// blockchain.fetch_block_headers (packed height range) is new in v4.
+// blockchain.fetch_transactions (many hashes) is new in v4.
+// blockchain.fetch_spends (many outpoints) is new in v4.
+// blockchain.fetch_compact_filters (streamed height range) is new in v4.
 //-----------------------------------------------------------------------------
 // transaction_pool.validate is obsoleted in v3 (unconfirmed outputs).
 // transaction_pool.validate2 is new in v3.
 // transaction_pool.broadcast is new in v3 (rename).
 // transaction_pool.fetch_transaction is enhanced in v3 (adds confirmed txs).
+// transaction_pool.fetch_history (unconfirmed tx hashes) is new in v4.
 //-----------------------------------------------------------------------------
 // protocol.broadcast_transaction is obsoleted in v3 (renamed).
 // protocol.total_connections is obsoleted in v3 (administrative).
@@ -230,6 +491,8 @@ void query_worker::attach(const std::string& command,
 // subscribe.address is new in v3, also call for renew.
 // subscribe.address is obsoleted in v4 (see subscribe.key).
 // subscribe.key is new in v4, also call for renew.
+// subscribe.key2 is new in v4 (batched subscribe.key), also call for renew.
+// subscribe.key_transactions is new in v4 (subscribe.key with transactions).
 // subscribe.stealth is new in v3, also call for renew.
 // subscribe.stealth is obsoleted in v4.
 //-----------------------------------------------------------------------------
@@ -244,55 +507,67 @@ void query_worker::attach(const std::string& command,
 // subscribe.heartbeat (pub-sub) is new in v3.4.
 //-----------------------------------------------------------------------------
 // server.version is new in v4.
+// server.stats (plaintext query metrics) is new in v4.
 //=============================================================================
 // Interface class.method names must match protocol names.
 void query_worker::attach_interface()
 {
     // Subscription was not operational in version 3.0.
-    ////ATTACH(address, renew, node_);                    // obsoleted (3.0)
-    ////ATTACH(address, subscribe, node_);                // obsoleted (3.0)
-    ////ATTACH(address, fetch_history, node_);            // obsoleted (3.0)
-    ////ATTACH(subscribe, address, node_);     // new (3.1), obsoleted (4.0)
-    ////ATTACH(unsubscribe, address, node_);   // new (3.1), obsoleted (4.0)
-    ////ATTACH(subscribe, stealth, node_);     // new (3.1), obsoleted (4.0)
-    ////ATTACH(unsubscribe, stealth, node_);   // new (3.1), obsoleted (4.0)
-
-    ATTACH(subscribe, key, node_);                              // new (4.0)
-    ATTACH(unsubscribe, key, node_);                            // new (4.0)
-
-    ////ATTACH(blockchain, fetch_stealth, node_);               // obsoleted
-    ////ATTACH(blockchain, fetch_history, node_);               // obsoleted
-    ////ATTACH(blockchain, fetch_history2, node_);              // obsoleted
-    ////ATTACH(blockchain, fetch_stealth2, node_);
+    ////ATTACH(address, renew);                           // obsoleted (3.0)
+    ////ATTACH(address, subscribe);                       // obsoleted (3.0)
+    ////ATTACH(address, fetch_history);                   // obsoleted (3.0)
+    ////ATTACH(subscribe, address);            // new (3.1), obsoleted (4.0)
+    ////ATTACH(unsubscribe, address);          // new (3.1), obsoleted (4.0)
+    ////ATTACH(subscribe, stealth);            // new (3.1), obsoleted (4.0)
+    ////ATTACH(unsubscribe, stealth);          // new (3.1), obsoleted (4.0)
+
+    ATTACH(subscribe, key);                                     // new (4.0)
+    ATTACH(subscribe, key2);                                    // new (4.0)
+    ATTACH(subscribe, key_transactions);                        // new (4.0)
+    ATTACH(unsubscribe, key);                                   // new (4.0)
+
+    ////ATTACH(blockchain, fetch_stealth);                      // obsoleted
+    ////ATTACH(blockchain, fetch_history);                      // obsoleted
+    ////ATTACH(blockchain, fetch_history2);                     // obsoleted
+    ////ATTACH(blockchain, fetch_stealth2);
     ////                                       // new (3.0), obsoleted (4.0)
-    ////ATTACH(blockchain, fetch_stealth_transaction_hashes, node_);
+    ////ATTACH(blockchain, fetch_stealth_transaction_hashes);
     ////                                       // new (3.0), obsoleted (4.0)
-    ATTACH(blockchain, fetch_block, node_);                     // new (4.0)
-    ATTACH(blockchain, fetch_block_header, node_);              // original
-    ATTACH(blockchain, fetch_block_height, node_);              // original
-    ATTACH(blockchain, fetch_block_transaction_hashes, node_);  // original
-    ATTACH(blockchain, fetch_last_height, node_);               // original
-    ATTACH(blockchain, fetch_transaction, node_);               // original
-    ATTACH(blockchain, fetch_transaction2, node_);              // new (3.4)
-    ATTACH(blockchain, fetch_transaction_index, node_);         // original
-    ATTACH(blockchain, fetch_spend, node_);                     // original
-    ATTACH(blockchain, fetch_history4, node_);                  // new (4.0)
-    ATTACH(blockchain, broadcast, node_);                       // new (3.0)
-    ATTACH(blockchain, validate, node_);                        // new (3.0)
-    ATTACH(blockchain, fetch_compact_filter, node_);            // new (4.0)
-    ATTACH(blockchain, fetch_compact_filter_checkpoint, node_); // new (4.0)
-    ATTACH(blockchain, fetch_compact_filter_headers, node_);    // new (4.0)
-
-    ////ATTACH(transaction_pool, validate, node_);              // obsoleted
-    ATTACH(transaction_pool, fetch_transaction, node_);         // enhanced (3.0)
-    ATTACH(transaction_pool, fetch_transaction2, node_);        // new (3.4)
-    ATTACH(transaction_pool, broadcast, node_);                 // new (3.0)
-    ATTACH(transaction_pool, validate2, node_);                 // new (3.0)
-
-    ATTACH(server, version, node_);                             // new (4.0)
-
-    ////ATTACH(protocol, broadcast_transaction, node_);         // obsoleted
-    ////ATTACH(protocol, total_connections, node_);             // obsoleted
+    ATTACH(blockchain, fetch_block);                            // new (4.0)
+    ATTACH(blockchain, fetch_block_chunks);                     // new (4.0)
+    ATTACH(blockchain, fetch_block_header);                     // original
+    ATTACH(blockchain, fetch_block_headers);                    // new (4.0)
+    ATTACH(blockchain, fetch_block_height);                     // original
+    ATTACH(blockchain, fetch_block_transaction_hashes);         // original
+    ATTACH(blockchain, fetch_last_height);                      // original
+    ATTACH(blockchain, fetch_transaction);                      // original
+    ATTACH(blockchain, fetch_transaction2);                     // new (3.4)
+    ATTACH(blockchain, fetch_transactions);                     // new (4.0)
+    ATTACH(blockchain, fetch_transaction_index);                // original
+    ATTACH(blockchain, fetch_spend);                            // original
+    ATTACH(blockchain, fetch_spends);                           // new (4.0)
+    ATTACH(blockchain, fetch_history4);                         // new (4.0)
+    ATTACH(blockchain, fetch_history5);                         // new (4.0)
+    ATTACH(blockchain, fetch_history_batch);                    // new (4.0)
+    ATTACH(blockchain, broadcast);                              // new (3.0)
+    ATTACH(blockchain, validate);                               // new (3.0)
+    ATTACH(blockchain, fetch_compact_filter);                   // new (4.0)
+    ATTACH(blockchain, fetch_compact_filter_checkpoint);        // new (4.0)
+    ATTACH(blockchain, fetch_compact_filter_headers);           // new (4.0)
+    ATTACH(blockchain, fetch_compact_filters);                  // new (4.0)
+
+    ////ATTACH(transaction_pool, validate);                     // obsoleted
+    ATTACH(transaction_pool, fetch_transaction);                // enhanced (3.0)
+    ATTACH(transaction_pool, fetch_transaction2);               // new (3.4)
+    ATTACH(transaction_pool, fetch_history);                    // new (4.0)
+    ATTACH(transaction_pool, broadcast);                        // new (3.0)
+    ATTACH(transaction_pool, validate2);                        // new (3.0)
+
+    ATTACH(server, version);                                    // new (4.0)
+    ATTACH(server, stats);                                      // new (4.0)
+
+    ////ATTACH(protocol, broadcast_transaction);                // obsoleted
+    ////ATTACH(protocol, total_connections);                    // obsoleted
 }
 
 #undef ATTACH
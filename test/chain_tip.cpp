@@ -0,0 +1,79 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+using namespace bc::system;
+using namespace bc::system::chain;
+
+BOOST_AUTO_TEST_SUITE(chain_tip_tests)
+
+BOOST_AUTO_TEST_CASE(chain_tip__construct__empty)
+{
+    const chain_tip instance;
+    data_chunk out;
+    BOOST_REQUIRE_EQUAL(instance.height(), 0u);
+    BOOST_REQUIRE(instance.hash() == null_hash);
+    BOOST_REQUIRE(!instance.find(out, 0));
+}
+
+BOOST_AUTO_TEST_CASE(chain_tip__set__hash__no_header_response)
+{
+    chain_tip instance;
+    const auto hash = hash_literal(
+        "000000000019d6689c085ae165831e934ff763ae46a2a6c172b3f1b60a8ce26f");
+    instance.set(42, hash);
+    data_chunk out;
+    BOOST_REQUIRE_EQUAL(instance.height(), 42u);
+    BOOST_REQUIRE(instance.hash() == hash);
+    BOOST_REQUIRE(!instance.find(out, 42));
+    BOOST_REQUIRE(!instance.find(out, hash));
+}
+
+BOOST_AUTO_TEST_CASE(chain_tip__set__header__found_by_height_and_hash)
+{
+    chain_tip instance;
+    const header tip(1, null_hash, null_hash, 2, 3, 4);
+    instance.set(7, tip);
+    data_chunk out;
+    BOOST_REQUIRE(instance.hash() == tip.hash());
+    BOOST_REQUIRE(instance.find(out, 7));
+    BOOST_REQUIRE_EQUAL(out.size(), sizeof(uint32_t) + 80u);
+    out.clear();
+    BOOST_REQUIRE(instance.find(out, tip.hash()));
+    BOOST_REQUIRE(!instance.find(out, 6));
+}
+
+BOOST_AUTO_TEST_CASE(chain_tip__stale__within_interval__false)
+{
+    chain_tip instance;
+    const auto interval = std::chrono::seconds(1);
+    const auto now = chain_tip::clock::now();
+    BOOST_REQUIRE(instance.stale(now, interval));
+    BOOST_REQUIRE(!instance.stale(now, interval));
+    BOOST_REQUIRE(!instance.stale(now + interval / 2, interval));
+    BOOST_REQUIRE(instance.stale(now + interval, interval));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
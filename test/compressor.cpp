@@ -0,0 +1,129 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+using namespace bc::system;
+
+BOOST_AUTO_TEST_SUITE(compressor_tests)
+
+BOOST_AUTO_TEST_CASE(compressor__compress__empty__size_and_empty_token)
+{
+    const auto compressed = compressor::compress({});
+    BOOST_REQUIRE_EQUAL(compressed.size(), sizeof(uint32_t) + 1u);
+    BOOST_REQUIRE_EQUAL(compressed.back(), 0u);
+
+    data_chunk out{ 42 };
+    BOOST_REQUIRE(compressor::decompress(out, compressed));
+    BOOST_REQUIRE(out.empty());
+}
+
+BOOST_AUTO_TEST_CASE(compressor__compress__short__literals_round_trip)
+{
+    const data_chunk data{ 1, 2, 3, 4, 5, 6, 7 };
+    data_chunk out;
+    BOOST_REQUIRE(compressor::decompress(out, compressor::compress(data)));
+    BOOST_REQUIRE(out == data);
+}
+
+BOOST_AUTO_TEST_CASE(compressor__compress__repetitive__smaller_round_trip)
+{
+    data_chunk data;
+    for (size_t index = 0; index < 100000; ++index)
+        data.push_back(static_cast<uint8_t>(index % 251 < 200 ? 0 : index));
+
+    const auto compressed = compressor::compress(data);
+    BOOST_REQUIRE_LT(compressed.size(), data.size() / 4);
+
+    data_chunk out;
+    BOOST_REQUIRE(compressor::decompress(out, compressed));
+    BOOST_REQUIRE(out == data);
+}
+
+BOOST_AUTO_TEST_CASE(compressor__decompress__truncated__false)
+{
+    data_chunk data(1000, 7);
+    auto compressed = compressor::compress(data);
+    compressed.resize(compressed.size() - 1);
+
+    data_chunk out;
+    BOOST_REQUIRE(!compressor::decompress(out, compressed));
+    BOOST_REQUIRE(!compressor::decompress(out, data_chunk{ 1, 2 }));
+}
+
+BOOST_AUTO_TEST_CASE(compressor__compress_response__code_only__unchanged)
+{
+    const data_chunk payload{ 1, 0, 0, 0 };
+    BOOST_REQUIRE(compressor::compress_response(payload) == payload);
+}
+
+BOOST_AUTO_TEST_CASE(compressor__compress_response__body__code_retained)
+{
+    data_chunk payload{ 0, 0, 0, 0 };
+    payload.resize(payload.size() + 500, 9);
+    const auto response = compressor::compress_response(payload);
+    BOOST_REQUIRE_LT(response.size(), payload.size());
+    BOOST_REQUIRE_EQUAL(response[0], 0u);
+
+    data_chunk out;
+    const data_chunk body(response.begin() + 4, response.end());
+    BOOST_REQUIRE(compressor::decompress(out, body));
+    BOOST_REQUIRE(out == data_chunk(payload.begin() + 4, payload.end()));
+}
+
+BOOST_AUTO_TEST_CASE(compressor__compress_response__plain_command__unchanged)
+{
+    data_chunk payload{ 0, 0, 0, 0 };
+    payload.resize(payload.size() + 500, 9);
+    const subscription subscriber({}, 42, 0);
+    auto response = compressor::compress_response(
+        message(subscriber, "blockchain.fetch_block", data_chunk(payload)));
+    BOOST_REQUIRE(!response.compressed());
+    BOOST_REQUIRE(response.data() == payload);
+}
+
+// The pipelined path compresses when enqueued and again passes the response
+// through the worker send, which must not compress it a second time.
+BOOST_AUTO_TEST_CASE(compressor__compress_response__pipelined__decodes_once)
+{
+    data_chunk payload{ 0, 0, 0, 0 };
+    payload.resize(payload.size() + 500, 9);
+    const subscription subscriber({}, 42, 0);
+    auto enqueued = compressor::compress_response(
+        message(subscriber, "blockchain.fetch_block.lz4", data_chunk(payload)));
+    BOOST_REQUIRE(enqueued.compressed());
+
+    const auto response = compressor::compress_response(std::move(enqueued));
+    BOOST_REQUIRE_EQUAL(response.command(), "blockchain.fetch_block.lz4");
+    BOOST_REQUIRE_EQUAL(response.id(), 42u);
+    BOOST_REQUIRE_EQUAL(response.data()[0], 0u);
+
+    data_chunk out;
+    const data_chunk body(response.data().begin() + 4, response.data().end());
+    BOOST_REQUIRE(compressor::decompress(out, body));
+    BOOST_REQUIRE(out == data_chunk(payload.begin() + 4, payload.end()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
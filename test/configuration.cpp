@@ -0,0 +1,47 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+using namespace bc::system;
+
+BOOST_AUTO_TEST_SUITE(configuration_tests)
+
+BOOST_AUTO_TEST_CASE(configuration__disable_sessions__mainnet__no_sessions)
+{
+    configuration instance(config::settings::mainnet);
+    instance.network.inbound_port = 8333;
+    instance.network.inbound_connections = 100;
+    instance.network.outbound_connections = 8;
+    instance.network.host_pool_capacity = 10000;
+    instance.network.peers.push_back({ "127.0.0.1", 8333 });
+    instance.disable_sessions();
+
+    // Inbound, outbound and seeding are not configured, manual has no peers.
+    BOOST_REQUIRE_EQUAL(instance.network.inbound_port, 0u);
+    BOOST_REQUIRE_EQUAL(instance.network.inbound_connections, 0u);
+    BOOST_REQUIRE_EQUAL(instance.network.outbound_connections, 0u);
+    BOOST_REQUIRE_EQUAL(instance.network.host_pool_capacity, 0u);
+    BOOST_REQUIRE(instance.network.peers.empty());
+    BOOST_REQUIRE(instance.network.seeds.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
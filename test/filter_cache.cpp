@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+using namespace bc::system;
+
+BOOST_AUTO_TEST_SUITE(filter_cache_tests)
+
+static filter_cache::filters make_filters(size_t height, size_t count)
+{
+    filter_cache::filters out;
+
+    for (auto index = height; index < height + count; ++index)
+    {
+        hash_digest block_hash = null_hash;
+        block_hash.front() = static_cast<uint8_t>(index + 1);
+        out.push_back(std::make_shared<system::message::compact_filter>(
+            filter_cache::filter_type, block_hash, data_chunk{ 0x01 }));
+    }
+
+    return out;
+}
+
+static hash_digest block_hash(size_t height)
+{
+    return make_filters(height, 1).front()->block_hash();
+}
+
+BOOST_AUTO_TEST_CASE(filter_cache__write__contiguous__reads_headers)
+{
+    filter_cache instance(true);
+    instance.write(0, make_filters(0, 3), instance.generation());
+    BOOST_REQUIRE_EQUAL(instance.size(), 3u);
+
+    system::message::compact_filter_headers first;
+    BOOST_REQUIRE(instance.read(first, filter_cache::filter_type, 0, 2));
+    BOOST_REQUIRE(first.previous_filter_header() == null_hash);
+    BOOST_REQUIRE_EQUAL(first.filter_hashes().size(), 3u);
+    BOOST_REQUIRE(first.stop_hash() == block_hash(2));
+
+    system::message::compact_filter_headers second;
+    BOOST_REQUIRE(instance.read(second, filter_cache::filter_type, 1,
+        block_hash(2)));
+    BOOST_REQUIRE_EQUAL(second.filter_hashes().size(), 2u);
+    BOOST_REQUIRE(second.previous_filter_header() != null_hash);
+    BOOST_REQUIRE(!instance.read(second, filter_cache::filter_type, 1, 3));
+}
+
+BOOST_AUTO_TEST_CASE(filter_cache__write__gap_overlap_or_disabled__appends_only_contiguous)
+{
+    filter_cache disabled(false);
+    disabled.write(0, make_filters(0, 1), disabled.generation());
+    BOOST_REQUIRE_EQUAL(disabled.size(), 0u);
+
+    filter_cache instance(true);
+    instance.write(1, make_filters(1, 1), instance.generation());
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+
+    instance.write(0, make_filters(0, 2), instance.generation());
+    instance.write(1, make_filters(1, 3), instance.generation());
+    BOOST_REQUIRE_EQUAL(instance.size(), 4u);
+}
+
+BOOST_AUTO_TEST_CASE(filter_cache__reorganize__popped__truncates_and_rejects_stale)
+{
+    filter_cache instance(true);
+    const auto generation = instance.generation();
+    instance.write(0, make_filters(0, 4), generation);
+
+    instance.reorganize(1, true);
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+
+    system::message::compact_filter_checkpoint checkpoint;
+    BOOST_REQUIRE(!instance.read(checkpoint, filter_cache::filter_type,
+        block_hash(3)));
+
+    instance.write(2, make_filters(2, 1), generation);
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+
+    instance.write(2, make_filters(2, 1), instance.generation());
+    BOOST_REQUIRE_EQUAL(instance.size(), 3u);
+}
+
+BOOST_AUTO_TEST_CASE(filter_cache__read__checkpoint_below_interval__empty)
+{
+    filter_cache instance(true);
+    instance.write(0, make_filters(0, 2), instance.generation());
+
+    system::message::compact_filter_checkpoint checkpoint;
+    BOOST_REQUIRE(instance.read(checkpoint, filter_cache::filter_type,
+        block_hash(1)));
+    BOOST_REQUIRE(checkpoint.filter_headers().empty());
+    BOOST_REQUIRE(!instance.read(checkpoint, 1, block_hash(1)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,94 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+using namespace bc::system;
+
+BOOST_AUTO_TEST_SUITE(header_cache_tests)
+
+static data_chunk make_headers(size_t count)
+{
+    data_chunk out;
+
+    for (uint32_t nonce = 0; nonce < count; ++nonce)
+    {
+        const chain::header header{ 1, null_hash, null_hash, 0, 0, nonce };
+        extend_data(out, header.to_data());
+    }
+
+    return out;
+}
+
+BOOST_AUTO_TEST_CASE(header_cache__write__contiguous__reads_range)
+{
+    header_cache instance(true);
+    instance.write(0, make_headers(3), instance.generation());
+    BOOST_REQUIRE_EQUAL(instance.size(), 3u);
+
+    data_chunk out;
+    BOOST_REQUIRE_EQUAL(instance.read(out, 1, 5), 2u);
+    BOOST_REQUIRE_EQUAL(out.size(), 2u * header_cache::header_size);
+    BOOST_REQUIRE_EQUAL(instance.read(out, 3, 1), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(header_cache__write__gap_or_disabled__rejected)
+{
+    header_cache disabled(false);
+    disabled.write(0, make_headers(1), disabled.generation());
+    BOOST_REQUIRE_EQUAL(disabled.size(), 0u);
+
+    header_cache instance(true);
+    instance.write(1, make_headers(1), instance.generation());
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(header_cache__reorganize__popped__truncates_and_rejects_stale)
+{
+    header_cache instance(true);
+    const auto generation = instance.generation();
+    instance.write(0, make_headers(4), generation);
+
+    const auto block = std::make_shared<const system::message::block>();
+    instance.reorganize(1, { block }, true);
+    BOOST_REQUIRE_EQUAL(instance.size(), 3u);
+
+    instance.write(3, make_headers(1), generation);
+    BOOST_REQUIRE_EQUAL(instance.size(), 3u);
+
+    instance.write(3, make_headers(1), instance.generation());
+    BOOST_REQUIRE_EQUAL(instance.size(), 4u);
+}
+
+BOOST_AUTO_TEST_CASE(header_cache__reorganize__above_top__not_appended)
+{
+    header_cache instance(true);
+    instance.write(0, make_headers(2), instance.generation());
+
+    const auto block = std::make_shared<const system::message::block>();
+    instance.reorganize(5, { block }, false);
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,115 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+using namespace bc::system;
+
+BOOST_AUTO_TEST_SUITE(history_cache_tests)
+
+static const auto record_size =
+    chain::payment_record::satoshi_fixed_size(true);
+
+static const auto key1 = sha256_hash(data_chunk{ 1 });
+static const auto key2 = sha256_hash(data_chunk{ 2 });
+static const auto key3 = sha256_hash(data_chunk{ 3 });
+
+static chain::payment_record::list make_history(size_t count)
+{
+    return chain::payment_record::list(count);
+}
+
+BOOST_AUTO_TEST_CASE(history_cache__store__find__returns_history)
+{
+    history_cache instance(10 * record_size);
+    instance.store(key1, instance.sequence(), make_history(2));
+
+    chain::payment_record::list out;
+    BOOST_REQUIRE(instance.find(out, key1, 0));
+    BOOST_REQUIRE_EQUAL(out.size(), 2u);
+    BOOST_REQUIRE(!instance.find(out, key2, 0));
+}
+
+BOOST_AUTO_TEST_CASE(history_cache__drop__removes_only_dropped_keys)
+{
+    history_cache instance(10 * record_size);
+    instance.store(key1, instance.sequence(), make_history(1));
+    instance.store(key2, instance.sequence(), make_history(1));
+    instance.drop({ key1 });
+
+    chain::payment_record::list out;
+    BOOST_REQUIRE(!instance.find(out, key1, 0));
+    BOOST_REQUIRE(instance.find(out, key2, 0));
+}
+
+BOOST_AUTO_TEST_CASE(history_cache__store__dropped_since_sequence__rejected)
+{
+    history_cache instance(10 * record_size);
+    const auto sequence = instance.sequence();
+    instance.drop({ key1 });
+    instance.store(key1, sequence, make_history(1));
+
+    chain::payment_record::list out;
+    BOOST_REQUIRE(!instance.find(out, key1, 0));
+}
+
+BOOST_AUTO_TEST_CASE(history_cache__store__over_capacity__evicts_least_used)
+{
+    history_cache instance(2 * record_size);
+    instance.store(key1, instance.sequence(), make_history(1));
+    instance.store(key2, instance.sequence(), make_history(1));
+
+    chain::payment_record::list out;
+    BOOST_REQUIRE(instance.find(out, key1, 0));
+    instance.store(key3, instance.sequence(), make_history(1));
+    BOOST_REQUIRE(instance.find(out, key1, 0));
+    BOOST_REQUIRE(!instance.find(out, key2, 0));
+    BOOST_REQUIRE(instance.find(out, key3, 0));
+}
+
+BOOST_AUTO_TEST_CASE(history_cache__store__disabled__ignored)
+{
+    history_cache instance(0);
+    instance.store(key1, instance.sequence(), make_history(1));
+
+    chain::payment_record::list out;
+    BOOST_REQUIRE(!instance.enabled());
+    BOOST_REQUIRE(!instance.find(out, key1, 0));
+}
+
+BOOST_AUTO_TEST_CASE(history_cache__keys__most_recently_used_first)
+{
+    history_cache instance(10 * record_size);
+    instance.store(key1, instance.sequence(), make_history(1));
+    instance.store(key2, instance.sequence(), make_history(1));
+
+    chain::payment_record::list out;
+    BOOST_REQUIRE(instance.find(out, key1, 0));
+
+    const auto keys = instance.keys();
+    BOOST_REQUIRE_EQUAL(keys.size(), 2u);
+    BOOST_REQUIRE(keys[0] == key1);
+    BOOST_REQUIRE(keys[1] == key2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
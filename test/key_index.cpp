@@ -0,0 +1,116 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <sstream>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+using namespace bc::system;
+
+BOOST_AUTO_TEST_SUITE(key_index_tests)
+
+static route make_route(uint16_t value)
+{
+    route out;
+    out.set_instance(value);
+    out.set_address(
+    {
+        static_cast<uint8_t>(value),
+        static_cast<uint8_t>(value >> 8)
+    });
+    return out;
+}
+
+static const auto key1 = sha256_hash(data_chunk{ 1 });
+static const auto key2 = sha256_hash(data_chunk{ 2 });
+
+BOOST_AUTO_TEST_CASE(key_index__subscribe__renewal__does_not_add)
+{
+    key_index instance(10);
+    BOOST_REQUIRE(!instance.subscribe(key1, make_route(1), 1, 0, false, false));
+    BOOST_REQUIRE(!instance.subscribe(key1, make_route(1), 1, 1, false, false));
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(key_index__match__repeated__each_increment_distinct)
+{
+    key_index instance(10);
+    BOOST_REQUIRE(!instance.subscribe(key1, make_route(1), 1, 0, false, false));
+
+    key_index::list out;
+    instance.match(out, key1);
+    instance.match(out, key1);
+    BOOST_REQUIRE_EQUAL(out.size(), 2u);
+    BOOST_REQUIRE_EQUAL(out.front()->sequence(), 0u);
+
+    const auto first = out.front()->increment();
+    const auto second = out.back()->increment();
+    BOOST_REQUIRE_EQUAL(first, 1u);
+    BOOST_REQUIRE_EQUAL(second, 2u);
+    BOOST_REQUIRE_EQUAL(out.front()->sequence(), second);
+}
+
+BOOST_AUTO_TEST_CASE(key_index__save__load__restores_subscriptions)
+{
+    key_index saved(10);
+    BOOST_REQUIRE(!saved.subscribe(key1, make_route(1), 42, 100, true, false));
+    BOOST_REQUIRE(!saved.subscribe(key2, make_route(2), 7, 200, false, true));
+
+    std::stringstream stream;
+    ostream_writer sink(stream);
+    BOOST_REQUIRE_EQUAL(saved.save(sink), 2u);
+
+    key_index loaded(10);
+    istream_reader source(stream);
+    BOOST_REQUIRE_EQUAL(loaded.load(source, 0), 2u);
+    BOOST_REQUIRE_EQUAL(loaded.size(), 2u);
+
+    key_index::list out;
+    loaded.match(out, key1);
+    BOOST_REQUIRE_EQUAL(out.size(), 1u);
+    BOOST_REQUIRE_EQUAL(out.front()->id(), 42u);
+    BOOST_REQUIRE_EQUAL(out.front()->instance(), 1u);
+    BOOST_REQUIRE_EQUAL(out.front()->updated(), 100);
+    BOOST_REQUIRE(out.front()->batched());
+    BOOST_REQUIRE(!out.front()->transactions());
+}
+
+BOOST_AUTO_TEST_CASE(key_index__load__before_cutoff__skipped)
+{
+    key_index saved(10);
+    BOOST_REQUIRE(!saved.subscribe(key1, make_route(1), 1, 100, false, false));
+    BOOST_REQUIRE(!saved.subscribe(key2, make_route(2), 2, 200, false, false));
+
+    std::stringstream stream;
+    ostream_writer sink(stream);
+    saved.save(sink);
+
+    key_index loaded(10);
+    istream_reader source(stream);
+    BOOST_REQUIRE_EQUAL(loaded.load(source, 150), 1u);
+
+    key_index::list out;
+    loaded.match(out, key1);
+    BOOST_REQUIRE(out.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,56 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+using namespace bc::system;
+
+BOOST_AUTO_TEST_SUITE(payment_keys_tests)
+
+BOOST_AUTO_TEST_CASE(payment_keys__extract__scripts__unique_script_hashes)
+{
+    const chain::script empty{};
+    const chain::script one{ data_chunk{ 0x51 }, false };
+    const chain::transaction tx
+    {
+        1, 0,
+        { { chain::output_point{ null_hash, 0 }, one, 0 } },
+        { { 42, empty }, { 43, one } }
+    };
+
+    const auto keys = payment_keys::extract(tx);
+    BOOST_REQUIRE_EQUAL(keys.size(), 2u);
+
+    const auto empty_key = sha256_hash(empty.to_data(false));
+    const auto one_key = sha256_hash(one.to_data(false));
+    BOOST_REQUIRE(std::find(keys.begin(), keys.end(), empty_key) != keys.end());
+    BOOST_REQUIRE(std::find(keys.begin(), keys.end(), one_key) != keys.end());
+}
+
+BOOST_AUTO_TEST_CASE(payment_keys__extract__no_scripts__empty)
+{
+    const chain::transaction tx{ 1, 0, {}, {} };
+    BOOST_REQUIRE(payment_keys::extract(tx).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
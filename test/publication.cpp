@@ -0,0 +1,55 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+using namespace bc::system;
+
+BOOST_AUTO_TEST_SUITE(publication_tests)
+
+static transaction_const_ptr make_transaction()
+{
+    return std::make_shared<const bc::system::message::transaction>();
+}
+
+BOOST_AUTO_TEST_CASE(publication__json__alternating_sequences__each_retained)
+{
+    const publication instance(make_transaction());
+    const auto secure = instance.json(1, false);
+    const auto open = instance.json(2, false);
+    BOOST_REQUIRE(secure != open);
+    BOOST_REQUIRE(instance.json(1, false) == secure);
+    BOOST_REQUIRE(instance.json(2, false) == open);
+}
+
+BOOST_AUTO_TEST_CASE(publication__json__compact__distinct_rendering)
+{
+    const publication instance(make_transaction());
+    const auto full = instance.json(1, false);
+    const auto compact = instance.json(1, true);
+    BOOST_REQUIRE(full != compact);
+    BOOST_REQUIRE(*full != *compact);
+    BOOST_REQUIRE(instance.json(1, false) == full);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
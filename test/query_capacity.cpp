@@ -0,0 +1,51 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+
+BOOST_AUTO_TEST_SUITE(query_capacity_tests)
+
+BOOST_AUTO_TEST_CASE(query_capacity__dispatched__to_limit__unavailable)
+{
+    query_capacity instance;
+    BOOST_REQUIRE(instance.available(2));
+
+    instance.dispatched();
+    instance.dispatched();
+    BOOST_REQUIRE_EQUAL(instance.outstanding(), 2u);
+    BOOST_REQUIRE(!instance.available(2));
+    BOOST_REQUIRE(instance.available(3));
+}
+
+BOOST_AUTO_TEST_CASE(query_capacity__completed__frees_capacity)
+{
+    query_capacity instance;
+    instance.dispatched();
+    BOOST_REQUIRE(!instance.available(1));
+
+    instance.completed();
+    BOOST_REQUIRE(instance.available(1));
+    BOOST_REQUIRE_EQUAL(instance.outstanding(), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
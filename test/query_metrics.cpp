@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+using namespace bc::system;
+
+BOOST_AUTO_TEST_SUITE(query_metrics_tests)
+
+static bool contains(const std::string& text, const std::string& line)
+{
+    return text.find(line + "\n") != std::string::npos;
+}
+
+BOOST_AUTO_TEST_CASE(query_metrics__report__unattached__relay_counters_only)
+{
+    query_metrics instance;
+    instance.requested();
+    instance.dropped();
+    instance.dispatch("unknown");
+
+    const auto report = instance.report();
+    BOOST_REQUIRE(contains(report, "query_relayed_requests_total 1"));
+    BOOST_REQUIRE(contains(report, "query_relayed_responses_total 0"));
+    BOOST_REQUIRE(contains(report, "query_dropped_total 1"));
+    BOOST_REQUIRE(report.find("command=") == std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(query_metrics__respond__error_code__counts_error)
+{
+    query_metrics instance;
+    instance.attach("");
+    instance.attach("");
+
+    const message request(false);
+    instance.dispatch(request.command());
+    instance.respond(message(request, error::success));
+    instance.respond(message(request, error::not_found));
+    instance.complete(request.command());
+
+    const auto report = instance.report();
+    BOOST_REQUIRE(contains(report, "query_requests_total{command=\"\"} 1"));
+    BOOST_REQUIRE(contains(report, "query_responses_total{command=\"\"} 2"));
+    BOOST_REQUIRE(contains(report, "query_errors_total{command=\"\"} 1"));
+    BOOST_REQUIRE(contains(report, "query_in_flight{command=\"\"} 0"));
+    BOOST_REQUIRE(contains(report,
+        "query_latency_microseconds_bucket{command=\"\",le=\"+Inf\"} 2"));
+}
+
+BOOST_AUTO_TEST_CASE(query_metrics__summarize__in_flight__totals_commands)
+{
+    query_metrics instance;
+    instance.attach("a");
+    instance.attach("b");
+    instance.dispatch("a");
+    instance.dispatch("b");
+    instance.dispatch("b");
+    instance.complete("b");
+    instance.requested();
+    instance.rejected();
+
+    const auto summary = instance.summarize();
+    BOOST_REQUIRE_EQUAL(summary.in_flight, 2u);
+    BOOST_REQUIRE_EQUAL(summary.requested, 1u);
+    BOOST_REQUIRE_EQUAL(summary.rejected, 1u);
+    BOOST_REQUIRE_EQUAL(summary.responded, 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,83 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <boost/filesystem.hpp>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+using namespace bc::system;
+
+BOOST_AUTO_TEST_SUITE(query_recorder_tests)
+
+BOOST_AUTO_TEST_CASE(query_recorder__construct__empty_path__disabled)
+{
+    const boost::filesystem::path disabled;
+    query_recorder instance(disabled);
+    BOOST_REQUIRE(!instance.enabled());
+    instance.capture(message(false));
+}
+
+BOOST_AUTO_TEST_CASE(query_recorder__deserialize__serialized__round_trips)
+{
+    data_chunk data{ 'b', 's', 'q', 1 };
+    query_recorder::serialize(data, 42, "blockchain.fetch_last_height", {});
+    query_recorder::serialize(data, 7, "server.version", { 1, 2, 3 });
+
+    query_recorder::entries out;
+    BOOST_REQUIRE(query_recorder::deserialize(out, data));
+    BOOST_REQUIRE_EQUAL(out.size(), 2u);
+    BOOST_REQUIRE_EQUAL(out[0].offset, 42u);
+    BOOST_REQUIRE_EQUAL(out[0].command, "blockchain.fetch_last_height");
+    BOOST_REQUIRE(out[0].data.empty());
+    BOOST_REQUIRE_EQUAL(out[1].offset, 7u);
+    BOOST_REQUIRE_EQUAL(out[1].data.size(), 3u);
+}
+
+BOOST_AUTO_TEST_CASE(query_recorder__deserialize__truncated__false)
+{
+    data_chunk data{ 'b', 's', 'q', 1 };
+    query_recorder::serialize(data, 1, "server.version", { 1, 2, 3 });
+    data.pop_back();
+
+    query_recorder::entries out;
+    BOOST_REQUIRE(!query_recorder::deserialize(out, data));
+}
+
+BOOST_AUTO_TEST_CASE(query_recorder__capture__flushed__loads)
+{
+    const auto file = boost::filesystem::temp_directory_path() /
+        boost::filesystem::unique_path("query_recorder_%%%%%%%%.cap");
+
+    {
+        query_recorder instance(file);
+        BOOST_REQUIRE(instance.enabled());
+        instance.capture(message(false));
+        instance.capture(message(false));
+    }
+
+    query_recorder::entries out;
+    BOOST_REQUIRE(query_recorder::load(out, file));
+    BOOST_REQUIRE_EQUAL(out.size(), 2u);
+    BOOST_REQUIRE_EQUAL(out[1].offset, 0u);
+    boost::filesystem::remove(file);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <string>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+using namespace bc::system;
+
+BOOST_AUTO_TEST_SUITE(query_tracer_tests)
+
+BOOST_AUTO_TEST_CASE(query_tracer__sample__disabled__not_traced)
+{
+    query_tracer instance(0, 0);
+    message request(false);
+    instance.sample(request);
+    BOOST_REQUIRE(!request.traced());
+}
+
+BOOST_AUTO_TEST_CASE(query_tracer__sample__interval__every_third_traced)
+{
+    query_tracer instance(3, 0);
+    size_t traced = 0;
+
+    for (size_t query = 0; query < 9; ++query)
+    {
+        message request(false);
+        instance.sample(request);
+        traced += request.traced() ? 1 : 0;
+    }
+
+    BOOST_REQUIRE_EQUAL(traced, 3u);
+}
+
+BOOST_AUTO_TEST_CASE(query_tracer__describe__sampled__response_shares_stages)
+{
+    query_tracer instance(1, 0);
+    message request(false);
+    instance.sample(request);
+    request.executing();
+
+    const message response(request, data_chunk{});
+    BOOST_REQUIRE(response.traced());
+    BOOST_REQUIRE(response.executed() == request.executed());
+    BOOST_REQUIRE(response.created() >= response.executed());
+
+    const auto text = query_tracer::describe(response, response.created());
+    BOOST_REQUIRE(text.find("(wait ") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(query_tracer__describe__not_sampled__total_only)
+{
+    const message request(false);
+    const message response(request, data_chunk{});
+    BOOST_REQUIRE(!response.traced());
+
+    const auto text = query_tracer::describe(response, response.received());
+    BOOST_REQUIRE_EQUAL(text, " [][0] 0us");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
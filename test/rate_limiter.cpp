@@ -0,0 +1,81 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+using namespace bc::system;
+
+BOOST_AUTO_TEST_SUITE(rate_limiter_tests)
+
+static const rate_limiter::identity alice{ 0x01 };
+static const rate_limiter::identity bob{ 0x02 };
+
+BOOST_AUTO_TEST_CASE(rate_limiter__admit__zero_rate__unlimited)
+{
+    rate_limiter instance(0);
+    const auto now = rate_limiter::clock::now();
+
+    for (auto count = 0; count < 100; ++count)
+        BOOST_REQUIRE(instance.admit(alice, now));
+
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(rate_limiter__admit__burst_exceeded__rejects_only_client)
+{
+    rate_limiter instance(3);
+    const auto now = rate_limiter::clock::now();
+    BOOST_REQUIRE(instance.admit(alice, now));
+    BOOST_REQUIRE(instance.admit(alice, now));
+    BOOST_REQUIRE(instance.admit(alice, now));
+    BOOST_REQUIRE(!instance.admit(alice, now));
+    BOOST_REQUIRE(instance.admit(bob, now));
+}
+
+BOOST_AUTO_TEST_CASE(rate_limiter__admit__after_refill__admits)
+{
+    rate_limiter instance(2);
+    const auto now = rate_limiter::clock::now();
+    BOOST_REQUIRE(instance.admit(alice, now));
+    BOOST_REQUIRE(instance.admit(alice, now));
+    BOOST_REQUIRE(!instance.admit(alice, now));
+    BOOST_REQUIRE(instance.admit(alice, now + std::chrono::milliseconds(500)));
+}
+
+BOOST_AUTO_TEST_CASE(rate_limiter__prune__refilled__dropped)
+{
+    rate_limiter instance(2);
+    const auto now = rate_limiter::clock::now();
+    BOOST_REQUIRE(instance.admit(alice, now));
+    BOOST_REQUIRE(instance.admit(bob, now));
+    BOOST_REQUIRE(instance.admit(bob, now));
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+
+    instance.prune(now + std::chrono::milliseconds(600));
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+
+    instance.prune(now + std::chrono::seconds(1));
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,76 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+using namespace bc::system;
+
+BOOST_AUTO_TEST_SUITE(request_coalescer_tests)
+
+BOOST_AUTO_TEST_CASE(request_coalescer__join__disabled__not_joined)
+{
+    request_coalescer instance(false);
+    const message request(false);
+    send_handler handler = [](message&&) {};
+    BOOST_REQUIRE(!instance.join(handler, request));
+    BOOST_REQUIRE(!instance.join(handler, request));
+    BOOST_REQUIRE_EQUAL(instance.pending(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(request_coalescer__join__duplicate__joined_and_answered)
+{
+    request_coalescer instance(true);
+    const message request(false);
+    size_t sent = 0;
+    data_chunk last;
+    send_handler leader = [&](message&& response)
+    {
+        ++sent;
+        last = response.data();
+    };
+
+    send_handler duplicate = leader;
+    BOOST_REQUIRE(!instance.join(leader, request));
+    BOOST_REQUIRE(instance.join(duplicate, request));
+    BOOST_REQUIRE_EQUAL(instance.pending(), 1u);
+
+    leader(message(request, data_chunk{ 0x2a }));
+    BOOST_REQUIRE_EQUAL(sent, 2u);
+    BOOST_REQUIRE_EQUAL(last.size(), 1u);
+    BOOST_REQUIRE_EQUAL(last.front(), 0x2a);
+    BOOST_REQUIRE_EQUAL(instance.pending(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(request_coalescer__join__after_complete__not_joined)
+{
+    request_coalescer instance(true);
+    const message request(false);
+    send_handler handler = [](message&&) {};
+    BOOST_REQUIRE(!instance.join(handler, request));
+    handler(message(request, data_chunk{}));
+
+    send_handler next = [](message&&) {};
+    BOOST_REQUIRE(!instance.join(next, request));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
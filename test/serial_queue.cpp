@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <future>
+#include <vector>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+
+BOOST_AUTO_TEST_SUITE(serial_queue_tests)
+
+BOOST_AUTO_TEST_CASE(serial_queue__push__not_started__false)
+{
+    serial_queue instance;
+    BOOST_REQUIRE(!instance.push([](){}));
+}
+
+BOOST_AUTO_TEST_CASE(serial_queue__push__started__executes_in_order)
+{
+    serial_queue instance;
+    instance.start();
+
+    std::vector<int> order;
+    std::promise<void> done;
+
+    for (auto value = 0; value < 10; ++value)
+        BOOST_REQUIRE(instance.push([&order, value]()
+        {
+            order.push_back(value);
+        }));
+
+    BOOST_REQUIRE(instance.push([&done]()
+    {
+        done.set_value();
+    }));
+
+    done.get_future().wait();
+    instance.stop();
+
+    BOOST_REQUIRE_EQUAL(order.size(), 10u);
+
+    for (auto value = 0; value < 10; ++value)
+        BOOST_REQUIRE_EQUAL(order[value], value);
+}
+
+BOOST_AUTO_TEST_CASE(serial_queue__push__stopped__false)
+{
+    serial_queue instance;
+    instance.start();
+    instance.stop();
+    BOOST_REQUIRE(!instance.push([](){}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
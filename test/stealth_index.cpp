@@ -0,0 +1,153 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+using namespace bc::system;
+
+BOOST_AUTO_TEST_SUITE(stealth_index_tests)
+
+static route make_route(uint16_t value)
+{
+    route out;
+    out.set_address(
+    {
+        static_cast<uint8_t>(value),
+        static_cast<uint8_t>(value >> 8)
+    });
+    return out;
+}
+
+BOOST_AUTO_TEST_CASE(stealth_index__subscribe__matching_lengths__matches_each)
+{
+    static const uint32_t prefix = 0xbaadf00d;
+    stealth_index instance(10);
+    BOOST_REQUIRE(!instance.subscribe(binary{ 8, prefix }, make_route(1), 1, 0));
+    BOOST_REQUIRE(!instance.subscribe(binary{ 13, prefix }, make_route(2), 2, 0));
+    BOOST_REQUIRE(!instance.subscribe(binary{ 32, prefix }, make_route(3), 3, 0));
+    BOOST_REQUIRE_EQUAL(instance.size(), 3u);
+
+    stealth_index::list out;
+    instance.match(out, prefix);
+    BOOST_REQUIRE_EQUAL(out.size(), 3u);
+}
+
+BOOST_AUTO_TEST_CASE(stealth_index__match__mismatched_prefix__empty)
+{
+    stealth_index instance(10);
+    BOOST_REQUIRE(!instance.subscribe(binary{ 16, 0x0000ffff }, make_route(1),
+        1, 0));
+
+    stealth_index::list out;
+    instance.match(out, 0x1234ffff);
+    BOOST_REQUIRE_EQUAL(out.size(), 1u);
+
+    out.clear();
+    instance.match(out, 0x0000fffe);
+    BOOST_REQUIRE(out.empty());
+}
+
+BOOST_AUTO_TEST_CASE(stealth_index__subscribe__invalid_length__bad_stream)
+{
+    stealth_index instance(10);
+    const auto ec = instance.subscribe(binary{ 7, 0 }, make_route(1), 1, 0);
+    BOOST_REQUIRE_EQUAL(ec, error::bad_stream);
+    BOOST_REQUIRE(instance.empty());
+}
+
+BOOST_AUTO_TEST_CASE(stealth_index__subscribe__over_limit__oversubscribed)
+{
+    stealth_index instance(1);
+    BOOST_REQUIRE(!instance.subscribe(binary{ 8, 1 }, make_route(1), 1, 0));
+    BOOST_REQUIRE(!instance.subscribe(binary{ 8, 1 }, make_route(1), 1, 0));
+    BOOST_REQUIRE_EQUAL(instance.subscribe(binary{ 8, 2 }, make_route(2), 2, 0),
+        error::oversubscribed);
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(stealth_index__unsubscribe__subscribed__removed)
+{
+    stealth_index instance(10);
+    BOOST_REQUIRE(!instance.subscribe(binary{ 8, 1 }, make_route(1), 1, 0));
+    instance.unsubscribe(binary{ 8, 1 }, make_route(1));
+    BOOST_REQUIRE(instance.empty());
+
+    stealth_index::list out;
+    instance.match(out, 1);
+    BOOST_REQUIRE(out.empty());
+}
+
+BOOST_AUTO_TEST_CASE(stealth_index__purge__expired__removes_expired_only)
+{
+    stealth_index instance(10);
+    BOOST_REQUIRE(!instance.subscribe(binary{ 8, 1 }, make_route(1), 1, 0));
+    BOOST_REQUIRE(!instance.subscribe(binary{ 8, 1 }, make_route(2), 2, 600));
+
+    stealth_index::list out;
+    instance.purge(out, 300, 1);
+    BOOST_REQUIRE_EQUAL(out.size(), 1u);
+    BOOST_REQUIRE_EQUAL(out.front()->id(), 1u);
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+}
+
+// Notifications per second for one prefix per output, against subscriptions
+// spread over every filter length (the former high volume testing case).
+BOOST_AUTO_TEST_CASE(stealth_index__match__benchmark)
+{
+    typedef std::chrono::steady_clock clock;
+    static const size_t subscriptions = 10000;
+    static const size_t prefixes = 100000;
+
+    stealth_index instance(subscriptions);
+
+    for (size_t index = 0; index < subscriptions; ++index)
+    {
+        const auto bits = 8 + (index % 25);
+        const auto value = static_cast<uint32_t>(index * 2654435761u);
+        const auto address = static_cast<uint16_t>(index);
+        instance.subscribe(binary{ bits, value }, make_route(address),
+            static_cast<uint32_t>(index), 0);
+    }
+
+    size_t notifications = 0;
+    stealth_index::list out;
+    const auto start = clock::now();
+
+    for (size_t index = 0; index < prefixes; ++index)
+    {
+        instance.match(out, static_cast<uint32_t>(index * 40503u));
+        notifications += out.size();
+        out.clear();
+    }
+
+    const auto elapsed = std::chrono::duration_cast<
+        std::chrono::microseconds>(clock::now() - start).count();
+
+    BOOST_TEST_MESSAGE("stealth_index: " << prefixes << " prefixes, "
+        << notifications << " notifications in " << elapsed << "us ("
+        << (prefixes * 1000000 / (elapsed + 1)) << " prefixes/s).");
+    BOOST_REQUIRE_EQUAL(instance.size(), subscriptions);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
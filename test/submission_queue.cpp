@@ -0,0 +1,93 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+using namespace bc::system;
+
+BOOST_AUTO_TEST_SUITE(submission_queue_tests)
+
+typedef submission_queue::result_handler result_handler;
+
+// Transactions with an empty output script, distinct by lock time.
+static transaction_const_ptr make_transaction(uint32_t locktime)
+{
+    return std::make_shared<const system::message::transaction>(
+        chain::transaction{ 1, locktime, {}, { { 42, chain::script{} } } });
+}
+
+BOOST_AUTO_TEST_CASE(submission_queue__submit__duplicate__organized_once)
+{
+    std::vector<result_handler> organizing;
+    submission_queue instance([&](transaction_const_ptr, result_handler done)
+    {
+        organizing.push_back(done);
+    }, 10);
+
+    size_t answered = 0;
+    const auto tx = make_transaction(1);
+    BOOST_REQUIRE(!instance.submit(tx, [&](const code&) { ++answered; }));
+    BOOST_REQUIRE(!instance.submit(tx, [&](const code&) { ++answered; }));
+    BOOST_REQUIRE_EQUAL(organizing.size(), 1u);
+    BOOST_REQUIRE_EQUAL(instance.pending(), 1u);
+
+    organizing.front()(error::success);
+    BOOST_REQUIRE_EQUAL(answered, 2u);
+    BOOST_REQUIRE_EQUAL(instance.pending(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(submission_queue__submit__at_limit__oversubscribed)
+{
+    std::vector<result_handler> organizing;
+    submission_queue instance([&](transaction_const_ptr, result_handler done)
+    {
+        organizing.push_back(done);
+    }, 1);
+
+    const auto ignore = [](const code&) {};
+    BOOST_REQUIRE(!instance.submit(make_transaction(1), ignore));
+    BOOST_REQUIRE_EQUAL(instance.submit(make_transaction(2), ignore),
+        error::oversubscribed);
+
+    // A duplicate of a pending transaction is not limited.
+    BOOST_REQUIRE(!instance.submit(make_transaction(1), ignore));
+    BOOST_REQUIRE_EQUAL(organizing.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(submission_queue__submit__synchronous_result__answered)
+{
+    submission_queue instance([](transaction_const_ptr, result_handler done)
+    {
+        done(error::not_implemented);
+    }, 0);
+
+    code result;
+    BOOST_REQUIRE(!instance.submit(make_transaction(1),
+        [&](const code& ec) { result = ec; }));
+    BOOST_REQUIRE_EQUAL(result, error::not_implemented);
+    BOOST_REQUIRE_EQUAL(instance.pending(), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
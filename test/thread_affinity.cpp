@@ -0,0 +1,59 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <vector>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+
+BOOST_AUTO_TEST_SUITE(thread_affinity_tests)
+
+BOOST_AUTO_TEST_CASE(thread_affinity__parse__list_and_ranges__expanded)
+{
+    std::vector<size_t> cores;
+    BOOST_REQUIRE(thread_affinity::parse(cores, "0-2, 8"));
+    BOOST_REQUIRE_EQUAL(cores.size(), 4u);
+    BOOST_REQUIRE_EQUAL(cores[2], 2u);
+    BOOST_REQUIRE_EQUAL(cores[3], 8u);
+}
+
+BOOST_AUTO_TEST_CASE(thread_affinity__parse__empty__valid_empty)
+{
+    std::vector<size_t> cores{ 1 };
+    BOOST_REQUIRE(thread_affinity::parse(cores, ""));
+    BOOST_REQUIRE(cores.empty());
+}
+
+BOOST_AUTO_TEST_CASE(thread_affinity__parse__invalid__false)
+{
+    std::vector<size_t> cores;
+    BOOST_REQUIRE(!thread_affinity::parse(cores, "3-1"));
+    BOOST_REQUIRE(!thread_affinity::parse(cores, "a"));
+    BOOST_REQUIRE(!thread_affinity::parse(cores, "1,,2"));
+}
+
+BOOST_AUTO_TEST_CASE(thread_affinity__pin__empty__true)
+{
+    BOOST_REQUIRE(thread_affinity::pin("", "test"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
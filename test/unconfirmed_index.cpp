@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) 2011-2019 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <bitcoin/server.hpp>
+
+using namespace bc;
+using namespace bc::server;
+using namespace bc::system;
+
+BOOST_AUTO_TEST_SUITE(unconfirmed_index_tests)
+
+// Transactions with an empty output script, distinct by lock time.
+static chain::transaction make_transaction(uint32_t locktime)
+{
+    return { 1, locktime, {}, { { 42, chain::script{} } } };
+}
+
+static const auto empty_key = sha256_hash(data_chunk{});
+
+BOOST_AUTO_TEST_CASE(unconfirmed_index__add__read__returns_hashes)
+{
+    unconfirmed_index instance(10);
+    const auto tx = make_transaction(1);
+    instance.add(tx);
+    instance.add(tx);
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+
+    hash_list out;
+    instance.read(out, empty_key);
+    BOOST_REQUIRE_EQUAL(out.size(), 1u);
+    BOOST_REQUIRE(out.front() == tx.hash());
+
+    out.clear();
+    instance.read(out, null_hash);
+    BOOST_REQUIRE(out.empty());
+}
+
+BOOST_AUTO_TEST_CASE(unconfirmed_index__confirm__removes_block_transactions)
+{
+    unconfirmed_index instance(10);
+    const auto confirmed = make_transaction(1);
+    instance.add(confirmed);
+    instance.add(make_transaction(2));
+
+    const auto block = std::make_shared<const system::message::block>(
+        chain::block{ chain::header{}, { confirmed } });
+    instance.confirm({ block });
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+
+    hash_list out;
+    instance.read(out, empty_key);
+    BOOST_REQUIRE_EQUAL(out.size(), 1u);
+    BOOST_REQUIRE(out.front() == make_transaction(2).hash());
+}
+
+BOOST_AUTO_TEST_CASE(unconfirmed_index__add__over_limit__evicts_oldest)
+{
+    unconfirmed_index instance(2);
+    instance.add(make_transaction(1));
+    instance.add(make_transaction(2));
+    instance.add(make_transaction(3));
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+
+    hash_list out;
+    instance.read(out, empty_key);
+    BOOST_REQUIRE_EQUAL(out.size(), 2u);
+    BOOST_REQUIRE(out.front() == make_transaction(2).hash());
+}
+
+BOOST_AUTO_TEST_CASE(unconfirmed_index__add__disabled__ignored)
+{
+    unconfirmed_index instance(0);
+    instance.add(make_transaction(1));
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()